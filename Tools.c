@@ -0,0 +1,2566 @@
+/*
+ * This file was generated automatically by ExtUtils::ParseXS version 3.45 from the
+ * contents of Tools.xs. Do not edit this file, edit Tools.xs instead.
+ *
+ *    ANY CHANGES MADE HERE WILL BE LOST!
+ *
+ */
+
+#line 1 "Tools.xs"
+/* Copyright 2009 Peter Karman
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * under the same terms as Perl itself.
+ */
+
+/*
+ * Standard XS greeting.
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+#define PERL_NO_GET_CONTEXT 
+#include "EXTERN.h"
+#include "perl.h"
+#include "XSUB.h"
+#include "ppport.h"
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef EXTERN
+  #undef EXTERN
+#endif
+
+#define EXTERN static
+
+/* pure C helpers */
+#include "search-tools.c"
+
+/********************************************************************/
+
+#line 43 "Tools.c"
+#ifndef PERL_UNUSED_VAR
+#  define PERL_UNUSED_VAR(var) if (0) var = var
+#endif
+
+#ifndef dVAR
+#  define dVAR		dNOOP
+#endif
+
+
+/* This stuff is not part of the API! You have been warned. */
+#ifndef PERL_VERSION_DECIMAL
+#  define PERL_VERSION_DECIMAL(r,v,s) (r*1000000 + v*1000 + s)
+#endif
+#ifndef PERL_DECIMAL_VERSION
+#  define PERL_DECIMAL_VERSION \
+	  PERL_VERSION_DECIMAL(PERL_REVISION,PERL_VERSION,PERL_SUBVERSION)
+#endif
+#ifndef PERL_VERSION_GE
+#  define PERL_VERSION_GE(r,v,s) \
+	  (PERL_DECIMAL_VERSION >= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+#ifndef PERL_VERSION_LE
+#  define PERL_VERSION_LE(r,v,s) \
+	  (PERL_DECIMAL_VERSION <= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+
+/* XS_INTERNAL is the explicit static-linkage variant of the default
+ * XS macro.
+ *
+ * XS_EXTERNAL is the same as XS_INTERNAL except it does not include
+ * "STATIC", ie. it exports XSUB symbols. You probably don't want that
+ * for anything but the BOOT XSUB.
+ *
+ * See XSUB.h in core!
+ */
+
+
+/* TODO: This might be compatible further back than 5.10.0. */
+#if PERL_VERSION_GE(5, 10, 0) && PERL_VERSION_LE(5, 15, 1)
+#  undef XS_EXTERNAL
+#  undef XS_INTERNAL
+#  if defined(__CYGWIN__) && defined(USE_DYNAMIC_LOADING)
+#    define XS_EXTERNAL(name) __declspec(dllexport) XSPROTO(name)
+#    define XS_INTERNAL(name) STATIC XSPROTO(name)
+#  endif
+#  if defined(__SYMBIAN32__)
+#    define XS_EXTERNAL(name) EXPORT_C XSPROTO(name)
+#    define XS_INTERNAL(name) EXPORT_C STATIC XSPROTO(name)
+#  endif
+#  ifndef XS_EXTERNAL
+#    if defined(HASATTRIBUTE_UNUSED) && !defined(__cplusplus)
+#      define XS_EXTERNAL(name) void name(pTHX_ CV* cv __attribute__unused__)
+#      define XS_INTERNAL(name) STATIC void name(pTHX_ CV* cv __attribute__unused__)
+#    else
+#      ifdef __cplusplus
+#        define XS_EXTERNAL(name) extern "C" XSPROTO(name)
+#        define XS_INTERNAL(name) static XSPROTO(name)
+#      else
+#        define XS_EXTERNAL(name) XSPROTO(name)
+#        define XS_INTERNAL(name) STATIC XSPROTO(name)
+#      endif
+#    endif
+#  endif
+#endif
+
+/* perl >= 5.10.0 && perl <= 5.15.1 */
+
+
+/* The XS_EXTERNAL macro is used for functions that must not be static
+ * like the boot XSUB of a module. If perl didn't have an XS_EXTERNAL
+ * macro defined, the best we can do is assume XS is the same.
+ * Dito for XS_INTERNAL.
+ */
+#ifndef XS_EXTERNAL
+#  define XS_EXTERNAL(name) XS(name)
+#endif
+#ifndef XS_INTERNAL
+#  define XS_INTERNAL(name) XS(name)
+#endif
+
+/* Now, finally, after all this mess, we want an ExtUtils::ParseXS
+ * internal macro that we're free to redefine for varying linkage due
+ * to the EXPORT_XSUB_SYMBOLS XS keyword. This is internal, use
+ * XS_EXTERNAL(name) or XS_INTERNAL(name) in your code if you need to!
+ */
+
+#undef XS_EUPXS
+#if defined(PERL_EUPXS_ALWAYS_EXPORT)
+#  define XS_EUPXS(name) XS_EXTERNAL(name)
+#else
+   /* default to internal */
+#  define XS_EUPXS(name) XS_INTERNAL(name)
+#endif
+
+#ifndef PERL_ARGS_ASSERT_CROAK_XS_USAGE
+#define PERL_ARGS_ASSERT_CROAK_XS_USAGE assert(cv); assert(params)
+
+/* prototype to pass -Wmissing-prototypes */
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params);
+
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params)
+{
+    const GV *const gv = CvGV(cv);
+
+    PERL_ARGS_ASSERT_CROAK_XS_USAGE;
+
+    if (gv) {
+        const char *const gvname = GvNAME(gv);
+        const HV *const stash = GvSTASH(gv);
+        const char *const hvname = stash ? HvNAME(stash) : NULL;
+
+        if (hvname)
+	    Perl_croak_nocontext("Usage: %s::%s(%s)", hvname, gvname, params);
+        else
+	    Perl_croak_nocontext("Usage: %s(%s)", gvname, params);
+    } else {
+        /* Pants. I don't think that it should be possible to get here. */
+	Perl_croak_nocontext("Usage: CODE(0x%" UVxf ")(%s)", PTR2UV(cv), params);
+    }
+}
+#undef  PERL_ARGS_ASSERT_CROAK_XS_USAGE
+
+#define croak_xs_usage        S_croak_xs_usage
+
+#endif
+
+/* NOTE: the prototype of newXSproto() is different in versions of perls,
+ * so we define a portable version of newXSproto()
+ */
+#ifdef newXS_flags
+#define newXSproto_portable(name, c_impl, file, proto) newXS_flags(name, c_impl, file, proto, 0)
+#else
+#define newXSproto_portable(name, c_impl, file, proto) (PL_Sv=(SV*)newXS(name, c_impl, file), sv_setpv(PL_Sv, proto), (CV*)PL_Sv)
+#endif /* !defined(newXS_flags) */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  define newXS_deffile(a,b) Perl_newXS(aTHX_ a,b,file)
+#else
+#  define newXS_deffile(a,b) Perl_newXS_deffile(aTHX_ a,b)
+#endif
+
+#line 187 "Tools.c"
+
+XS_EUPXS(XS_Search__Tools_describe); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools_describe)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "thing");
+    {
+	SV *	thing = ST(0)
+;
+#line 43 "Tools.xs"
+        st_describe_object(thing);
+        st_dump_sv(thing);
+#line 201 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_byte_length); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_byte_length)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+#line 57 "Tools.xs"
+        STRLEN len;
+        U8 * bytes;
+
+#line 220 "Tools.c"
+	int	RETVAL;
+	dXSTARG;
+#line 61 "Tools.xs"
+        bytes  = (U8*)SvPV(string, len);
+        RETVAL = len;
+
+#line 227 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_is_perl_utf8_string); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_is_perl_utf8_string)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+#line 73 "Tools.xs"
+        STRLEN len;
+        U8 * bytes;
+
+#line 248 "Tools.c"
+	int	RETVAL;
+	dXSTARG;
+#line 77 "Tools.xs"
+        bytes  = (U8*)SvPV(string, len);
+        RETVAL = is_utf8_string(bytes, len);
+
+#line 255 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_utf8); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_utf8)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+	SV *	RETVAL;
+#line 90 "Tools.xs"
+        RETVAL = st_find_bad_utf8(string);
+
+#line 276 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_utf8_offset); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_utf8_offset)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+#line 101 "Tools.xs"
+        STRLEN          len;
+        unsigned char*  bytes;
+        STRLEN          i;
+
+#line 298 "Tools.c"
+	IV	RETVAL;
+	dXSTARG;
+#line 106 "Tools.xs"
+        bytes  = (unsigned char*)SvPV(string, len);
+        i      = st_find_bad_utf8_offset(bytes, len);
+        RETVAL = i == len ? -1 : (IV)i;
+
+#line 306 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_is_ascii); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_is_ascii)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+	boolean	RETVAL;
+	dXSTARG;
+#line 121 "Tools.xs"
+        RETVAL = st_is_ascii(string);
+
+#line 328 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_is_latin1); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_is_latin1)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+#line 132 "Tools.xs"
+        STRLEN         len;
+        unsigned char* bytes;
+
+#line 349 "Tools.c"
+	boolean	RETVAL;
+	dXSTARG;
+#line 136 "Tools.xs"
+        bytes  = (unsigned char*)SvPV(string, len);
+        RETVAL = st_find_c1(bytes, len) == len;
+
+#line 356 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_debug_bytes); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_debug_bytes)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+#line 148 "Tools.xs"
+        STRLEN         len;
+        unsigned char* bytes;
+        unsigned int   i;
+
+#line 378 "Tools.c"
+#line 153 "Tools.xs"
+        bytes  = (unsigned char*)SvPV(string, len);
+        for(i=0; i < len; i++) {
+            warn("'%c' \\x%x \\%d\n", bytes[i], bytes[i], bytes[i]);
+        }
+#line 384 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_ascii); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_ascii)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+#line 164 "Tools.xs"
+        STRLEN          len;
+        unsigned char*  bytes;
+        STRLEN          i;
+
+#line 404 "Tools.c"
+	IV	RETVAL;
+	dXSTARG;
+#line 169 "Tools.xs"
+        bytes  = (unsigned char*)SvPV(string, len);
+        i      = st_find_non_ascii(bytes, len);
+        RETVAL = i == len ? -1 : (IV)i;
+
+#line 412 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_latin1); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_find_bad_latin1)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    {
+	SV*	string = ST(0)
+;
+#line 181 "Tools.xs"
+        STRLEN          len;
+        unsigned char*  bytes;
+        STRLEN          i;
+
+#line 434 "Tools.c"
+	int	RETVAL;
+	dXSTARG;
+#line 186 "Tools.xs"
+        bytes  = (unsigned char*)SvPV(string, len);
+        i      = st_find_c1(bytes, len);
+        RETVAL = i == len ? -1 : (int)i;
+
+#line 442 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__UTF8_classify_buffer); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__UTF8_classify_buffer)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "string");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	SV*	string = ST(0)
+;
+#line 199 "Tools.xs"
+        STRLEN          len;
+        unsigned char*  bytes;
+        int             flags;
+
+#line 466 "Tools.c"
+#line 204 "Tools.xs"
+        bytes = (unsigned char*)SvPV(string, len);
+        flags = st_classify_buf(bytes, len);
+        EXTEND(SP, 3);
+        mPUSHi(flags & ST_BUF_ASCII  ? 1 : 0);
+        mPUSHi(flags & ST_BUF_LATIN1 ? 1 : 0);
+        mPUSHi(flags & ST_BUF_UTF8   ? 1 : 0);
+#line 474 "Tools.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_tokenize); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_tokenize)
+{
+    dVAR; dXSARGS;
+    if (items < 2)
+       croak_xs_usage(cv,  "self, str, ...");
+    {
+	SV*	self = ST(0)
+;
+	SV*	str = ST(1)
+;
+#line 228 "Tools.xs"
+        SV* token_re;
+        SV* token_list_sv;
+        SV* heat_seeker = NULL;
+        IV match_num;
+        SV** lang;
+
+#line 499 "Tools.c"
+	SV *	RETVAL;
+#line 235 "Tools.xs"
+        if (items > 2) {
+            heat_seeker = ST(2);
+        }
+        match_num = 0;
+        if (items > 3) {
+            match_num = SvIV(ST(3));
+        }
+
+        st_tokenize_check_utf8(str);
+        token_re = st_hvref_fetch(self, "re");
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        token_list_sv = st_tokenize(str, token_re, heat_seeker, match_num,
+                            st_lang_abbrevs(lang ? *lang : NULL));
+        RETVAL = token_list_sv;
+
+#line 517 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_tokenize_batch); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_tokenize_batch)
+{
+    dVAR; dXSARGS;
+    if (items < 2)
+       croak_xs_usage(cv,  "self, docs, ...");
+    {
+	SV*	self = ST(0)
+;
+	SV*	docs = ST(1)
+;
+#line 260 "Tools.xs"
+        SV* token_re;
+        SV* heat_seeker = NULL;
+        IV match_num;
+        SV** lang;
+        AV* lists;
+
+#line 543 "Tools.c"
+	SV *	RETVAL;
+#line 267 "Tools.xs"
+        if (!SvROK(docs) || SvTYPE(SvRV(docs)) != SVt_PVAV) {
+            croak("docs must be an ARRAY reference");
+        }
+        if (items > 2 && SvOK(ST(2))) {
+            heat_seeker = ST(2);
+        }
+        match_num = 0;
+        if (items > 3) {
+            match_num = SvIV(ST(3));
+        }
+
+        token_re = st_hvref_fetch(self, "re");
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        lists = st_tokenize_batch((AV*)SvRV(docs), token_re, heat_seeker, 
+                    match_num, st_lang_abbrevs(lang ? *lang : NULL));
+        RETVAL = newRV_inc((SV*)lists);
+
+#line 563 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_tokenize_windows); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_tokenize_windows)
+{
+    dVAR; dXSARGS;
+    if (items < 4)
+       croak_xs_usage(cv,  "self, str, offsets, size, ...");
+    {
+	SV*	self = ST(0)
+;
+	SV*	str = ST(1)
+;
+	SV*	offsets = ST(2)
+;
+	IV	size = (IV)SvIV(ST(3))
+;
+#line 295 "Tools.xs"
+        SV* heat_seeker = NULL;
+        IV match_num;
+        SV** lang;
+
+#line 591 "Tools.c"
+	SV *	RETVAL;
+#line 300 "Tools.xs"
+        if (!SvROK(offsets) || SvTYPE(SvRV(offsets)) != SVt_PVAV) {
+            croak("offsets must be an ARRAY reference");
+        }
+        if (items > 4 && SvOK(ST(4))) {
+            heat_seeker = ST(4);
+        }
+        match_num = 0;
+        if (items > 5) {
+            match_num = SvIV(ST(5));
+        }
+
+        st_tokenize_check_utf8(str);
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        RETVAL = st_tokenize_windows(str, (AV*)SvRV(offsets), size, 
+                    st_hvref_fetch(self, "re"), heat_seeker, match_num,
+                    st_lang_abbrevs(lang ? *lang : NULL));
+
+#line 611 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_stream); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_stream)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "self, ...");
+    {
+	SV*	self = ST(0)
+;
+#line 325 "Tools.xs"
+        SV* heat_seeker = NULL;
+        IV match_num = 0;
+        SV** lang;
+
+#line 633 "Tools.c"
+	SV *	RETVAL;
+#line 330 "Tools.xs"
+        if (items > 1 && SvOK(ST(1))) {
+            heat_seeker = ST(1);
+        }
+        if (items > 2) {
+            match_num = SvIV(ST(2));
+        }
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        RETVAL = st_bless_ptr(ST_CLASS_TOKENSTREAM, 
+                    st_new_tokenizer(st_hvref_fetch(self, "re"), heat_seeker, match_num,
+                        st_lang_abbrevs(lang ? *lang : NULL)));
+
+#line 647 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_snip_spans_batch); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_snip_spans_batch)
+{
+    dVAR; dXSARGS;
+    if (items < 7)
+       croak_xs_usage(cv,  "self, docs, term_set, window, as_sentences, max_spans, num_threads, ...");
+    {
+	SV*	self = ST(0)
+;
+	SV*	docs = ST(1)
+;
+	SV*	term_set = ST(2)
+;
+	IV	window = (IV)SvIV(ST(3))
+;
+	boolean	as_sentences = (boolean)SvIV(ST(4))
+;
+	I32	max_spans = (I32)SvIV(ST(5))
+;
+	I32	num_threads = (I32)SvIV(ST(6))
+;
+#line 355 "Tools.xs"
+        SV** lang;
+        AV* offsets = NULL;
+        IV size = 0;
+
+#line 681 "Tools.c"
+	SV *	RETVAL;
+#line 360 "Tools.xs"
+        if (!SvROK(docs) || SvTYPE(SvRV(docs)) != SVt_PVAV) {
+            croak("docs must be an ARRAY reference");
+        }
+        if (items > 7 && SvOK(ST(7))) {
+            if (!SvROK(ST(7)) || SvTYPE(SvRV(ST(7))) != SVt_PVAV) {
+                croak("offsets must be an ARRAY reference");
+            }
+            offsets = (AV*)SvRV(ST(7));
+        }
+        if (items > 8) {
+            size = SvIV(ST(8));
+        }
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        RETVAL = newRV_inc((SV*)st_snip_batch((AV*)SvRV(docs), offsets, size,
+                    st_hvref_fetch(self, "re"), term_set, 
+                    st_lang_abbrevs(lang ? *lang : NULL),
+                    window, as_sentences, max_spans, num_threads));
+
+#line 702 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_set_debug); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_set_debug)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, val");
+    {
+	SV*	self = ST(0)
+;
+	boolean	val = (boolean)SvIV(ST(1))
+;
+	SV *	RETVAL;
+#line 387 "Tools.xs"
+        SV* st_debug_var;
+        st_debug_var = get_sv("Search::Tools::XS_DEBUG", GV_ADD);
+        //warn(" st_debug_var before = '%s'\n", SvPV_nolen(st_debug_var));
+        SvIV_set(st_debug_var, val);
+        SvIOK_on(st_debug_var);
+        //warn("ST_DEBUG set to %d", val);
+        //warn(" st_debug_var set = '%d'\n", ST_DEBUG);
+        if (SvREFCNT(st_debug_var) == 1) {
+            // IMPORTANT because we access var from Perl and C
+            SvREFCNT_inc(st_debug_var);
+        }
+        RETVAL = st_debug_var;
+
+#line 736 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_add_abbreviations); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_add_abbreviations)
+{
+    dVAR; dXSARGS;
+    if (items != 3)
+       croak_xs_usage(cv,  "CLASS, lang, words");
+    {
+	SV*	CLASS = ST(0)
+;
+	SV*	lang = ST(1)
+;
+	SV*	words = ST(2)
+;
+#line 411 "Tools.xs"
+        AV* av;
+        I32 i, len;
+        STRLEN lang_len, wlen;
+        const char* lang_str;
+        U8* word;
+        U8 buf[(ST_MAX_ABBREV_BYTES*UTF8_MAXBYTES_CASE)+1];
+        st_abbrevs* ab;
+
+#line 766 "Tools.c"
+	IV	RETVAL;
+	dXSTARG;
+#line 420 "Tools.xs"
+        if (!SvROK(words) || SvTYPE(SvRV(words)) != SVt_PVAV) {
+            croak("words must be an ARRAY ref");
+        }
+        av       = (AV*)SvRV(words);
+        len      = av_len(av) + 1;
+        lang_str = SvPV(lang, lang_len);
+        /* check every word first, so a croak leaves nothing allocated */
+        for (i = 0; i < len; i++) {
+            word = (U8*)SvPVutf8(st_av_fetch(av, i), wlen);
+            st_abbrev_fold(word, wlen, buf);
+        }
+        ab = st_new_abbrevs(lang_str, lang_len, 
+                st_find_abbrevs(lang_str, lang_len), len);
+        for (i = 0; i < len; i++) {
+            word = (U8*)SvPVutf8(st_av_fetch(av, i), wlen);
+            st_abbrevs_add(ab, word, wlen);
+        }
+        st_abbrevs_register(ab);
+        RETVAL = ab->num;
+
+#line 790 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Tokenizer_get_offsets); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Tokenizer_get_offsets)
+{
+    dVAR; dXSARGS;
+    if (items < 3 || items > 7)
+       croak_xs_usage(cv,  "self, str, regex, max_hits = 0, max_bytes = 0, literals = NULL, max_len = 0");
+    {
+	SV*	self = ST(0)
+;
+	SV*	str = ST(1)
+;
+	SV*	regex = ST(2)
+;
+	IV	max_hits;
+	IV	max_bytes;
+	SV*	literals;
+	IV	max_len;
+	SV *	RETVAL;
+
+	if (items < 4)
+	    max_hits = 0;
+	else {
+	    max_hits = (IV)SvIV(ST(3))
+;
+	}
+
+	if (items < 5)
+	    max_bytes = 0;
+	else {
+	    max_bytes = (IV)SvIV(ST(4))
+;
+	}
+
+	if (items < 6)
+	    literals = NULL;
+	else {
+	    literals = ST(5)
+;
+	}
+
+	if (items < 7)
+	    max_len = 0;
+	else {
+	    max_len = (IV)SvIV(ST(6))
+;
+	}
+#line 455 "Tools.xs"
+        if (literals && !SvOK(literals)) {
+            literals = NULL;
+        }
+        if (literals && (!SvROK(literals) || SvTYPE(SvRV(literals)) != SVt_PVAV)) {
+            croak("literals must be an ARRAY reference");
+        }
+        RETVAL = newRV_noinc((SV*)st_heat_seeker_offsets(str, regex, 
+                    max_hits, max_bytes,
+                    literals ? (AV*)SvRV(literals) : NULL, max_len));
+
+#line 855 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_dump); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_dump)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::dump() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 481 "Tools.xs"
+        st_dump_token_list(self);
+#line 881 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_next); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_next)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+#line 489 "Tools.xs"
+        SV *tok;
+
+#line 898 "Tools.c"
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::next() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 492 "Tools.xs"
+        //warn("len = %d and pos = %d", av_len(self->tokens), self->pos);
+        tok = st_token_list_fetch(self, self->pos);
+        if (tok == NULL) {
+            // empty list or exceeded end of list
+            RETVAL = &PL_sv_undef;
+        }
+        else {
+            self->pos++;
+            RETVAL = SvREFCNT_inc(tok);
+        }
+
+
+#line 921 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_prev); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_prev)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+#line 513 "Tools.xs"
+        SV *tok;
+        IV idx;
+
+#line 941 "Tools.c"
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::prev() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 517 "Tools.xs"
+        idx = self->pos - 1;
+        if (idx == -1) {
+            // like $array[-1]
+            idx = av_len(self->tokens);
+        }
+        tok = self->pos < 0 ? NULL : st_token_list_fetch(self, idx);
+        if (tok == NULL) {
+            // empty list or exceeded start of list
+            RETVAL = &PL_sv_undef;
+        }
+        else {
+            self->pos--;
+            RETVAL = SvREFCNT_inc(tok);
+        }
+
+
+#line 968 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_get_token); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_get_token)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, pos");
+    {
+	st_token_list *	self;
+	IV	pos = (IV)SvIV(ST(1))
+;
+#line 543 "Tools.xs"
+        SV *tok;
+
+#line 989 "Tools.c"
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::get_token() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 546 "Tools.xs"
+        if (pos < 0) {
+            pos += av_len(self->tokens) + 1;
+        }
+        tok = st_token_list_fetch(self, pos);
+        if (tok == NULL) {
+            RETVAL = &PL_sv_undef;
+        }
+        else {
+            RETVAL = SvREFCNT_inc(tok);
+        }
+
+#line 1011 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_set_pos); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_set_pos)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, new_pos");
+    {
+	st_token_list *	self;
+	IV	new_pos = (IV)SvIV(ST(1))
+;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::set_pos() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 567 "Tools.xs"
+        RETVAL = self->pos;
+        self->pos = new_pos;
+
+#line 1043 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_reset); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_reset)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::reset() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 579 "Tools.xs"
+        RETVAL = self->pos;
+        self->pos = 0;
+
+#line 1073 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_len); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_len)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::len() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 591 "Tools.xs"
+        RETVAL = av_len(self->tokens) + 1;
+
+#line 1102 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_num); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_num)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::num() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 602 "Tools.xs"
+        RETVAL = self->num;
+
+#line 1131 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_pos); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_pos)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::pos() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 613 "Tools.xs"
+        RETVAL = self->pos;
+
+#line 1160 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_as_array); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_as_array)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::as_array() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 624 "Tools.xs"
+        RETVAL = newRV_inc((SV*)st_token_list_as_array(self));
+
+#line 1188 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_get_heat); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_get_heat)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::get_heat() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 635 "Tools.xs"
+        RETVAL = newRV_noinc((SV*)st_i32_to_av(self->heat, self->num_hot));
+
+#line 1216 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_heat_spans); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_heat_spans)
+{
+    dVAR; dXSARGS;
+    if (items != 3)
+       croak_xs_usage(cv,  "self, window, as_sentences");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	st_token_list *	self;
+	IV	window = (IV)SvIV(ST(1))
+;
+	boolean	as_sentences = (boolean)SvIV(ST(2))
+;
+#line 648 "Tools.xs"
+        HV *heatmap;
+        I32 i, pos;
+        char key[32];
+
+#line 1243 "Tools.c"
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::heat_spans() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 653 "Tools.xs"
+        heatmap = newHV();
+        for (i = 0; i < self->num_hot; i++) {
+            STRLEN klen;
+            pos  = self->heat[i];
+            klen = my_snprintf(key, sizeof(key), "%ld", (long)pos);
+            hv_store(heatmap, key, klen, 
+                newSViv(self->hot[pos]), 0);
+        }
+        EXTEND(SP, 2);
+        mPUSHs(newRV_noinc((SV*)st_heat_spans(self, window, as_sentences)));
+        mPUSHs(newRV_noinc((SV*)heatmap));
+#line 1264 "Tools.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_get_sentence_starts); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_get_sentence_starts)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::get_sentence_starts() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 671 "Tools.xs"
+        RETVAL = newRV_noinc((SV*)st_i32_to_av(self->sentence_starts, 
+                                               self->num_hot));
+
+#line 1292 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_get_heat_packed); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_get_heat_packed)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::get_heat_packed() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 683 "Tools.xs"
+        /* heat is NULL until the first hot token */
+        RETVAL = self->num_hot
+            ? newSVpvn((char*)self->heat, self->num_hot * sizeof(I32))
+            : newSVpvs("");
+
+#line 1323 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_get_sentence_starts_packed); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_get_sentence_starts_packed)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::get_sentence_starts_packed() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 697 "Tools.xs"
+        RETVAL = self->num_hot
+            ? newSVpvn((char*)self->sentence_starts, 
+                       self->num_hot * sizeof(I32))
+            : newSVpvs("");
+
+#line 1354 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_matches); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_matches)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+#line 711 "Tools.xs"
+        AV *matches;
+        I32 pos;
+        I32 len;
+        I32 end;
+        st_token *token;
+
+#line 1377 "Tools.c"
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::matches() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 718 "Tools.xs"
+        matches = newAV();
+        len = av_len(self->tokens)+1;
+        end = self->num < len ? self->num : len;
+        pos = st_bits_next(self->bits[ST_TOKEN_MATCH], 0, end);
+        while (pos < end) {
+            av_push(matches, SvREFCNT_inc(st_token_list_fetch(self, pos)));
+            pos = st_bits_next(self->bits[ST_TOKEN_MATCH], pos + 1, end);
+        }
+        /* Tokens pushed on via as_array() */
+        for (pos = end; pos < len; pos++) {
+            token = st_token_list_token_at(self, pos);
+            if (token != NULL 
+                && ST_TOKEN_FLAG(token->list, token->pos, ST_TOKEN_MATCH)
+            ) {
+                av_push(matches, SvREFCNT_inc(st_token_list_fetch(self, pos)));
+            }
+        }
+        RETVAL = newRV_noinc((SV*)matches); /* no _inc -- this is only copy */
+
+#line 1407 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_num_matches); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_num_matches)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token_list *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token_list *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenList::num_matches() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 746 "Tools.xs"
+        RETVAL = st_token_list_num_matches(self);
+
+#line 1436 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenList_DESTROY); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenList_DESTROY)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	SV *	self = ST(0)
+;
+#line 757 "Tools.xs"
+        st_token_list *tl;
+        AV *tokens;
+
+#line 1457 "Tools.c"
+#line 763 "Tools.xs"
+        tl = (st_token_list*)st_extract_ptr(self);
+        if (ST_DEBUG) {
+            warn("............................");
+            warn("DESTROY %s [%ld] [0x%lx]\n", 
+                SvPV_nolen(self), (unsigned long)tl->ref_cnt, (unsigned long)tl);
+            st_describe_object(self);
+        }
+
+        /* drop the tokens first, since each holds a ref to tl.
+         * any Token still referenced elsewhere keeps tl alive.
+         */
+        tokens = tl->tokens;
+        tl->tokens = NULL;
+        SvREFCNT_dec(tokens);
+        st_token_list_release(tl);
+#line 1474 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_pos); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_pos)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::pos() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 792 "Tools.xs"
+        RETVAL = self->pos;
+
+#line 1501 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_str); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_str)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::str() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 803 "Tools.xs"
+        RETVAL = st_token_str(self);
+
+#line 1529 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_len); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_len)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::len() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 814 "Tools.xs"
+        RETVAL = self->list->len[self->pos];
+
+#line 1558 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_u8len); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_u8len)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::u8len() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 825 "Tools.xs"
+        RETVAL = self->list->u8len[self->pos];
+
+#line 1587 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_is_hot); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_is_hot)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::is_hot() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 836 "Tools.xs"
+        RETVAL = self->list->hot[self->pos];
+
+#line 1616 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_is_match); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_is_match)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::is_match() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 847 "Tools.xs"
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
+
+#line 1645 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_is_sentence_start); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_is_sentence_start)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::is_sentence_start() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 858 "Tools.xs"
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_SENTENCE_START);
+
+#line 1674 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_is_sentence_end); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_is_sentence_end)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::is_sentence_end() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 869 "Tools.xs"
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_SENTENCE_END);
+
+#line 1703 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_is_abbreviation); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_is_abbreviation)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::is_abbreviation() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 879 "Tools.xs"
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_ABBREVIATION);
+
+#line 1732 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_set_match); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_set_match)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, val");
+    {
+	st_token *	self;
+	IV	val = (IV)SvIV(ST(1))
+;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::set_match() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 890 "Tools.xs"
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
+        if (val) {
+            ST_TOKEN_SET_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
+        }
+        else {
+            ST_TOKEN_CLEAR_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
+        }
+
+#line 1769 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_set_hot); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_set_hot)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, val");
+    {
+	st_token *	self;
+	IV	val = (IV)SvIV(ST(1))
+;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::set_hot() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 908 "Tools.xs"
+        RETVAL = self->list->hot[self->pos];
+        self->list->hot[self->pos] = val;
+
+#line 1801 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_dump); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_dump)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_token *	self;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_token *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::Token::dump() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 920 "Tools.xs"
+        st_dump_token(self->list, self->pos);
+#line 1827 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__Token_DESTROY); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__Token_DESTROY)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	SV *	self = ST(0)
+;
+#line 928 "Tools.xs"
+        st_token *tok;
+
+#line 1845 "Tools.c"
+#line 931 "Tools.xs"
+        tok = (st_token*)st_extract_ptr(self);
+        if (ST_DEBUG) {
+            warn("............................");
+            warn("DESTROY %s [%ld] [0x%lx]\n", 
+                SvPV_nolen(self), (unsigned long)tok->list->ref_cnt, (unsigned long)tok);
+        }
+        st_token_list_release(tok->list);
+#line 1854 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermSet_new); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermSet_new)
+{
+    dVAR; dXSARGS;
+    if (items < 2)
+       croak_xs_usage(cv,  "CLASS, terms, ...");
+    {
+	char*	CLASS = (char *)SvPV_nolen(ST(0))
+;
+	SV*	terms = ST(1)
+;
+#line 952 "Tools.xs"
+        STRLEN len;
+        U8* wildcard;
+
+#line 1875 "Tools.c"
+	SV *	RETVAL;
+#line 956 "Tools.xs"
+        if (!SvROK(terms) || SvTYPE(SvRV(terms)) != SVt_PVAV) {
+            croak("terms must be an ARRAY ref");
+        }
+        wildcard = (U8*)"*";
+        if (items > 2 && SvOK(ST(2))) {
+            wildcard = (U8*)SvPV(ST(2), len);
+            if (len != 1) {
+                croak("wildcard must be a single byte");
+            }
+        }
+        RETVAL = st_bless_ptr(CLASS, 
+                    st_new_term_set((AV*)SvRV(terms), wildcard[0]));
+
+#line 1891 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermSet_contains); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermSet_contains)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, str");
+    {
+	st_term_set *	self;
+	SV*	str = ST(1)
+;
+#line 979 "Tools.xs"
+        STRLEN len;
+        U8* bytes;
+
+#line 1913 "Tools.c"
+	boolean	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_set *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermSet::contains() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 983 "Tools.xs"
+        bytes  = (U8*)SvPVutf8(str, len);
+        RETVAL = st_term_set_contains(self, bytes, len);
+
+#line 1928 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermSet_num_terms); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermSet_num_terms)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_term_set *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_set *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermSet::num_terms() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 995 "Tools.xs"
+        RETVAL = self->num + self->num_globs;
+
+#line 1957 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermSet_DESTROY); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermSet_DESTROY)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_term_set *	self;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_set *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermSet::DESTROY() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1006 "Tools.xs"
+        self->ref_cnt--;
+        if (self->ref_cnt < 1) {
+            st_free_term_set(self);
+        }
+#line 1986 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermMatcher_new); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermMatcher_new)
+{
+    dVAR; dXSARGS;
+    if (items < 2)
+       croak_xs_usage(cv,  "CLASS, terms, ...");
+    {
+	char*	CLASS = (char *)SvPV_nolen(ST(0))
+;
+	SV*	terms = ST(1)
+;
+#line 1024 "Tools.xs"
+        STRLEN len;
+        U8* wildcard;
+
+#line 2007 "Tools.c"
+	SV *	RETVAL;
+#line 1028 "Tools.xs"
+        if (!SvROK(terms) || SvTYPE(SvRV(terms)) != SVt_PVAV) {
+            croak("terms must be an ARRAY ref");
+        }
+        wildcard = (U8*)"*";
+        if (items > 2 && SvOK(ST(2))) {
+            wildcard = (U8*)SvPV(ST(2), len);
+            if (len != 1) {
+                croak("wildcard must be a single byte");
+            }
+        }
+        RETVAL = st_bless_ptr(CLASS, 
+                    st_new_term_matcher((AV*)SvRV(terms), wildcard[0]));
+
+#line 2023 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermMatcher_match); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermMatcher_match)
+{
+    dVAR; dXSARGS;
+    if (items < 2)
+       croak_xs_usage(cv,  "self, text, ...");
+    {
+	st_term_matcher *	self;
+	SV*	text = ST(1)
+;
+#line 1051 "Tools.xs"
+        boolean html;
+
+#line 2044 "Tools.c"
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_matcher *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermMatcher::match() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1054 "Tools.xs"
+        html   = items > 2 && SvTRUE(ST(2));
+        RETVAL = newRV_noinc((SV*)st_term_matcher_match(self, text, html));
+
+#line 2058 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermMatcher_hilite); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermMatcher_hilite)
+{
+    dVAR; dXSARGS;
+    if (items != 5)
+       croak_xs_usage(cv,  "self, text, order, open_tags, close_tags");
+    {
+	st_term_matcher *	self;
+	SV*	text = ST(1)
+;
+	SV*	order = ST(2)
+;
+	SV*	open_tags = ST(3)
+;
+	SV*	close_tags = ST(4)
+;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_matcher *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermMatcher::hilite() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1070 "Tools.xs"
+        if (!SvROK(order) || SvTYPE(SvRV(order)) != SVt_PVAV
+            || !SvROK(open_tags) || SvTYPE(SvRV(open_tags)) != SVt_PVAV
+            || !SvROK(close_tags) || SvTYPE(SvRV(close_tags)) != SVt_PVAV
+        ) {
+            croak("order, open_tags and close_tags must be ARRAY refs");
+        }
+        RETVAL = st_term_matcher_hilite(self, text, (AV*)SvRV(order),
+                    (AV*)SvRV(open_tags), (AV*)SvRV(close_tags));
+        if (RETVAL == NULL) {
+            XSRETURN_UNDEF;
+        }
+
+#line 2104 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermMatcher_hilite_html); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermMatcher_hilite_html)
+{
+    dVAR; dXSARGS;
+    if (items != 6)
+       croak_xs_usage(cv,  "self, text, order, open_tags, close_tags, entities");
+    {
+	st_term_matcher *	self;
+	SV*	text = ST(1)
+;
+	SV*	order = ST(2)
+;
+	SV*	open_tags = ST(3)
+;
+	SV*	close_tags = ST(4)
+;
+	SV*	entities = ST(5)
+;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_matcher *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermMatcher::hilite_html() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1096 "Tools.xs"
+        if (!SvROK(order) || SvTYPE(SvRV(order)) != SVt_PVAV
+            || !SvROK(open_tags) || SvTYPE(SvRV(open_tags)) != SVt_PVAV
+            || !SvROK(close_tags) || SvTYPE(SvRV(close_tags)) != SVt_PVAV
+        ) {
+            croak("order, open_tags and close_tags must be ARRAY refs");
+        }
+        if (!SvROK(entities) || SvTYPE(SvRV(entities)) != SVt_PVHV) {
+            croak("entities must be a HASH ref");
+        }
+        RETVAL = st_term_matcher_hilite_html(self, text, (AV*)SvRV(order),
+                    (AV*)SvRV(open_tags), (AV*)SvRV(close_tags),
+                    (HV*)SvRV(entities));
+        if (RETVAL == NULL) {
+            XSRETURN_UNDEF;
+        }
+
+#line 2156 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermMatcher_num_terms); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermMatcher_num_terms)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_term_matcher *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_matcher *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermMatcher::num_terms() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1121 "Tools.xs"
+        RETVAL = self->num_terms;
+
+#line 2185 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TermMatcher_DESTROY); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TermMatcher_DESTROY)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_term_matcher *	self;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_term_matcher *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TermMatcher::DESTROY() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1132 "Tools.xs"
+        self->ref_cnt--;
+        if (self->ref_cnt < 1) {
+            st_free_term_matcher(self);
+        }
+#line 2214 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenStream_push); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenStream_push)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, chunk");
+    {
+	st_tokenizer *	self;
+	SV*	chunk = ST(1)
+;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_tokenizer *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenStream::push() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1150 "Tools.xs"
+        RETVAL = st_tokenizer_push(self, chunk, 0);
+
+#line 2242 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenStream_finish); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenStream_finish)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_tokenizer *	self;
+	SV *	RETVAL;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_tokenizer *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenStream::finish() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1161 "Tools.xs"
+        RETVAL = st_tokenizer_push(self, NULL, 1);
+
+#line 2270 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenStream_num_tokens); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenStream_num_tokens)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_tokenizer *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_tokenizer *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenStream::num_tokens() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1172 "Tools.xs"
+        RETVAL = self->num;
+
+#line 2299 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenStream_num_pending_bytes); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenStream_num_pending_bytes)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_tokenizer *	self;
+	IV	RETVAL;
+	dXSTARG;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_tokenizer *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenStream::num_pending_bytes() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1183 "Tools.xs"
+        RETVAL = SvCUR(self->carry);
+
+#line 2328 "Tools.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__TokenStream_DESTROY); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__TokenStream_DESTROY)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	st_tokenizer *	self;
+
+    if( sv_isobject(ST(0)) && (SvTYPE(SvRV(ST(0))) == SVt_PVMG) )
+            self = INT2PTR (st_tokenizer *, SvIV (SvRV (ST(0))));
+    else{
+            warn( "Search::Tools::TokenStream::DESTROY() -- self is not a blessed SV reference" );
+            XSRETURN_UNDEF;
+    }
+;
+#line 1194 "Tools.xs"
+        self->ref_cnt--;
+        if (self->ref_cnt < 1) {
+            st_free_tokenizer(self);
+        }
+#line 2357 "Tools.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Search__Tools__XML__escape_xml); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__XML__escape_xml)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "text, is_flagged_utf8");
+    {
+	char *	text = (char *)SvPV_nolen(ST(0))
+;
+	int	is_flagged_utf8 = (int)SvIV(ST(1))
+;
+	SV *	RETVAL;
+#line 1212 "Tools.xs"
+        RETVAL = st_escape_xml(text);
+        if (is_flagged_utf8) {
+            SvUTF8_on(RETVAL);
+        }
+
+#line 2381 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Search__Tools__XML__plain_text); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__XML__plain_text)
+{
+    dVAR; dXSARGS;
+    if (items != 3)
+       croak_xs_usage(cv,  "text, strip_markup, collapse_whitespace");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	SV*	text = ST(0)
+;
+	int	strip_markup = (int)SvIV(ST(1))
+;
+	int	collapse_whitespace = (int)SvIV(ST(2))
+;
+#line 1228 "Tools.xs"
+        STRLEN in_chars;
+        SV *plain;
+
+#line 2408 "Tools.c"
+#line 1232 "Tools.xs"
+        plain = st_plain_text(text, strip_markup, collapse_whitespace,
+                    &in_chars);
+        EXTEND(SP, 2);
+        mPUSHs(plain);
+        mPUSHu(in_chars);
+#line 2415 "Tools.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Search__Tools__XML__unescape); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Search__Tools__XML__unescape)
+{
+    dVAR; dXSARGS;
+    if (items != 4)
+       croak_xs_usage(cv,  "text, named, decimal, hex");
+    {
+	SV*	text = ST(0)
+;
+	int	named = (int)SvIV(ST(1))
+;
+	int	decimal = (int)SvIV(ST(2))
+;
+	int	hex = (int)SvIV(ST(3))
+;
+	SV *	RETVAL;
+#line 1247 "Tools.xs"
+        RETVAL = st_unescape_html(text, 
+                    (named ? ST_ENT_NAMED : 0)
+                    | (decimal ? ST_ENT_DECIMAL : 0)
+                    | (hex ? ST_ENT_HEX : 0));
+
+#line 2444 "Tools.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+#ifdef __cplusplus
+extern "C"
+#endif
+XS_EXTERNAL(boot_Search__Tools); /* prototype to pass -Wmissing-prototypes */
+XS_EXTERNAL(boot_Search__Tools)
+{
+#if PERL_VERSION_LE(5, 21, 5)
+    dVAR; dXSARGS;
+#else
+    dVAR; dXSBOOTARGSXSAPIVERCHK;
+#endif
+#if PERL_VERSION_LE(5, 8, 999) /* PERL_VERSION_LT is 5.33+ */
+    char* file = __FILE__;
+#else
+    const char* file = __FILE__;
+#endif
+
+    PERL_UNUSED_VAR(file);
+
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+#if PERL_VERSION_LE(5, 21, 5)
+    XS_VERSION_BOOTCHECK;
+#  ifdef XS_APIVERSION_BOOTCHECK
+    XS_APIVERSION_BOOTCHECK;
+#  endif
+#endif
+
+        newXS_deffile("Search::Tools::describe", XS_Search__Tools_describe);
+        newXS_deffile("Search::Tools::UTF8::byte_length", XS_Search__Tools__UTF8_byte_length);
+        newXS_deffile("Search::Tools::UTF8::is_perl_utf8_string", XS_Search__Tools__UTF8_is_perl_utf8_string);
+        newXS_deffile("Search::Tools::UTF8::find_bad_utf8", XS_Search__Tools__UTF8_find_bad_utf8);
+        newXS_deffile("Search::Tools::UTF8::find_bad_utf8_offset", XS_Search__Tools__UTF8_find_bad_utf8_offset);
+        newXS_deffile("Search::Tools::UTF8::is_ascii", XS_Search__Tools__UTF8_is_ascii);
+        newXS_deffile("Search::Tools::UTF8::is_latin1", XS_Search__Tools__UTF8_is_latin1);
+        newXS_deffile("Search::Tools::UTF8::debug_bytes", XS_Search__Tools__UTF8_debug_bytes);
+        newXS_deffile("Search::Tools::UTF8::find_bad_ascii", XS_Search__Tools__UTF8_find_bad_ascii);
+        newXS_deffile("Search::Tools::UTF8::find_bad_latin1", XS_Search__Tools__UTF8_find_bad_latin1);
+        newXS_deffile("Search::Tools::UTF8::classify_buffer", XS_Search__Tools__UTF8_classify_buffer);
+        newXS_deffile("Search::Tools::Tokenizer::tokenize", XS_Search__Tools__Tokenizer_tokenize);
+        newXS_deffile("Search::Tools::Tokenizer::tokenize_batch", XS_Search__Tools__Tokenizer_tokenize_batch);
+        newXS_deffile("Search::Tools::Tokenizer::tokenize_windows", XS_Search__Tools__Tokenizer_tokenize_windows);
+        newXS_deffile("Search::Tools::Tokenizer::stream", XS_Search__Tools__Tokenizer_stream);
+        newXS_deffile("Search::Tools::Tokenizer::snip_spans_batch", XS_Search__Tools__Tokenizer_snip_spans_batch);
+        newXS_deffile("Search::Tools::Tokenizer::set_debug", XS_Search__Tools__Tokenizer_set_debug);
+        newXS_deffile("Search::Tools::Tokenizer::add_abbreviations", XS_Search__Tools__Tokenizer_add_abbreviations);
+        newXS_deffile("Search::Tools::Tokenizer::get_offsets", XS_Search__Tools__Tokenizer_get_offsets);
+        newXS_deffile("Search::Tools::TokenList::dump", XS_Search__Tools__TokenList_dump);
+        newXS_deffile("Search::Tools::TokenList::next", XS_Search__Tools__TokenList_next);
+        newXS_deffile("Search::Tools::TokenList::prev", XS_Search__Tools__TokenList_prev);
+        newXS_deffile("Search::Tools::TokenList::get_token", XS_Search__Tools__TokenList_get_token);
+        newXS_deffile("Search::Tools::TokenList::set_pos", XS_Search__Tools__TokenList_set_pos);
+        newXS_deffile("Search::Tools::TokenList::reset", XS_Search__Tools__TokenList_reset);
+        newXS_deffile("Search::Tools::TokenList::len", XS_Search__Tools__TokenList_len);
+        newXS_deffile("Search::Tools::TokenList::num", XS_Search__Tools__TokenList_num);
+        newXS_deffile("Search::Tools::TokenList::pos", XS_Search__Tools__TokenList_pos);
+        newXS_deffile("Search::Tools::TokenList::as_array", XS_Search__Tools__TokenList_as_array);
+        newXS_deffile("Search::Tools::TokenList::get_heat", XS_Search__Tools__TokenList_get_heat);
+        newXS_deffile("Search::Tools::TokenList::heat_spans", XS_Search__Tools__TokenList_heat_spans);
+        newXS_deffile("Search::Tools::TokenList::get_sentence_starts", XS_Search__Tools__TokenList_get_sentence_starts);
+        newXS_deffile("Search::Tools::TokenList::get_heat_packed", XS_Search__Tools__TokenList_get_heat_packed);
+        newXS_deffile("Search::Tools::TokenList::get_sentence_starts_packed", XS_Search__Tools__TokenList_get_sentence_starts_packed);
+        newXS_deffile("Search::Tools::TokenList::matches", XS_Search__Tools__TokenList_matches);
+        newXS_deffile("Search::Tools::TokenList::num_matches", XS_Search__Tools__TokenList_num_matches);
+        newXS_deffile("Search::Tools::TokenList::DESTROY", XS_Search__Tools__TokenList_DESTROY);
+        newXS_deffile("Search::Tools::Token::pos", XS_Search__Tools__Token_pos);
+        newXS_deffile("Search::Tools::Token::str", XS_Search__Tools__Token_str);
+        newXS_deffile("Search::Tools::Token::len", XS_Search__Tools__Token_len);
+        newXS_deffile("Search::Tools::Token::u8len", XS_Search__Tools__Token_u8len);
+        newXS_deffile("Search::Tools::Token::is_hot", XS_Search__Tools__Token_is_hot);
+        newXS_deffile("Search::Tools::Token::is_match", XS_Search__Tools__Token_is_match);
+        newXS_deffile("Search::Tools::Token::is_sentence_start", XS_Search__Tools__Token_is_sentence_start);
+        newXS_deffile("Search::Tools::Token::is_sentence_end", XS_Search__Tools__Token_is_sentence_end);
+        newXS_deffile("Search::Tools::Token::is_abbreviation", XS_Search__Tools__Token_is_abbreviation);
+        newXS_deffile("Search::Tools::Token::set_match", XS_Search__Tools__Token_set_match);
+        newXS_deffile("Search::Tools::Token::set_hot", XS_Search__Tools__Token_set_hot);
+        newXS_deffile("Search::Tools::Token::dump", XS_Search__Tools__Token_dump);
+        newXS_deffile("Search::Tools::Token::DESTROY", XS_Search__Tools__Token_DESTROY);
+        newXS_deffile("Search::Tools::TermSet::new", XS_Search__Tools__TermSet_new);
+        newXS_deffile("Search::Tools::TermSet::contains", XS_Search__Tools__TermSet_contains);
+        newXS_deffile("Search::Tools::TermSet::num_terms", XS_Search__Tools__TermSet_num_terms);
+        newXS_deffile("Search::Tools::TermSet::DESTROY", XS_Search__Tools__TermSet_DESTROY);
+        newXS_deffile("Search::Tools::TermMatcher::new", XS_Search__Tools__TermMatcher_new);
+        newXS_deffile("Search::Tools::TermMatcher::match", XS_Search__Tools__TermMatcher_match);
+        newXS_deffile("Search::Tools::TermMatcher::hilite", XS_Search__Tools__TermMatcher_hilite);
+        newXS_deffile("Search::Tools::TermMatcher::hilite_html", XS_Search__Tools__TermMatcher_hilite_html);
+        newXS_deffile("Search::Tools::TermMatcher::num_terms", XS_Search__Tools__TermMatcher_num_terms);
+        newXS_deffile("Search::Tools::TermMatcher::DESTROY", XS_Search__Tools__TermMatcher_DESTROY);
+        newXS_deffile("Search::Tools::TokenStream::push", XS_Search__Tools__TokenStream_push);
+        newXS_deffile("Search::Tools::TokenStream::finish", XS_Search__Tools__TokenStream_finish);
+        newXS_deffile("Search::Tools::TokenStream::num_tokens", XS_Search__Tools__TokenStream_num_tokens);
+        newXS_deffile("Search::Tools::TokenStream::num_pending_bytes", XS_Search__Tools__TokenStream_num_pending_bytes);
+        newXS_deffile("Search::Tools::TokenStream::DESTROY", XS_Search__Tools__TokenStream_DESTROY);
+        newXS_deffile("Search::Tools::XML::_escape_xml", XS_Search__Tools__XML__escape_xml);
+        newXS_deffile("Search::Tools::XML::_plain_text", XS_Search__Tools__XML__plain_text);
+        newXS_deffile("Search::Tools::XML::_unescape", XS_Search__Tools__XML__unescape);
+
+    /* Initialisation Section */
+
+#line 220 "Tools.xs"
+    st_init_abbrevs();
+
+#line 2553 "Tools.c"
+
+    /* End of Initialisation Section */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  if PERL_VERSION_GE(5, 9, 0)
+    if (PL_unitcheckav)
+        call_list(PL_scopestack_ix, PL_unitcheckav);
+#  endif
+    XSRETURN_YES;
+#else
+    Perl_xs_boot_epilog(aTHX_ ax);
+#endif
+}
+
@@ -92,6 +92,24 @@ find_bad_utf8(string)
     OUTPUT:
         RETVAL
 
+
+IV
+find_bad_utf8_offset(string)
+    SV* string;
+
+    PREINIT:
+        STRLEN          len;
+        unsigned char*  bytes;
+        STRLEN          i;
+
+    CODE:
+        bytes  = (unsigned char*)SvPV(string, len);
+        i      = st_find_bad_utf8_offset(bytes, len);
+        RETVAL = i == len ? -1 : (IV)i;
+
+    OUTPUT:
+        RETVAL
+
      
 # benchmarks show these XS versions are 9x faster
 # than their native Perl regex counterparts
@@ -113,17 +131,10 @@ is_latin1(string)
     PREINIT:
         STRLEN         len;
         unsigned char* bytes;
-        unsigned int   i;
 
     CODE:
         bytes  = (unsigned char*)SvPV(string, len);
-        RETVAL = 1;
-        for(i=0; i < len; i++) {
-            if (bytes[i] > 0x7f && bytes[i] < 0xa0) {
-                RETVAL = 0;
-                break;
-            }
-        }
+        RETVAL = st_find_c1(bytes, len) == len;
 
     OUTPUT:
         RETVAL
@@ -152,17 +163,12 @@ find_bad_ascii(string)
     PREINIT:
         STRLEN          len;
         unsigned char*  bytes;
-        int             i;
+        STRLEN          i;
         
     CODE:
         bytes  = (unsigned char*)SvPV(string, len);
-        RETVAL = -1;
-        for(i=0; i < len; i++) {
-            if (bytes[i] >= 0x80) {
-                RETVAL = i;
-                break;
-            }  
-        }
+        i      = st_find_non_ascii(bytes, len);
+        RETVAL = i == len ? -1 : (IV)i;
 
     OUTPUT:
         RETVAL
@@ -174,22 +180,35 @@ find_bad_latin1(string)
     PREINIT:
         STRLEN          len;
         unsigned char*  bytes;
-        int             i;
+        STRLEN          i;
 
     CODE:
         bytes  = (unsigned char*)SvPV(string, len);
-        RETVAL = -1;
-        for(i=0; i < len; i++) {
-            if (bytes[i] > 0x7f && bytes[i] < 0xa0) {
-                RETVAL = i;
-                break;
-            }
-        }
+        i      = st_find_c1(bytes, len);
+        RETVAL = i == len ? -1 : (int)i;
 
     OUTPUT:
         RETVAL
 
 
+void
+classify_buffer(string)
+    SV* string;
+
+    PREINIT:
+        STRLEN          len;
+        unsigned char*  bytes;
+        int             flags;
+
+    PPCODE:
+        bytes = (unsigned char*)SvPV(string, len);
+        flags = st_classify_buf(bytes, len);
+        EXTEND(SP, 3);
+        mPUSHi(flags & ST_BUF_ASCII  ? 1 : 0);
+        mPUSHi(flags & ST_BUF_LATIN1 ? 1 : 0);
+        mPUSHi(flags & ST_BUF_UTF8   ? 1 : 0);
+
+
 
 #############################################################################
 
@@ -197,6 +216,9 @@ MODULE = Search::Tools       PACKAGE = Search::Tools::Tokenizer
 
 PROTOTYPES: enable
 
+BOOT:
+    st_init_abbrevs();
+
 SV*
 tokenize(self, str, ...)
     SV* self;
@@ -205,10 +227,9 @@ tokenize(self, str, ...)
     PREINIT:
         SV* token_re;
         SV* token_list_sv;
-        STRLEN len;
-        U8* bytes;
         SV* heat_seeker = NULL;
         IV match_num;
+        SV** lang;
         
     CODE:
         if (items > 2) {
@@ -219,35 +240,144 @@ tokenize(self, str, ...)
             match_num = SvIV(ST(3));
         }
         
-        /* test if utf8 flag on and make sure it is.
-         * otherwise, regex for \w can fail for multibyte chars.
-         * we do a slight (~7%) optimization for ascii str because
-         * the regex engine is faster for all-ascii texts.
-         * the logic is: 
-         *  if the flag is on, ok.
-         *  else, 
-         *      if the string is ascii, ok for flag to be off,
-         *      but we don't turn it off. 
-         *      if the string is NOT ascii, make sure it is utf8
-         *      and turn the flag on. 
-         */
-        if (!SvUTF8(str)) {
-            if (!st_is_ascii(str)) {
-                bytes  = (U8*)SvPV(str, len);
-                if(!is_utf8_string(bytes, len)) {
-                    croak(ST_BAD_UTF8);
-                }
-                SvUTF8_on(str);
-            }
-        }
-
+        st_tokenize_check_utf8(str);
         token_re = st_hvref_fetch(self, "re");
-        token_list_sv = st_tokenize(str, token_re, heat_seeker, match_num);
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        token_list_sv = st_tokenize(str, token_re, heat_seeker, match_num,
+                            st_lang_abbrevs(lang ? *lang : NULL));
         RETVAL = token_list_sv;
     
     OUTPUT:
         RETVAL
 
+
+SV*
+tokenize_batch(self, docs, ...)
+    SV* self;
+    SV* docs;
+    
+    PREINIT:
+        SV* token_re;
+        SV* heat_seeker = NULL;
+        IV match_num;
+        SV** lang;
+        AV* lists;
+        
+    CODE:
+        if (!SvROK(docs) || SvTYPE(SvRV(docs)) != SVt_PVAV) {
+            croak("docs must be an ARRAY reference");
+        }
+        if (items > 2 && SvOK(ST(2))) {
+            heat_seeker = ST(2);
+        }
+        match_num = 0;
+        if (items > 3) {
+            match_num = SvIV(ST(3));
+        }
+        
+        token_re = st_hvref_fetch(self, "re");
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        lists = st_tokenize_batch((AV*)SvRV(docs), token_re, heat_seeker, 
+                    match_num, st_lang_abbrevs(lang ? *lang : NULL));
+        RETVAL = newRV_inc((SV*)lists);
+    
+    OUTPUT:
+        RETVAL
+
+SV*
+tokenize_windows(self, str, offsets, size, ...)
+    SV* self;
+    SV* str;
+    SV* offsets;
+    IV size;
+    
+    PREINIT:
+        SV* heat_seeker = NULL;
+        IV match_num;
+        SV** lang;
+        
+    CODE:
+        if (!SvROK(offsets) || SvTYPE(SvRV(offsets)) != SVt_PVAV) {
+            croak("offsets must be an ARRAY reference");
+        }
+        if (items > 4 && SvOK(ST(4))) {
+            heat_seeker = ST(4);
+        }
+        match_num = 0;
+        if (items > 5) {
+            match_num = SvIV(ST(5));
+        }
+        
+        st_tokenize_check_utf8(str);
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        RETVAL = st_tokenize_windows(str, (AV*)SvRV(offsets), size, 
+                    st_hvref_fetch(self, "re"), heat_seeker, match_num,
+                    st_lang_abbrevs(lang ? *lang : NULL));
+    
+    OUTPUT:
+        RETVAL
+
+SV*
+stream(self, ...)
+    SV* self;
+    
+    PREINIT:
+        SV* heat_seeker = NULL;
+        IV match_num = 0;
+        SV** lang;
+        
+    CODE:
+        if (items > 1 && SvOK(ST(1))) {
+            heat_seeker = ST(1);
+        }
+        if (items > 2) {
+            match_num = SvIV(ST(2));
+        }
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        RETVAL = st_bless_ptr(ST_CLASS_TOKENSTREAM, 
+                    st_new_tokenizer(st_hvref_fetch(self, "re"), heat_seeker, match_num,
+                        st_lang_abbrevs(lang ? *lang : NULL)));
+    
+    OUTPUT:
+        RETVAL
+
+SV*
+snip_spans_batch(self, docs, term_set, window, as_sentences, max_spans, num_threads, ...)
+    SV* self;
+    SV* docs;
+    SV* term_set;
+    IV window;
+    boolean as_sentences;
+    I32 max_spans;
+    I32 num_threads;
+    
+    PREINIT:
+        SV** lang;
+        AV* offsets = NULL;
+        IV size = 0;
+        
+    CODE:
+        if (!SvROK(docs) || SvTYPE(SvRV(docs)) != SVt_PVAV) {
+            croak("docs must be an ARRAY reference");
+        }
+        if (items > 7 && SvOK(ST(7))) {
+            if (!SvROK(ST(7)) || SvTYPE(SvRV(ST(7))) != SVt_PVAV) {
+                croak("offsets must be an ARRAY reference");
+            }
+            offsets = (AV*)SvRV(ST(7));
+        }
+        if (items > 8) {
+            size = SvIV(ST(8));
+        }
+        lang = hv_fetchs((HV*)SvRV(self), "lang", 0);
+        RETVAL = newRV_inc((SV*)st_snip_batch((AV*)SvRV(docs), offsets, size,
+                    st_hvref_fetch(self, "re"), term_set, 
+                    st_lang_abbrevs(lang ? *lang : NULL),
+                    window, as_sentences, max_spans, num_threads));
+    
+    OUTPUT:
+        RETVAL
+
 SV*
 set_debug(self, val)
     SV* self;
@@ -271,14 +401,66 @@ set_debug(self, val)
         RETVAL
 
 
+IV
+add_abbreviations(CLASS, lang, words)
+    SV* CLASS;
+    SV* lang;
+    SV* words;
+    
+    PREINIT:
+        AV* av;
+        I32 i, len;
+        STRLEN lang_len, wlen;
+        const char* lang_str;
+        U8* word;
+        U8 buf[(ST_MAX_ABBREV_BYTES*UTF8_MAXBYTES_CASE)+1];
+        st_abbrevs* ab;
+    
+    CODE:
+        if (!SvROK(words) || SvTYPE(SvRV(words)) != SVt_PVAV) {
+            croak("words must be an ARRAY ref");
+        }
+        av       = (AV*)SvRV(words);
+        len      = av_len(av) + 1;
+        lang_str = SvPV(lang, lang_len);
+        /* check every word first, so a croak leaves nothing allocated */
+        for (i = 0; i < len; i++) {
+            word = (U8*)SvPVutf8(st_av_fetch(av, i), wlen);
+            st_abbrev_fold(word, wlen, buf);
+        }
+        ab = st_new_abbrevs(lang_str, lang_len, 
+                st_find_abbrevs(lang_str, lang_len), len);
+        for (i = 0; i < len; i++) {
+            word = (U8*)SvPVutf8(st_av_fetch(av, i), wlen);
+            st_abbrevs_add(ab, word, wlen);
+        }
+        st_abbrevs_register(ab);
+        RETVAL = ab->num;
+    
+    OUTPUT:
+        RETVAL
+
+
 SV*
-get_offsets(self, str, regex)
+get_offsets(self, str, regex, max_hits = 0, max_bytes = 0, literals = NULL, max_len = 0)
     SV* self;
     SV* str;
     SV* regex;
+    IV max_hits;
+    IV max_bytes;
+    SV* literals;
+    IV max_len;
     
     CODE:
-        RETVAL = newRV_noinc((SV*)st_heat_seeker_offsets(str, regex));
+        if (literals && !SvOK(literals)) {
+            literals = NULL;
+        }
+        if (literals && (!SvROK(literals) || SvTYPE(SvRV(literals)) != SVt_PVAV)) {
+            croak("literals must be an ARRAY reference");
+        }
+        RETVAL = newRV_noinc((SV*)st_heat_seeker_offsets(str, regex, 
+                    max_hits, max_bytes,
+                    literals ? (AV*)SvRV(literals) : NULL, max_len));
     
     OUTPUT:
         RETVAL
@@ -304,27 +486,18 @@ next(self)
     st_token_list *self;
    
     PREINIT:
-        IV len;
+        SV *tok;
         
     CODE:
-        len = av_len(self->tokens);
-        //warn("len = %d and pos = %d", len, self->pos);
-        
-        if (len == -1) {
-            // empty list
-            RETVAL = &PL_sv_undef;
-        }
-        else if (self->pos > len) {
-            // exceeded end of list
+        //warn("len = %d and pos = %d", av_len(self->tokens), self->pos);
+        tok = st_token_list_fetch(self, self->pos);
+        if (tok == NULL) {
+            // empty list or exceeded end of list
             RETVAL = &PL_sv_undef;
         }
         else {
-            if (!av_exists(self->tokens, self->pos)) {
-                ST_CROAK("no such index at %d", self->pos);
-            }
-            //st_dump_sv( st_av_fetch(self->tokens, self->pos) );
-            RETVAL = SvREFCNT_inc(st_av_fetch(self->tokens, self->pos++));
-            
+            self->pos++;
+            RETVAL = SvREFCNT_inc(tok);
         }
         
             
@@ -337,23 +510,23 @@ prev(self)
     st_token_list *self;
    
     PREINIT:
-        IV len;
+        SV *tok;
+        IV idx;
         
     CODE:
-        len = av_len(self->tokens);
-        if (len == -1) {
-            // empty list
-            RETVAL = &PL_sv_undef;
+        idx = self->pos - 1;
+        if (idx == -1) {
+            // like $array[-1]
+            idx = av_len(self->tokens);
         }
-        else if (self->pos < 0) {
-            // exceeded start of list
+        tok = self->pos < 0 ? NULL : st_token_list_fetch(self, idx);
+        if (tok == NULL) {
+            // empty list or exceeded start of list
             RETVAL = &PL_sv_undef;
         }
         else {
-            if (!av_exists(self->tokens, (self->pos-1))) {
-                ST_CROAK("no such index at %d", (self->pos-1));
-            }
-            RETVAL = SvREFCNT_inc(st_av_fetch(self->tokens, --(self->pos)));
+            self->pos--;
+            RETVAL = SvREFCNT_inc(tok);
         }
         
             
@@ -366,12 +539,19 @@ get_token(self, pos)
     st_token_list *self;
     IV pos;
     
+    PREINIT:
+        SV *tok;
+    
     CODE:
-        if (!av_exists(self->tokens, pos)) {
+        if (pos < 0) {
+            pos += av_len(self->tokens) + 1;
+        }
+        tok = st_token_list_fetch(self, pos);
+        if (tok == NULL) {
             RETVAL = &PL_sv_undef;
         }
         else {
-            RETVAL = SvREFCNT_inc(st_av_fetch(self->tokens, pos));
+            RETVAL = SvREFCNT_inc(tok);
         }
     
     OUTPUT:
@@ -441,7 +621,7 @@ as_array(self)
     st_token_list *self;
     
     CODE:
-        RETVAL = newRV_inc((SV*)self->tokens);
+        RETVAL = newRV_inc((SV*)st_token_list_as_array(self));
     
     OUTPUT:
         RETVAL
@@ -451,45 +631,73 @@ SV*
 get_heat(self)
     st_token_list *self;
     
+    CODE:
+        RETVAL = newRV_noinc((SV*)st_i32_to_av(self->heat, self->num_hot));
+    
+    OUTPUT:
+        RETVAL
+
+
+void
+heat_spans(self, window, as_sentences)
+    st_token_list *self;
+    IV window;
+    boolean as_sentences;
+    
     PREINIT:
-        AV *heat;
-        IV len;
-        IV pos;
-        SV* h;
+        HV *heatmap;
+        I32 i, pos;
+        char key[32];
     
-    CODE:
-        heat = newAV();
-        pos = 0;
-        len = av_len(self->heat)+1;
-        while (pos < len) {
-            h = st_av_fetch(self->heat, pos++);
-            av_push(heat, h);
+    PPCODE:
+        heatmap = newHV();
+        for (i = 0; i < self->num_hot; i++) {
+            STRLEN klen;
+            pos  = self->heat[i];
+            klen = my_snprintf(key, sizeof(key), "%ld", (long)pos);
+            hv_store(heatmap, key, klen, 
+                newSViv(self->hot[pos]), 0);
         }
-        RETVAL = newRV((SV*)heat);    /* no _inc -- this is a copy */
+        EXTEND(SP, 2);
+        mPUSHs(newRV_noinc((SV*)st_heat_spans(self, window, as_sentences)));
+        mPUSHs(newRV_noinc((SV*)heatmap));
+
+
+SV*
+get_sentence_starts(self)
+    st_token_list *self;
+    
+    CODE:
+        RETVAL = newRV_noinc((SV*)st_i32_to_av(self->sentence_starts, 
+                                               self->num_hot));
     
     OUTPUT:
         RETVAL
 
 
 SV*
-get_sentence_starts(self)
+get_heat_packed(self)
     st_token_list *self;
     
-    PREINIT:
-        AV *starts;
-        IV len;
-        IV pos;
-        SV* sstart;
+    CODE:
+        /* heat is NULL until the first hot token */
+        RETVAL = self->num_hot
+            ? newSVpvn((char*)self->heat, self->num_hot * sizeof(I32))
+            : newSVpvs("");
+    
+    OUTPUT:
+        RETVAL
+
+
+SV*
+get_sentence_starts_packed(self)
+    st_token_list *self;
     
     CODE:
-        starts = newAV();
-        pos = 0;
-        len = av_len(self->sentence_starts)+1;
-        while (pos < len) {
-            sstart = st_av_fetch(self->sentence_starts, pos++);
-            av_push(starts, sstart);
-        }
-        RETVAL = newRV((SV*)starts);    /* no _inc -- this is a copy */
+        RETVAL = self->num_hot
+            ? newSVpvn((char*)self->sentence_starts, 
+                       self->num_hot * sizeof(I32))
+            : newSVpvs("");
     
     OUTPUT:
         RETVAL
@@ -501,23 +709,30 @@ matches(self)
     
     PREINIT:
         AV *matches;
-        IV pos;
-        IV len;
-        SV* tok;
+        I32 pos;
+        I32 len;
+        I32 end;
         st_token *token;
     
     CODE:
         matches = newAV();
-        pos = 0;
         len = av_len(self->tokens)+1;
-        while (pos < len) {
-            tok = st_av_fetch(self->tokens, pos++);
-            token = (st_token*)st_extract_ptr(tok);
-            if (token->is_match) {
-                av_push(matches, tok);
+        end = self->num < len ? self->num : len;
+        pos = st_bits_next(self->bits[ST_TOKEN_MATCH], 0, end);
+        while (pos < end) {
+            av_push(matches, SvREFCNT_inc(st_token_list_fetch(self, pos)));
+            pos = st_bits_next(self->bits[ST_TOKEN_MATCH], pos + 1, end);
+        }
+        /* Tokens pushed on via as_array() */
+        for (pos = end; pos < len; pos++) {
+            token = st_token_list_token_at(self, pos);
+            if (token != NULL 
+                && ST_TOKEN_FLAG(token->list, token->pos, ST_TOKEN_MATCH)
+            ) {
+                av_push(matches, SvREFCNT_inc(st_token_list_fetch(self, pos)));
             }
         }
-        RETVAL = newRV((SV*)matches); /* no _inc -- this is only copy */
+        RETVAL = newRV_noinc((SV*)matches); /* no _inc -- this is only copy */
     
     OUTPUT:
         RETVAL
@@ -527,23 +742,8 @@ IV
 num_matches(self)
     st_token_list *self;
     
-    PREINIT:
-        IV pos;
-        IV len;
-        IV num_matches;
-        st_token *token;
-    
     CODE:
-        num_matches = 0;
-        pos = 0;
-        len = av_len(self->tokens)+1;
-        while (pos < len) {
-            token = (st_token*)st_av_fetch_ptr(self->tokens, pos++);
-            if (token->is_match) {
-                num_matches++;
-            }
-        }
-        RETVAL = num_matches;
+        RETVAL = st_token_list_num_matches(self);
     
     OUTPUT:
         RETVAL
@@ -555,22 +755,26 @@ DESTROY(self)
     
     PREINIT:
         st_token_list *tl;
+        AV *tokens;
         
     CODE:
         
         
         tl = (st_token_list*)st_extract_ptr(self);
-        tl->ref_cnt--;
         if (ST_DEBUG) {
             warn("............................");
             warn("DESTROY %s [%ld] [0x%lx]\n", 
                 SvPV_nolen(self), (unsigned long)tl->ref_cnt, (unsigned long)tl);
             st_describe_object(self);
-            st_dump_sv((SV*)tl->tokens);
-        }
-        if (tl->ref_cnt < 1) {
-            st_free_token_list(tl);
         }
+        
+        /* drop the tokens first, since each holds a ref to tl.
+         * any Token still referenced elsewhere keeps tl alive.
+         */
+        tokens = tl->tokens;
+        tl->tokens = NULL;
+        SvREFCNT_dec(tokens);
+        st_token_list_release(tl);
 
 
 
@@ -596,7 +800,7 @@ str(self)
     st_token *self;
             
     CODE:
-        RETVAL = SvREFCNT_inc(self->str);
+        RETVAL = st_token_str(self);
 
     OUTPUT:
         RETVAL
@@ -607,7 +811,7 @@ len(self)
     st_token *self;
     
     CODE:
-        RETVAL = self->len;
+        RETVAL = self->list->len[self->pos];
     
     OUTPUT:
         RETVAL
@@ -618,7 +822,7 @@ u8len(self)
     st_token *self;
     
     CODE:
-        RETVAL = self->u8len;
+        RETVAL = self->list->u8len[self->pos];
     
     OUTPUT:
         RETVAL
@@ -629,7 +833,7 @@ is_hot(self)
     st_token *self;
     
     CODE:
-        RETVAL = self->is_hot;
+        RETVAL = self->list->hot[self->pos];
     
     OUTPUT:
         RETVAL
@@ -640,7 +844,7 @@ is_match(self)
     st_token *self;
     
     CODE:
-        RETVAL = self->is_match;
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
     
     OUTPUT:
         RETVAL
@@ -651,7 +855,7 @@ is_sentence_start(self)
     st_token *self;
     
     CODE:
-        RETVAL = self->is_sentence_start;
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_SENTENCE_START);
     
     OUTPUT:
         RETVAL
@@ -662,7 +866,7 @@ is_sentence_end(self)
     st_token *self;
     
     CODE:
-        RETVAL = self->is_sentence_end;
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_SENTENCE_END);
     
     OUTPUT:
         RETVAL
@@ -672,7 +876,7 @@ is_abbreviation(self)
     st_token *self;
     
     CODE:
-        RETVAL = self->is_abbreviation;
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_ABBREVIATION);
     
     OUTPUT:
         RETVAL
@@ -683,8 +887,13 @@ set_match(self, val)
     IV val;
     
     CODE:
-        RETVAL = self->is_match;
-        self->is_match = val;
+        RETVAL = ST_TOKEN_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
+        if (val) {
+            ST_TOKEN_SET_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
+        }
+        else {
+            ST_TOKEN_CLEAR_FLAG(self->list, self->pos, ST_TOKEN_MATCH);
+        }
     
     OUTPUT:
         RETVAL
@@ -696,8 +905,8 @@ set_hot(self, val)
     IV val;
     
     CODE:
-        RETVAL = self->is_hot;
-        self->is_hot = val;
+        RETVAL = self->list->hot[self->pos];
+        self->list->hot[self->pos] = val;
     
     OUTPUT:
         RETVAL
@@ -708,7 +917,7 @@ dump(self)
     st_token *self;
     
     CODE:
-        st_dump_token(self);
+        st_dump_token(self->list, self->pos);
 
 
 void
@@ -720,16 +929,273 @@ DESTROY(self)
         
     CODE:
         tok = (st_token*)st_extract_ptr(self);
-        tok->ref_cnt--;
         if (ST_DEBUG) {
             warn("............................");
             warn("DESTROY %s [%ld] [0x%lx]\n", 
-                SvPV_nolen(self), (unsigned long)tok->ref_cnt, (unsigned long)tok);
+                SvPV_nolen(self), (unsigned long)tok->list->ref_cnt, (unsigned long)tok);
+        }
+        st_token_list_release(tok->list);
+    
+
+############################################################################
+
+MODULE = Search::Tools       PACKAGE = Search::Tools::TermSet
+
+PROTOTYPES: enable
+
+SV*
+new(CLASS, terms, ...)
+    char* CLASS;
+    SV*   terms;
+    
+    PREINIT:
+        STRLEN len;
+        U8* wildcard;
+    
+    CODE:
+        if (!SvROK(terms) || SvTYPE(SvRV(terms)) != SVt_PVAV) {
+            croak("terms must be an ARRAY ref");
+        }
+        wildcard = (U8*)"*";
+        if (items > 2 && SvOK(ST(2))) {
+            wildcard = (U8*)SvPV(ST(2), len);
+            if (len != 1) {
+                croak("wildcard must be a single byte");
+            }
+        }
+        RETVAL = st_bless_ptr(CLASS, 
+                    st_new_term_set((AV*)SvRV(terms), wildcard[0]));
+    
+    OUTPUT:
+        RETVAL
+
+
+boolean
+contains(self, str)
+    st_term_set *self;
+    SV* str;
+    
+    PREINIT:
+        STRLEN len;
+        U8* bytes;
+    
+    CODE:
+        bytes  = (U8*)SvPVutf8(str, len);
+        RETVAL = st_term_set_contains(self, bytes, len);
+    
+    OUTPUT:
+        RETVAL
+
+
+IV
+num_terms(self)
+    st_term_set *self;
+    
+    CODE:
+        RETVAL = self->num + self->num_globs;
+    
+    OUTPUT:
+        RETVAL
+
+
+void
+DESTROY(self)
+    st_term_set *self;
+    
+    CODE:
+        self->ref_cnt--;
+        if (self->ref_cnt < 1) {
+            st_free_term_set(self);
+        }
+
+
+############################################################################
+
+MODULE = Search::Tools       PACKAGE = Search::Tools::TermMatcher
+
+PROTOTYPES: enable
+
+SV*
+new(CLASS, terms, ...)
+    char* CLASS;
+    SV*   terms;
+    
+    PREINIT:
+        STRLEN len;
+        U8* wildcard;
+    
+    CODE:
+        if (!SvROK(terms) || SvTYPE(SvRV(terms)) != SVt_PVAV) {
+            croak("terms must be an ARRAY ref");
+        }
+        wildcard = (U8*)"*";
+        if (items > 2 && SvOK(ST(2))) {
+            wildcard = (U8*)SvPV(ST(2), len);
+            if (len != 1) {
+                croak("wildcard must be a single byte");
+            }
+        }
+        RETVAL = st_bless_ptr(CLASS, 
+                    st_new_term_matcher((AV*)SvRV(terms), wildcard[0]));
+    
+    OUTPUT:
+        RETVAL
+
+
+SV*
+match(self, text, ...)
+    st_term_matcher *self;
+    SV* text;
+    
+    PREINIT:
+        boolean html;
+    
+    CODE:
+        html   = items > 2 && SvTRUE(ST(2));
+        RETVAL = newRV_noinc((SV*)st_term_matcher_match(self, text, html));
+    
+    OUTPUT:
+        RETVAL
+
+
+SV*
+hilite(self, text, order, open_tags, close_tags)
+    st_term_matcher *self;
+    SV* text;
+    SV* order;
+    SV* open_tags;
+    SV* close_tags;
+    
+    CODE:
+        if (!SvROK(order) || SvTYPE(SvRV(order)) != SVt_PVAV
+            || !SvROK(open_tags) || SvTYPE(SvRV(open_tags)) != SVt_PVAV
+            || !SvROK(close_tags) || SvTYPE(SvRV(close_tags)) != SVt_PVAV
+        ) {
+            croak("order, open_tags and close_tags must be ARRAY refs");
+        }
+        RETVAL = st_term_matcher_hilite(self, text, (AV*)SvRV(order),
+                    (AV*)SvRV(open_tags), (AV*)SvRV(close_tags));
+        if (RETVAL == NULL) {
+            XSRETURN_UNDEF;
+        }
+    
+    OUTPUT:
+        RETVAL
+
+
+SV*
+hilite_html(self, text, order, open_tags, close_tags, entities)
+    st_term_matcher *self;
+    SV* text;
+    SV* order;
+    SV* open_tags;
+    SV* close_tags;
+    SV* entities;
+    
+    CODE:
+        if (!SvROK(order) || SvTYPE(SvRV(order)) != SVt_PVAV
+            || !SvROK(open_tags) || SvTYPE(SvRV(open_tags)) != SVt_PVAV
+            || !SvROK(close_tags) || SvTYPE(SvRV(close_tags)) != SVt_PVAV
+        ) {
+            croak("order, open_tags and close_tags must be ARRAY refs");
+        }
+        if (!SvROK(entities) || SvTYPE(SvRV(entities)) != SVt_PVHV) {
+            croak("entities must be a HASH ref");
         }
-        if (tok->ref_cnt < 1) {
-            st_free_token(tok);
+        RETVAL = st_term_matcher_hilite_html(self, text, (AV*)SvRV(order),
+                    (AV*)SvRV(open_tags), (AV*)SvRV(close_tags),
+                    (HV*)SvRV(entities));
+        if (RETVAL == NULL) {
+            XSRETURN_UNDEF;
         }
     
+    OUTPUT:
+        RETVAL
+
+
+IV
+num_terms(self)
+    st_term_matcher *self;
+    
+    CODE:
+        RETVAL = self->num_terms;
+    
+    OUTPUT:
+        RETVAL
+
+
+void
+DESTROY(self)
+    st_term_matcher *self;
+    
+    CODE:
+        self->ref_cnt--;
+        if (self->ref_cnt < 1) {
+            st_free_term_matcher(self);
+        }
+
+
+############################################################################
+
+MODULE = Search::Tools       PACKAGE = Search::Tools::TokenStream
+
+PROTOTYPES: enable
+
+SV*
+push(self, chunk)
+    st_tokenizer *self;
+    SV* chunk;
+    
+    CODE:
+        RETVAL = st_tokenizer_push(self, chunk, 0);
+    
+    OUTPUT:
+        RETVAL
+
+
+SV*
+finish(self)
+    st_tokenizer *self;
+    
+    CODE:
+        RETVAL = st_tokenizer_push(self, NULL, 1);
+    
+    OUTPUT:
+        RETVAL
+
+
+IV
+num_tokens(self)
+    st_tokenizer *self;
+    
+    CODE:
+        RETVAL = self->num;
+    
+    OUTPUT:
+        RETVAL
+
+
+IV
+num_pending_bytes(self)
+    st_tokenizer *self;
+    
+    CODE:
+        RETVAL = SvCUR(self->carry);
+    
+    OUTPUT:
+        RETVAL
+
+
+void
+DESTROY(self)
+    st_tokenizer *self;
+    
+    CODE:
+        self->ref_cnt--;
+        if (self->ref_cnt < 1) {
+            st_free_tokenizer(self);
+        }
+
 
 ############################################################################
 
@@ -751,3 +1217,38 @@ _escape_xml(text, is_flagged_utf8)
     OUTPUT:
         RETVAL
  
+
+void
+_plain_text(text, strip_markup, collapse_whitespace)
+    SV* text;
+    int strip_markup;
+    int collapse_whitespace;
+
+    PREINIT:
+        STRLEN in_chars;
+        SV *plain;
+
+    PPCODE:
+        plain = st_plain_text(text, strip_markup, collapse_whitespace,
+                    &in_chars);
+        EXTEND(SP, 2);
+        mPUSHs(plain);
+        mPUSHu(in_chars);
+
+
+SV*
+_unescape(text, named, decimal, hex)
+    SV* text;
+    int named;
+    int decimal;
+    int hex;
+
+    CODE:
+        RETVAL = st_unescape_html(text, 
+                    (named ? ST_ENT_NAMED : 0)
+                    | (decimal ? ST_ENT_DECIMAL : 0)
+                    | (hex ? ST_ENT_HEX : 0));
+
+    OUTPUT:
+        RETVAL
+
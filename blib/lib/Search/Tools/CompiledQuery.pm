@@ -0,0 +1,385 @@
+package Search::Tools::CompiledQuery;
+use Moo;
+extends 'Search::Tools::Object';
+use Carp;
+use Scalar::Util qw( blessed );
+use Search::Tools::TermSet;
+use Search::Tools::TermMatcher;
+use Search::Tools::Tokenizer;
+
+use namespace::autoclean;
+
+our $VERSION = '1.007';
+
+my @ro_attrs = qw(
+    qp
+    terms
+    treat_phrases_as_singles
+    regex
+    heat_regex
+    phrase_regex
+    phrase_gaps
+    literals
+    max_match_bytes
+);
+
+for my $attr (@ro_attrs) {
+    has $attr => ( is => 'ro' );
+}
+
+sub BUILD {
+    my $self = shift;
+    my $qp   = $self->{qp} or croak "qp required";
+    my $terms = $self->{terms} or croak "terms required";
+
+    # the same regex Query->terms_as_regex() returns
+    my $tpas = $self->{treat_phrases_as_singles};
+    $tpas = 1 unless defined $tpas;
+    $self->{treat_phrases_as_singles} = $tpas;
+    my $wildcard = $qp->wildcard;
+    my $wild_esc = quotemeta($wildcard);
+    my $wc       = $qp->word_characters;
+    my @re;
+    for my $term (@$terms) {
+        my $q = quotemeta($term);    # quotemeta speeds up the match, too
+                                     # even though we have to unquote below
+
+        $q =~ s/\\$wild_esc/[$wc]*/g;    # wildcard match is very approximate
+
+        # treat phrases like OR'd words
+        # since that will just create more matches.
+        # if hiliting later, the phrase will be treated as such.
+        $q =~ s/(\\ )+/\|/g if $tpas;
+
+        push @re, $q;
+    }
+    my $qre = sprintf( '(%s)', join( '|', @re ) );
+    $self->{regex} = qr/$qre/i;
+
+    # phrases must be OR'd for a token-at-a-time match
+    # or else no heat is generated.
+    my $qre_ORd = "$self->{regex}";
+    $qre_ORd =~ s/(\\ )+/\|/g;
+    $self->{heat_regex} = qr/^$qre_ORd$/;
+
+    # a more promiscuous check than the single space between
+    # phrase words, which is too naive for real text (e.g. st. john's)
+    my $phrase_re = "$self->{regex}";
+    $self->{phrase_gaps} = ( $phrase_re =~ s/(\\ )+/.+/g ) || 0;
+    $self->{phrase_regex} = qr/$phrase_re/;
+
+    $self->_build_literals;
+    $self->{term_set}     = $self->_build_term_set;
+    $self->{term_matcher} = $self->_build_term_matcher;
+
+    my $stemmer = $qp->stemmer;
+    if ($stemmer) {
+        my $re = $self->{heat_regex};
+        $self->{heat_seeker} = sub {
+            my $st = $stemmer->( $qp, $_[0]->str );
+            return $st =~ m/$re/;
+        };
+    }
+    else {
+
+        # the TermSet skips the regex engine entirely, so prefer it.
+        $self->{heat_seeker} = $self->{term_set} || $self->{heat_regex};
+    }
+
+    return $self;
+}
+
+# the chars besides themselves that can start a match of k, s and f
+# ignoring case: the Kelvin sign, long s, sharp s and the ligatures
+# that fold to ss, st, ff, fi, fl, ffi and ffl.
+my %FOLD_STARTS = (
+    k => [ chr(0x212A) ],
+    s => [ chr(0x17F), chr(0xDF), chr(0x1E9E), chr(0xFB05), chr(0xFB06) ],
+    f => [ map { chr($_) } ( 0xFB00 .. 0xFB04 ) ],
+);
+
+# the literals one of which starts every match of regex, as bytes,
+# for skipping straight to where a match might be. A literal ends
+# before the first wildcard, and before any char whose case fold could
+# match something else: k, s and f, which start the %FOLD_STARTS
+# folds, and any non-ASCII char, along with the char before it
+# (U+0130 folds to i plus a combining dot). A term starting with k, s
+# or f gets a literal for each of its %FOLD_STARTS, in both utf8 and
+# Latin-1 if it has one, instead.
+sub _build_literals {
+    my $self     = shift;
+    my $wildcard = $self->{qp}->wildcard;
+    my $tpas     = $self->{treat_phrases_as_singles};
+    my ( %literals, $max_len );
+    $self->{max_match_bytes} = 0;
+    for my $term ( @{ $self->{terms} } ) {
+        for my $alt ( $tpas ? split( m/ +/, $term ) : ($term) ) {
+            my $lit = '';
+            for my $c ( split( m//, $alt ) ) {
+                last if $c eq $wildcard;
+                if ( $c =~ m/[^\x00-\x7f]/ ) {
+                    chop $lit;
+                    last;
+                }
+                last if $c =~ m/[fks]/i;
+                $lit .= lc $c;
+            }
+            if ( length $lit ) {
+                $literals{$lit} = 1;
+            }
+            elsif ( my $starts = $FOLD_STARTS{ lc substr( $alt, 0, 1 ) } ) {
+                $literals{ lc substr( $alt, 0, 1 ) } = 1;
+                for my $c (@$starts) {
+                    $literals{$c} = 1 if ord($c) < 256;
+                    my $bytes = $c;
+                    utf8::encode($bytes);
+                    $literals{$bytes} = 1;
+                }
+            }
+            else {
+                return;
+            }
+
+            # no more than 12 bytes for each char: a fold of
+            # up to 3 chars of up to 4 bytes each.
+            if ( index( $alt, $wildcard ) >= 0 ) {
+                $max_len = 0;
+            }
+            elsif ( !defined $max_len or $max_len ) {
+                my $len = length($alt) * 12;
+                $max_len = $len if !$max_len or $len > $max_len;
+            }
+        }
+    }
+
+    # a literal that starts with another adds nothing
+    my @literals = sort keys %literals;
+    my @uniq;
+    for my $lit (@literals) {
+        next if @uniq and index( $lit, $uniq[-1] ) == 0;
+        push @uniq, $lit;
+    }
+    return unless @uniq;
+    $self->{literals}        = \@uniq;
+    $self->{max_match_bytes} = $max_len || 0;
+}
+
+# the TermSet is only equivalent to heat_regex when the wildcard
+# can match anything inside a token, which holds
+# for the default term_re and word_characters.
+sub _build_term_set {
+    my $self     = shift;
+    my $qp       = $self->{qp};
+    my $defaults = $qp->get_defaults;
+    return if length( $qp->wildcard ) != 1;
+    return if $qp->word_characters ne $defaults->{word_characters};
+    return if $qp->term_re ne $defaults->{term_re};
+    return Search::Tools::TermSet->new( $self->{terms}, $qp->wildcard );
+}
+
+# the TermMatcher knows the boundaries of the QueryParser regexes
+# only for the default word_characters and ignore_*_char.
+sub _build_term_matcher {
+    my $self     = shift;
+    my $qp       = $self->{qp};
+    my $defaults = $qp->get_defaults;
+    for my $attr (
+        qw( word_characters ignore_first_char ignore_last_char
+        whitespace tag_re )
+        )
+    {
+        return if $qp->$attr ne $defaults->{$attr};
+    }
+    return if length( $qp->wildcard ) != 1;
+    return if $qp->wildcard =~ m/^[\w\'\-\ ]$/;
+    return Search::Tools::TermMatcher->new( $self->{terms}, $qp->wildcard );
+}
+
+# a new ithread gets refs to an unblessed undef in place of the
+# TermSet and TermMatcher, so it builds its own the first time.
+sub _build_native {
+    my $self = shift;
+    return
+        unless grep { ref($_) and !blessed($_) }
+        @$self{qw( term_set term_matcher )};
+    $self->{term_set}     = $self->_build_term_set;
+    $self->{term_matcher} = $self->_build_term_matcher;
+    $self->{heat_seeker}  = $self->{term_set} || $self->{heat_regex}
+        unless $self->{qp}->stemmer;
+}
+
+sub heat_seeker {
+    my $self = shift;
+    $self->_build_native;
+    return $self->{heat_seeker};
+}
+
+sub term_set {
+    my $self = shift;
+    $self->_build_native;
+    return $self->{term_set};
+}
+
+sub term_matcher {
+    my $self = shift;
+    $self->_build_native;
+    return $self->{term_matcher};
+}
+
+sub tokenizer {
+    my $self = shift;
+    return $self->{_tokenizer} ||= Search::Tools::Tokenizer->new(
+        re    => $self->{qp}->term_re,
+        lang  => $self->{qp}->lang,
+        debug => $self->debug,
+    );
+}
+
+1;
+
+__END__
+
+=head1 NAME
+
+Search::Tools::CompiledQuery - query regexes and TermSet, built once
+
+=head1 SYNOPSIS
+
+ my $query    = Search::Tools::QueryParser->new->parse('quick "brown fox"');
+ my $compiled = $query->compile;
+ my $tokens   = $compiled->tokenizer->tokenize( $text,
+                    $compiled->heat_seeker );
+ my @hits     = grep { m/$compiled->{phrase_regex}/ } @strings;
+
+=head1 DESCRIPTION
+
+A CompiledQuery holds everything the Snipper, HeatMap, HiLiter and
+Query matches_text() and matches_html() need to find a Query's terms,
+built once per Query instead of once per document. Get one
+from Search::Tools::Query->compile(), which caches it.
+
+In a new ithread, a CompiledQuery made before it builds its own
+TermSet and TermMatcher the first time they are asked for.
+
+=head1 METHODS
+
+=head2 qp
+
+The Search::Tools::QueryParser of the Query.
+
+=head2 terms
+
+The Query terms().
+
+=head2 treat_phrases_as_singles
+
+Whether phrases were split into OR'd words in regex(). Default is true.
+
+=head2 regex
+
+Same as the Query terms_as_regex(I<treat_phrases_as_singles>).
+
+=head2 heat_regex
+
+A qr// that matches a whole token against any word in terms(),
+phrases OR'd.
+
+=head2 heat_seeker
+
+The I<heat_seeker> to pass to Tokenizer tokenize(). This is
+term_set() when it can be used, heat_regex() otherwise, or a CODE
+ref stemming each token if the QueryParser has a stemmer.
+
+=head2 phrase_regex
+
+A qr// matching regex() with any run of characters between the words
+of a phrase. Used to check that a snippet contains whole phrases.
+
+=head2 phrase_gaps
+
+The number of word gaps in the phrases in regex(). Zero if
+treat_phrases_as_singles() is true or there are no phrases.
+
+=head2 term_set
+
+A Search::Tools::TermSet of terms(), or undef if the QueryParser
+term_re or word_characters are not the defaults.
+
+=head2 term_matcher
+
+A Search::Tools::TermMatcher of terms(), or undef if the QueryParser
+word_characters, ignore_first_char, ignore_last_char, whitespace or
+tag_re are not the defaults.
+
+=head2 literals
+
+An ARRAY ref of lowercase byte strings, one of which starts every
+match of regex() in a string of either utf8 or Latin-1 bytes, ignoring
+ASCII case. undef if some term could match starting with any char,
+e.g. a term starting with a wildcard or a non-ASCII char. Pass to Tokenizer get_offsets() to skip the regex
+where none of them occurs.
+
+=head2 max_match_bytes
+
+The most bytes a match of regex() can span, or 0 if a term has
+a wildcard or there are no literals(). Goes with literals().
+
+=head2 tokenizer
+
+Returns a Search::Tools::Tokenizer using the QueryParser term_re
+and lang, created on first use.
+
+=head2 BUILD
+
+Builds the regexes. Called internally by new().
+
+=head1 AUTHOR
+
+Peter Karman C<< <karman@cpan.org> >>
+
+=head1 BUGS
+
+Please report any bugs or feature requests to C<bug-search-tools at rt.cpan.org>, or through
+the web interface at L<http://rt.cpan.org/NoAuth/ReportBug.html?Queue=Search-Tools>.
+I will be notified, and then you'll
+automatically be notified of progress on your bug as I make changes.
+
+=head1 SUPPORT
+
+You can find documentation for this module with the perldoc command.
+
+    perldoc Search::Tools
+
+
+You can also look for information at:
+
+=over 4
+
+=item * RT: CPAN's request tracker
+
+L<http://rt.cpan.org/NoAuth/Bugs.html?Dist=Search-Tools>
+
+=item * AnnoCPAN: Annotated CPAN documentation
+
+L<http://annocpan.org/dist/Search-Tools>
+
+=item * CPAN Ratings
+
+L<http://cpanratings.perl.org/d/Search-Tools>
+
+=item * Search CPAN
+
+L<http://search.cpan.org/dist/Search-Tools/>
+
+=back
+
+=head1 COPYRIGHT
+
+Copyright 2009 by Peter Karman.
+
+This package is free software; you can redistribute it and/or modify it under the
+same terms as Perl itself.
+
+=head1 SEE ALSO
+
+Search::Tools::Query, Search::Tools::TermSet, Search::Tools::TermMatcher
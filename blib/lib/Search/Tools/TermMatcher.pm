@@ -0,0 +1,131 @@
+package Search::Tools::TermMatcher;
+use strict;
+use warnings;
+use Search::Tools;    # XS required
+
+our $VERSION = '1.007';
+
+sub CLONE_SKIP {1}
+
+1;
+
+__END__
+
+=head1 NAME
+
+Search::Tools::TermMatcher - find query terms in a text in one pass
+
+=head1 SYNOPSIS
+
+ use Search::Tools::TermMatcher;
+ my $matcher = Search::Tools::TermMatcher->new(
+     [ 'quick', 'brown*', 'lazy dog' ] );
+ my $found = $matcher->match( $text );  # e.g. [ 1, 0, 1 ]
+ my $found = $matcher->match( $html, 1 );
+
+=head1 DESCRIPTION
+
+A TermMatcher is a C-side hash of the case-folded words of a list
+of query terms, phrases included. match() walks the text once
+and reports, for every term, whether the QueryParser regex for the
+term would match, without running the regexes.
+
+It assumes the QueryParser default word_characters,
+ignore_first_char and ignore_last_char. Search::Tools::Query
+matches_text() and matches_html() use it via
+Search::Tools::CompiledQuery when those are in effect.
+
+=head1 METHODS
+
+Search::Tools::TermMatcher is written in C/XS. Look at the source for
+Tools.xs and search-tools.c if you are interested in the internals.
+
+=head2 new( I<terms> [, I<wildcard>] )
+
+Returns a new TermMatcher. I<terms> is an array ref of strings,
+phrases with their words separated by a single space.
+I<wildcard> is a single character and defaults to C<*>. It may only
+end a word.
+
+=head2 match( I<text> [, I<html>] )
+
+Returns an array ref with an entry for each term: 1 if the term's
+plain regex (or html regex, if I<html> is true) matches I<text>, 0
+if not, or undef if the TermMatcher can't tell. That is the
+case for terms with a wildcard other than at the end of a word,
+for byte strings with 8-bit chars, and for terms not found in I<html>
+containing markup or entities. Check those with the term's regex.
+
+=head2 hilite( I<text>, I<order>, I<open_tags>, I<close_tags> )
+
+Returns I<text> with the terms hilited the way
+Search::Tools::HiLiter plain() does, in one pass. I<order> is an
+array ref of term indexes in the order to hilite them, and
+I<open_tags> and I<close_tags> hold the tags for each, in the same
+order. Returns undef if a term in I<order> needs its regex, for
+byte strings with 8-bit chars, or where a wildcard term matches
+just C<0>.
+
+=head2 hilite_html( I<html>, I<order>, I<open_tags>, I<close_tags>, I<entities> )
+
+Like hilite(), for Search::Tools::HiLiter html(). The entities in
+I<html> are decoded, with named ones looked up in the I<entities>
+hash ref (name to code point, like %Search::Tools::XML::HTML_ents),
+and the terms matched against the decoded text. A hilite is closed
+before any tags inside it and opened again after them. Block tags
+end words and phrases. Nothing is hilited inside C<script>, C<style>,
+C<title> or C<textarea> elements, comments or C<\002> .. C<\003>
+regions. A byte string with 8-bit chars is taken as Latin-1 and
+returned upgraded. Returns undef if a term in I<order> needs its
+regex.
+
+=head2 num_terms
+
+Returns the number of terms.
+
+=head1 AUTHOR
+
+Peter Karman C<< <karman@cpan.org> >>
+
+=head1 BUGS
+
+Please report any bugs or feature requests to C<bug-search-tools at rt.cpan.org>, or through
+the web interface at L<http://rt.cpan.org/NoAuth/ReportBug.html?Queue=Search-Tools>.  
+I will be notified, and then you'll
+automatically be notified of progress on your bug as I make changes.
+
+=head1 SUPPORT
+
+You can find documentation for this module with the perldoc command.
+
+    perldoc Search::Tools
+
+
+You can also look for information at:
+
+=over 4
+
+=item * RT: CPAN's request tracker
+
+L<http://rt.cpan.org/NoAuth/Bugs.html?Dist=Search-Tools>
+
+=item * AnnoCPAN: Annotated CPAN documentation
+
+L<http://annocpan.org/dist/Search-Tools>
+
+=item * CPAN Ratings
+
+L<http://cpanratings.perl.org/d/Search-Tools>
+
+=item * Search CPAN
+
+L<http://search.cpan.org/dist/Search-Tools/>
+
+=back
+
+=head1 COPYRIGHT
+
+Copyright 2009 by Peter Karman.
+
+This package is free software; you can redistribute it and/or modify it under the 
+same terms as Perl itself.
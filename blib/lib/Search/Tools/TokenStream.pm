@@ -0,0 +1,127 @@
+package Search::Tools::TokenStream;
+use strict;
+use warnings;
+use Search::Tools;    # XS required
+
+our $VERSION = '1.007';
+
+sub CLONE_SKIP {1}
+
+1;
+
+__END__
+
+=head1 NAME
+
+Search::Tools::TokenStream - tokenize a document one chunk at a time
+
+=head1 SYNOPSIS
+
+ use Search::Tools::Tokenizer;
+ my $tokenizer = Search::Tools::Tokenizer->new();
+ my $stream    = $tokenizer->stream( qr/^foo$/ );
+ 
+ open my $fh, '<:raw', 'huge.log' or die $!;
+ while ( read( $fh, my $buf, 65536 ) ) {
+     my $tokens = $stream->push($buf);
+     while ( my $tok = $tokens->next ) {
+         # do something with $tok
+     }
+ }
+ my $tokens = $stream->finish;    # whatever was left over
+
+=head1 DESCRIPTION
+
+A TokenStream tokenizes a document that is fed to it in pieces, so that
+memory use depends on the chunk size rather than the document size.
+Each push() returns a Search::Tools::TokenList with the tokens that
+later chunks can no longer change. A token that may continue into the
+next chunk, plus any bytes after it, is held back until the next push()
+or finish(). That includes a UTF-8 character split between chunks.
+No more than 64KB is held back besides such a token, so a run of
+more than that between two tokens may come out in pieces.
+
+Sentence start/end and abbreviation state carries across chunks, so the
+Tokens come out with the same flags tokenize() would give them on the
+whole document. Regexes that look past the end of their own match
+(lookahead assertions) may split differently at chunk boundaries.
+
+Token pos() values and the positions returned by get_heat() and
+get_sentence_starts() are relative to each TokenList. Add num_tokens()
+from before the push() to get the position within the document. A hot
+token whose sentence started in an earlier chunk reports a
+sentence start of 0.
+
+TokenStream objects are created with the stream() method of
+Search::Tools::Tokenizer.
+
+=head1 METHODS
+
+Search::Tools::TokenStream is written in C/XS. Look at the source for
+Tools.xs and search-tools.c if you are interested in the internals.
+
+=head2 push( I<chunk> )
+
+Appends I<chunk> to the stream and returns a TokenList of the completed
+tokens, which may be empty. I<chunk> should be UTF-8, either as
+characters or as raw bytes; a chunk that is not valid UTF-8 is fatal.
+
+=head2 finish
+
+Tokenizes whatever is left and returns it as a TokenList. The stream
+is then reset and may be used for another document.
+
+=head2 num_tokens
+
+Returns the number of tokens returned so far for the current document.
+
+=head2 num_pending_bytes
+
+Returns the number of bytes held back for the next push() or finish().
+
+=head1 AUTHOR
+
+Peter Karman C<< <karman@cpan.org> >>
+
+=head1 BUGS
+
+Please report any bugs or feature requests to C<bug-search-tools at rt.cpan.org>, or through
+the web interface at L<http://rt.cpan.org/NoAuth/ReportBug.html?Queue=Search-Tools>.  
+I will be notified, and then you'll
+automatically be notified of progress on your bug as I make changes.
+
+=head1 SUPPORT
+
+You can find documentation for this module with the perldoc command.
+
+    perldoc Search::Tools
+
+
+You can also look for information at:
+
+=over 4
+
+=item * RT: CPAN's request tracker
+
+L<http://rt.cpan.org/NoAuth/Bugs.html?Dist=Search-Tools>
+
+=item * AnnoCPAN: Annotated CPAN documentation
+
+L<http://annocpan.org/dist/Search-Tools>
+
+=item * CPAN Ratings
+
+L<http://cpanratings.perl.org/d/Search-Tools>
+
+=item * Search CPAN
+
+L<http://search.cpan.org/dist/Search-Tools/>
+
+=back
+
+=head1 COPYRIGHT
+
+Copyright 2009 by Peter Karman.
+
+This package is free software; you can redistribute it and/or modify it under the 
+same terms as Perl itself.
@@ -231,6 +231,13 @@ and for performance.
 
 See also the specific module documentation for individual requirements.
 
+=head1 THREADS
+
+TokenList, Token, TokenStream, TermSet and TermMatcher objects hold
+a C struct and are not copied into a new ithread: a reference to one
+there points to an unblessed undef. A Query, HiLiter or Snipper made
+before the thread builds its own TermSet and TermMatcher in it.
+
 =head1 HISTORY
 
 The public API has changed as of version 0.24. The following classes
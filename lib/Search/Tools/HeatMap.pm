@@ -23,6 +23,7 @@ my @attrs = qw( window_size
     as_sentences
     _treat_phrases_as_singles
     _qre
+    _compiled
     _query
     _stemmer
 );
@@ -49,8 +50,6 @@ Search::Tools::HeatMap - locate the best matches in a snippet extract
 
  if ( $heatmap->has_spans ) {
  
-     my $tokens_arr = $tokens->as_array;
-
      # stringify positions
      my @snips;
      for my $span ( @{ $heatmap->spans } ) {
@@ -126,22 +125,107 @@ This item is available only if debug() is true.
 
 =item unique
 
+=item proximate
+
 =back
 
+When I<tokens> is a Search::Tools::TokenList the spans are
+built in C by its heat_spans() method. The pure-Perl
+implementation is used for Search::Tools::TokenListPP.
+
 =cut
 
-# TODO this is mostly integer math and might be much
-# faster if rewritten in XS once the algorithm is "final".
+# the regex is a sanity check for phrases, with the \ replaced by a
+# more promiscuous check because the single space is too naive
+# for real text (e.g. st. john's). The Query's CompiledQuery
+# has it ready; otherwise build it from _qre.
+sub _phrase_check {
+    my $self = shift;
+    if ( my $compiled = $self->{_compiled} ) {
+        return ( $compiled->phrase_regex, $compiled->phrase_gaps );
+    }
+    my $qre = $self->{_qre};
+    my $query_has_phrase = $qre =~ s/(\\ )+/.+/g;
+    return ( qr/$qre/, $query_has_phrase );
+}
+
 sub _build {
     my $self         = shift;
     my $tokens       = $self->tokens or croak "tokens required";
     my $window       = $self->window_size || 20;
     my $as_sentences = $self->as_sentences || 0;
+    if ( $tokens->can('heat_spans') ) {
+        return $self->_xs_spans( $tokens, $window, $as_sentences );
+    }
     return $as_sentences
         ? $self->_as_sentences( $tokens, $window )
         : $self->_no_sentences( $tokens, $window );
 }
 
+# the XS TokenList builds, scores and sorts the spans in C
+# (see st_heat_spans() in search-tools.c), leaving only
+# the phrase checks, which need the query, to do here.
+sub _xs_spans {
+    my ( $self, $tokens, $window, $as_sentences ) = @_;
+    my $debug = $self->debug || 0;
+
+    my ( $spans, $heatmap )
+        = $tokens->heat_spans( int($window), $as_sentences );
+
+    my ( $qre, $query_has_phrase ) = $self->_phrase_check;
+    my $n_terms          = $self->{_query}->num_terms;
+
+    if ($debug) {
+        warn "token_list_heat: " . dump( $tokens->get_heat );
+        warn "n_terms: $n_terms";
+        warn "query_has_phrase: $query_has_phrase";
+    }
+
+    my @spans;
+SPAN:
+    for my $span (@$spans) {
+        if ( $query_has_phrase
+            and !$self->{_treat_phrases_as_singles} )
+        {
+            if ( !$self->{_stemmer} ) {
+                if ( $span->{str} !~ m/$qre/ ) {
+                    $debug
+                        and warn
+                        "treat_phrases_as_singles=FALSE and '$span->{str}' failed to match $qre\n";
+                    next SPAN;
+                }
+            }
+            elsif ( $n_terms == $query_has_phrase
+                && $n_terms > $span->{unique} )
+            {
+                $debug
+                    and warn "treat_phrases_as_singles=FALSE and '$span->{str}' "
+                    . "expected $n_terms unique terms, got $span->{unique}\n";
+                next SPAN;
+            }
+        }
+
+        if ($debug) {
+            $span->{str_w_pos} = join(
+                '',
+                map {
+                          $tokens->get_token($_)->str
+                        . ( exists $heatmap->{$_} ? $OPEN : '[' )
+                        . $_
+                        . ( exists $heatmap->{$_} ? $CLOSE : ']' )
+                } @{ $span->{pos} }
+            );
+        }
+
+        push @spans, $span;
+    }
+
+    $self->{spans}   = \@spans;
+    $self->{heatmap} = $heatmap;
+
+    return $self;
+}
+
 # currently _as_sentences() is mostly identical to _no_sentences()
 # with slightly fewer gymnastics.
 # Since we already know via sentence_starts where our boundaries are,
@@ -155,18 +239,13 @@ sub _as_sentences {
 
     # build heatmap with sentence starts
     my $num_tokens           = $tokens->len;
-    my $tokens_arr           = $tokens->as_array;
     my %heatmap              = ();
     my $token_list_heat      = $tokens->get_heat;
     my $heat_sentence_starts = $tokens->get_sentence_starts;
 
-    # this regex is a sanity check for phrases. we replace the \ with a
-    # more promiscuous check because the single space is too naive
-    # for real text (e.g. st. john's)
-    my $qre              = $self->{_qre};
+    my ( $qre, $query_has_phrase ) = $self->_phrase_check;
     my @phrases          = @{ $self->{_query}->phrases };
     my $n_terms          = $self->{_query}->num_terms;
-    my $query_has_phrase = $qre =~ s/(\\ )+/.+/g;
 
     if ($debug) {
         warn "heat_sentence_starts: " . dump($heat_sentence_starts);
@@ -401,17 +480,12 @@ sub _no_sentences {
     my $debug = $self->debug || 0;
 
     my $num_tokens      = $tokens->len;
-    my $tokens_arr      = $tokens->as_array;
     my %heatmap         = ();
     my $token_list_heat = $tokens->get_heat;
 
-    # this regex is a sanity check for phrases. we replace the \ with a
-    # more promiscuous check because the single space is too naive
-    # for real text (e.g. st. john's)
-    my $qre              = $self->{_qre};
+    my ( $qre, $query_has_phrase ) = $self->_phrase_check;
     my @phrases          = @{ $self->{_query}->phrases };
     my $n_terms          = $self->{_query}->num_terms;
-    my $query_has_phrase = $qre =~ s/(\\ )+/.+/g;
 
     if ($debug) {
         warn "token_list_heat: " . dump($token_list_heat);
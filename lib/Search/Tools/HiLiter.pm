@@ -14,6 +14,23 @@ our $VERSION = '1.007';
 
 my $XML = Search::Tools::XML->new;
 
+# html() never hilites inside, or across, these. Keep them the same as
+# ST_HTML_SKIP_TAGS and ST_HTML_BREAK_TAGS in search-tools.c.
+my @HTML_SKIP_TAGS  = qw( script style textarea title );
+my @HTML_BREAK_TAGS = qw(
+    address article aside blockquote body br caption center dd div dl dt
+    fieldset figcaption figure footer form h1 h2 h3 h4 h5 h6 head header
+    hr html legend li main nav ol option p pre section select table tbody
+    td tfoot th thead tr ul
+);
+my $HTML_BREAK_RE = join( '|',
+    "\002.*?\003",
+    "<!--.*?-->",
+    ( map {"<$_\\b[^>]*>.*?</$_\\b[^>]*>"} @HTML_SKIP_TAGS ),
+    "</?(?:" . join( '|', @HTML_SKIP_TAGS, @HTML_BREAK_TAGS ) . ")\\b[^>]*>",
+);
+$HTML_BREAK_RE = qr/$HTML_BREAK_RE/si;
+
 my @attrs = qw(
     query
     tag
@@ -39,6 +56,7 @@ sub BUILD {
 
     $self->{_tokenizer} = Search::Tools::Tokenizer->new(
         re    => $self->query->qp->term_re,
+        lang  => $self->query->qp->lang,
         debug => $self->debug,
     );
 
@@ -238,8 +256,26 @@ sub _regex_for {
 
 # based on HTML::HiLiter hilite()
 sub html {
-    my $self = shift;
-    my $text = shift or croak "need text to light()";
+    my $self    = shift;
+    my $text    = shift or croak "need text to light()";
+    my @kworder = $self->_kworder;
+
+    my $lit = $self->_hilite_native( $text, \@kworder, 1 );
+    return $lit if defined $lit;
+
+    # the regexes get the text between the elements and tags the
+    # TermMatcher does not hilite, so both ways give the same result.
+    my @parts = split( m/($HTML_BREAK_RE)/, $text );
+    for ( my $i = 0; $i < @parts; $i += 2 ) {
+        next unless length $parts[$i];
+        $parts[$i] = $self->_html_regex( $parts[$i], \@kworder );
+    }
+    return join( '', @parts );
+}
+
+sub _html_regex {
+    my ( $self, $text, $kworder ) = @_;
+    my @kworder = @$kworder;
 
     ###################################################################
     # 1.	create hash of query -> [ array of real HTML to hilite ]
@@ -249,13 +285,8 @@ sub html {
 
     ## 1
 
-    my $q2real = {};
-
     # this is going to be query => [ real_html ]
-
-    # if the query text matched in the text, then we need to
-    # use our prebuilt regexp
-    my @kworder = $self->_kworder;
+    my $q2real = {};
 
     # don't consider anything we've marked
     # with a 'nohiliter' attribute
@@ -413,18 +444,9 @@ sub plain_stemmer {
     my @kworder = $self->_kworder;
 
     # if stemmer is on, we must stem each token to look for a match
-    my $qre = $self->query->terms_as_regex(1);
-    $qre =~ s/(\\ )+/\|/g;    # TODO OR phrases together if (0) above?
-
-    my $re          = qr/^$qre$/;
     my $stemmer     = $self->query->qp->stemmer;
     my $qp          = $self->query->qp;
-    my $wildcard    = $qp->wildcard;
-    my $heat_seeker = sub {
-        my ($token) = @_;
-        my $st = $stemmer->( $qp, $token->str );
-        return $st =~ m/$re/;
-    };
+    my $heat_seeker = $self->query->compile(1)->heat_seeker;
 
     my $tokens = $self->{_tokenizer}->tokenize( $text, $heat_seeker );
 
@@ -481,6 +503,26 @@ TOK: while ( my $tok = $tokens->next ) {
     return $buf;
 }
 
+# the TermMatcher finds every term in one pass,
+# unless a term is left to its regex.
+sub _hilite_native {
+    my ( $self, $text, $kworder, $html ) = @_;
+    my $matcher = $self->{query}->compile->term_matcher or return;
+    my $qstr = $self->{query}->str;
+    my $args = $self->{_hilite_native_cache}->{$qstr} ||= do {
+        my $terms = $self->{query}->terms;
+        my %index = map { $terms->[$_] => $_ } 0 .. $#$terms;
+        [   [ map { $index{$_} } @$kworder ],
+            [ map { $self->open_tag($_) } @$kworder ],
+            [ map { $self->close_tag($_) } @$kworder ],
+        ];
+    };
+    return $matcher->hilite_html( $text, @$args,
+        \%Search::Tools::XML::HTML_ents )
+        if $html;
+    return $matcher->hilite( $text, @$args );
+}
+
 # based on HTML::HiLiter plaintext()
 sub plain {
     my $self      = shift;
@@ -489,6 +531,11 @@ sub plain {
     my $query_obj = $self->{query};
     my @kworder   = $self->_kworder;
 
+    if ( !$debug ) {
+        my $lit = $self->_hilite_native( $text, \@kworder );
+        return $lit if defined $lit;
+    }
+
     my $i = 0;
     my @markers;
 Q: for my $query (@kworder) {
@@ -619,8 +666,9 @@ text to highlight. You can control the style and color of the highlight tags.
 
 Some caveats if you are highlighting HTML or XML:
 Unlike its more powerful cousin HTML::HiLiter, Search::Tools::HiLiter
-knows nothing about context. This can give unexpected results 
-when your terms appear in the HTML C<<head>> or across block tag boundaries. 
+knows little about context. It skips C<<script>>, C<<style>> and
+C<<title>> text and ends phrases at block tags (see html()), but
+does not otherwise parse the HTML.
 Use HTML::HiLiter if you need a real HTML parser.
 It uses the same regular expressions as this class but is designed for full HTML
 documents rather than smaller fragments.
@@ -694,6 +742,10 @@ An alias for light().
 
 Add hiliting tags to plain I<text>.
 
+Uses the Query's Search::Tools::TermMatcher, when it has one and can
+hilite every term, to find all the terms in one pass. Otherwise
+each term's regex is matched in turn.
+
 Called internally by light().
 
 =head2 plain_stemmer( I<text> )
@@ -715,6 +767,14 @@ Currently calls plain_stemmer().
 
 Add hiliting tags to marked up I<text>.
 
+Uses the Query's Search::Tools::TermMatcher, when it has one and can
+hilite every term, to decode the entities and find all the terms in
+one pass, closing and reopening a hilite around any tags inside it.
+Terms are not hilited inside C<script>, C<style>, C<title> or
+C<textarea> elements, comments or C<nohiliter> regions. Otherwise
+each term's regex is matched in turn against the text between those
+and the block tags, so the results agree.
+
 Called internally by light().
 
 Note that stemming support for HTML I<text> is not yet supported.
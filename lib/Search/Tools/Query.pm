@@ -8,8 +8,8 @@ use overload
 use Carp;
 use Data::Dump qw( dump );
 use Search::Tools::RegEx;
+use Search::Tools::CompiledQuery;
 use Search::Tools::UTF8;
-use Search::Tools::Tokenizer;
 use Search::Tools::XML;
 
 use namespace::autoclean;
@@ -234,11 +234,7 @@ sub _matches_stemmed {
     my $count     = 0;
     my $qp        = $self->qp;
     my $stemmer   = $qp->stemmer;
-    my $wildcard  = $qp->wildcard;
-    my $tokenizer = Search::Tools::Tokenizer->new(
-        re    => $qp->term_re,
-        debug => $self->debug,
-    );
+    my $tokenizer = $self->compile->tokenizer;
 
     # stem the whole text, creating a new buffer to
     # match against. This covers both the cases where
@@ -258,12 +254,22 @@ sub _matches_stemmed {
 }
 
 sub _matches {
-    my $self  = shift;
-    my $style = shift;
-    my $text  = to_utf8( $_[0] );
-    my $count = 0;
-    for my $term ( @{ $self->{terms} } ) {
-        my $regex = $self->{regex}->{$term}->{$style};
+    my $self    = shift;
+    my $style   = shift;
+    my $text    = to_utf8( $_[0] );
+    my $count   = 0;
+    my $terms   = $self->{terms};
+    my $matcher = $self->compile->term_matcher;
+
+    # the TermMatcher answers for all the terms it can in one pass.
+    # undef means ask the term's regex.
+    my $found = $matcher ? $matcher->match( $text, $style eq 'html' ) : [];
+    for my $i ( 0 .. $#$terms ) {
+        if ( defined $found->[$i] ) {
+            $count += $found->[$i];
+            next;
+        }
+        my $regex = $self->{regex}->{ $terms->[$i] }->{$style};
         $count += $text =~ m/$regex/;
     }
     return $count;
@@ -299,39 +305,31 @@ logic.
 =cut
 
 sub terms_as_regex {
-    my $self                     = shift;
-    my $treat_phrases_as_singles = shift;
-    $treat_phrases_as_singles = 1 unless defined $treat_phrases_as_singles;
-    my $wildcard = $self->qp->wildcard;
-    my $wild_esc = quotemeta($wildcard);
-    my $wc       = $self->qp->word_characters;
-    my @re;
-    for my $term ( @{ $self->{terms} } ) {
-
-        my $q = quotemeta($term);    # quotemeta speeds up the match, too
-                                     # even though we have to unquote below
-
-        $q =~ s/\\$wild_esc/[$wc]*/g;    # wildcard match is very approximate
-
-        # treat phrases like OR'd words
-        # since that will just create more matches.
-        # if hiliting later, the phrase will be treated as such.
-        if ($treat_phrases_as_singles) {
-            $q =~ s/(\\ )+/\|/g;
-        }
+    my $self = shift;
+    return $self->compile(@_)->regex;
+}
 
-      # if keeping phrases together use a less-naive regex instead of a space.
-        else {
+=head2 compile([I<treat_phrases_as_singles>])
 
-            #$q = $self->regex_for($term)->plain();
-            #$q =~ s/(\\ )+/[^$wc]+/g;
-        }
+Returns a Search::Tools::CompiledQuery with the regexes and
+Search::Tools::TermSet used to find terms() in text, built on the
+first call and cached on the Query. I<treat_phrases_as_singles>
+defaults to true, as in terms_as_regex().
 
-        push( @re, $q );
-    }
+=cut
 
-    my $j = sprintf( '(%s)', join( '|', @re ) );
-    return qr/$j/i;
+sub compile {
+    my $self = shift;
+    my $tpas = shift;
+    $tpas = 1 unless defined $tpas;
+    $tpas = $tpas ? 1 : 0;
+    return $self->{_compiled}->{$tpas}
+        ||= Search::Tools::CompiledQuery->new(
+        qp                       => $self->qp,
+        terms                    => $self->{terms},
+        treat_phrases_as_singles => $tpas,
+        debug                    => $self->debug,
+        );
 }
 
 1;
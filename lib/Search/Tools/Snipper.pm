@@ -31,11 +31,13 @@ my @attrs = qw(
     force
     ignore_length
     max_chars
+    max_offsets
     occur
     query
     show
     snipper
     strip_markup
+    threads
     treat_phrases_as_singles
     type
     type_used
@@ -57,6 +59,7 @@ my %Defaults = (
     ignore_length            => 0,
     treat_phrases_as_singles => 1,
     strip_markup             => 0,
+    threads                  => 1,
 );
 
 for my $attr (@attrs) {
@@ -76,6 +79,7 @@ sub BUILD {
 
     $self->{_tokenizer} = Search::Tools::Tokenizer->new(
         re    => $self->query->qp->term_re,
+        lang  => $self->query->qp->lang,
         debug => $self->debug,
     );
 
@@ -84,8 +88,9 @@ sub BUILD {
     # regexp for splitting into terms in _re()
     $self->{_wc_regexp} = qr/[^$wc]+/io;
 
-    $self->{_qre}
-        = $self->query->terms_as_regex( $self->treat_phrases_as_singles );
+    $self->{_compiled}
+        = $self->query->compile( $self->treat_phrases_as_singles );
+    $self->{_qre} = $self->{_compiled}->regex;
 
     $self->count(0);
 
@@ -120,12 +125,31 @@ sub _normalize_whitespace {
 }
 
 sub snip {
+    my $self = shift;
+    my ( $text, $short ) = $self->_prepare_text(shift);
+    return $short if defined $short;
+
+    # we calculate the snipper each time since caller
+    # may set type() or snipper() between calls to snip().
+    my $func = $self->snipper || $self->_pick_snipper($text);
+
+    return $self->_finish_snip( $text, $func->( $self, $text ) );
+}
+
+# returns the text to snip, or (undef, $snip) if it is too short to.
+sub _prepare_text {
     my $self = shift;
     my $text = shift;
     if ( !defined $text ) {
         croak "text required to snip";
     }
 
+    if ( !$self->{use_pp}
+        and $self->strip_markup || $self->collapse_whitespace )
+    {
+        return $self->_prepare_text_native($text);
+    }
+
     # normalize encoding, esp for regular expressions.
     $text = to_utf8($text);
 
@@ -133,11 +157,11 @@ sub snip {
     if ( length($text) < $self->max_chars && !$self->ignore_length ) {
         if ( $self->show ) {
             if ( $self->strip_markup ) {
-                return Search::Tools::XML->no_html($text);
+                return ( undef, Search::Tools::XML->no_html($text) );
             }
-            return $text;
+            return ( undef, $text );
         }
-        return '';
+        return ( undef, '' );
     }
 
     if ( $self->strip_markup ) {
@@ -148,11 +172,30 @@ sub snip {
         _normalize_whitespace($text);
     }
 
-    # we calculate the snipper each time since caller
-    # may set type() or snipper() between calls to snip().
-    my $func = $self->snipper || $self->_pick_snipper($text);
+    return ($text);
+}
+
+# the same as _prepare_text() but with the decoding, markup stripping
+# and whitespace collapsing done in one pass in C.
+sub _prepare_text_native {
+    my ( $self, $text ) = @_;
+    my $strip = $self->strip_markup ? 1 : 0;
+    my ( $plain, $length )
+        = Search::Tools::XML::_plain_text( $text, $strip,
+        $self->collapse_whitespace ? 1 : 0 );
+
+    # don't snip if we're less than the threshold
+    if ( $length < $self->max_chars && !$self->ignore_length ) {
+        return ( undef, '' ) unless $self->show;
+        return ( undef,
+            ( Search::Tools::XML::_plain_text( $text, $strip, 0 ) )[0] );
+    }
+
+    return ($plain);
+}
 
-    my $s = $func->( $self, $text );
+sub _finish_snip {
+    my ( $self, $text, $s ) = @_;
 
     $self->debug and warn "snipped: '$s'\n";
 
@@ -177,6 +220,86 @@ sub snip {
 
 }
 
+sub snip_batch {
+    my $self  = shift;
+    my $texts = shift or croak "array ref of texts required";
+    croak "array ref of texts required" unless ref $texts eq 'ARRAY';
+
+    # the token and offset snippers can do their tokenizing and
+    # HeatMap work in C, on threads(), for the whole batch at once.
+    # The conditions match the ones under which _token() uses the TermSet.
+    my $term_set = $self->{_compiled}->term_set;
+    my $native
+        = !$self->snipper
+        && $term_set
+        && !$self->query->qp->stemmer
+        && !$self->{use_pp}
+        && !$self->debug;
+
+    my ( @prepared, @inputs, @offsets );
+    for my $t (@$texts) {
+        my ( $text, $short ) = $self->_prepare_text($t);
+        if ( defined $short ) {
+            push @prepared, [ undef, $short ];
+            next;
+        }
+        my $func = $self->snipper || $self->_pick_snipper($text);
+        my $type = $self->type_used;
+        my $offsets = $native && $type eq 'offset'
+            ? $self->_get_offsets($text)
+            : undef;
+        if ( $offsets and $self->_offset_misses( $text, $offsets ) ) {
+            push @prepared,
+                [ $text, undef, $type, undef, undef, sub { $_[0]->_dumb('') } ];
+        }
+        elsif ( $native and ( $type eq 'token' or $type eq 'offset' ) ) {
+            push @prepared, [ $text, undef, $type, $text, scalar @inputs ];
+            push @inputs,  $text;
+            push @offsets, $offsets;
+        }
+        else {
+            push @prepared, [ $text, undef, $type, undef, undef, $func ];
+        }
+    }
+
+    # HeatMap drops spans that miss a phrase, so we need all of them then.
+    my $qre = $self->{_compiled}->phrase_regex;
+    my $check_phrases = $self->{_compiled}->phrase_gaps
+        && !$self->{treat_phrases_as_singles};
+    my $spans = @inputs
+        ? $self->{_tokenizer}->snip_spans_batch(
+        \@inputs,                        $term_set,
+        int( $self->{context} || 20 ),  $self->{as_sentences} ? 1 : 0,
+        ( $check_phrases ? 0 : $self->occur ), $self->threads || 1,
+        \@offsets, $self->max_chars * 10
+        )
+        : [];
+
+    my @snips;
+    for my $p (@prepared) {
+        my ( $text, $short, $type, $input, $i, $func ) = @$p;
+        if ( defined $short ) {
+            push @snips, $short;
+            next;
+        }
+
+        # as if snip() were called on each text in turn
+        $self->type_used($type);
+        if ($func) {
+            push @snips, $self->_finish_snip( $text, $func->( $self, $text ) );
+        }
+        else {
+            my @strs = $spans->[$i] ? @{ $spans->[$i] } : ();
+            @strs = grep {m/$qre/} @strs if $check_phrases;
+            my $s = @strs
+                ? $self->_join_snips( $input, \@strs )
+                : $self->_dumb($input);
+            push @snips, $self->_finish_snip( $text, $s );
+        }
+    }
+    return \@snips;
+}
+
 sub _token {
     my $self = shift;
     my $qre  = $self->{_qre};
@@ -184,27 +307,19 @@ sub _token {
 
     my $method = ( $self->{use_pp} ) ? 'tokenize_pp' : 'tokenize';
 
-    # must split phrases into OR'd regex or else no heat is generated.
-    my $qre_ORd = $qre;
-    $qre_ORd =~ s/(\\ )+/\|/g;
-    my $heat_seeker = qr/^$qre_ORd$/;
-
-    # if stemmer is on, we must stem each token to look for a match
-    if ( $self->query->qp->stemmer ) {
-        my $stemmer = $self->query->qp->stemmer;
-        my $qp      = $self->query->qp;
-        my $re      = $heat_seeker;
-        $heat_seeker = sub {
-            my ($token) = @_;
-            my $st = $stemmer->( $qp, $token->str );
-            return $st =~ m/$re/;
-        };
-    }
+    my $heat_seeker = $self->{_compiled}->heat_seeker;
     my $tokens = $self->{_tokenizer}->$method( $_[0], $heat_seeker );
+    return $self->_heat_snip( $_[0], $tokens );
+}
+
+# the snip of $text from the hot spans in its TokenList $tokens.
+sub _heat_snip {
+    my ( $self, $text, $tokens ) = @_;
+    my $qre = $self->{_qre};
 
     #$self->debug and $tokens->dump;
 
-    return $self->_dumb( $_[0] ) unless scalar @{ $tokens->get_heat };
+    return $self->_dumb($text) unless length $tokens->get_heat_packed;
 
     my $heatmap = Search::Tools::HeatMap->new(
         tokens                    => $tokens,
@@ -213,6 +328,7 @@ sub _token {
         debug                     => $self->debug,
         _query                    => $self->query,
         _qre                      => $qre,
+        _compiled                 => $self->{_compiled},
         _treat_phrases_as_singles => $self->{treat_phrases_as_singles},
         _stemmer                  => $self->query->qp->stemmer,
     );
@@ -222,8 +338,6 @@ sub _token {
 
     $self->debug and warn "heatmap: " . dump $heatmap;
 
-    my $tokens_arr = $tokens->as_array;
-
     #warn "snips: " . dump $heatmap->spans;
     if ( $heatmap->has_spans ) {
 
@@ -234,50 +348,79 @@ sub _token {
             $self->debug and warn '>>>' . $span->{str_w_pos} . '<<<';
             push( @snips, $span->{str} );
         }
-        my $occur_index = $self->occur - 1;
-        if ( $#snips > $occur_index ) {
-            @snips = @snips[ 0 .. $occur_index ];
-        }
-        my $snip                   = join( $ellip, @snips );
-        my $snips_start_with_query = $_[0] =~ m/^\Q$snip\E/;
-        my $snips_end_with_query   = $_[0] =~ m/\Q$snip\E$/;
-        if ( $self->{as_sentences} ) {
-            $snips_start_with_query = 1;
-            $snips_end_with_query   = $snip =~ m/[\.\?\!]\s*$/;
-        }
-
-        # if we are pulling out something less than the entire
-        # text, insert ellipses...
-        if ( $_[0] ne $snip ) {
-            $self->debug and warn "extract is smaller than snip";
-            my $extract = join( '',
-                ( $snips_start_with_query ? '' : $ellip ),
-                $snip, ( $snips_end_with_query ? '' : $ellip ) );
-            return $extract;
-        }
-        else {
-            return $snip;
-        }
+        return $self->_join_snips( $text, \@snips );
     }
     else {
 
         #warn "no spans. using dumb snip";
-        return $self->_dumb( $_[0] );
+        return $self->_dumb($text);
     }
 
 }
 
+# the best of the span strings in $snips, joined, as the snip of $text.
+sub _join_snips {
+    my ( $self, $text, $snips ) = @_;
+    my @snips       = @$snips;
+    my $occur_index = $self->occur - 1;
+    if ( $#snips > $occur_index ) {
+        @snips = @snips[ 0 .. $occur_index ];
+    }
+    my $snip                   = join( $ellip, @snips );
+    my $snips_start_with_query = $text =~ m/^\Q$snip\E/;
+    my $snips_end_with_query   = $text =~ m/\Q$snip\E$/;
+    if ( $self->{as_sentences} ) {
+        $snips_start_with_query = 1;
+        $snips_end_with_query   = $snip =~ m/[\.\?\!]\s*$/;
+    }
+
+    # if we are pulling out something less than the entire
+    # text, insert ellipses...
+    if ( $text ne $snip ) {
+        $self->debug and warn "extract is smaller than snip";
+        my $extract = join( '',
+            ( $snips_start_with_query ? '' : $ellip ),
+            $snip, ( $snips_end_with_query ? '' : $ellip ) );
+        return $extract;
+    }
+    else {
+        return $snip;
+    }
+}
+
 sub _get_offsets {
-    my $self = shift;
-    return $self->{_tokenizer}->get_offsets( @_, $self->{_qre} );
+    my ( $self, $text, $max_hits ) = @_;
+    my $compiled = $self->{_compiled};
+    return $self->{_tokenizer}->get_offsets(
+        $text, $self->{_qre},
+        $max_hits || $self->max_offsets || 0,
+        0, $compiled->literals, $compiled->max_match_bytes
+    );
 }
 
 sub _offset {
     my $self    = shift;
     my $txt     = shift;
     my $offsets = $self->_get_offsets($txt);
-    my $snips   = $self->_get_offset_snips( $txt, $offsets );
-    return $self->_token( join( '', @$snips ) );
+    if ( $self->{use_pp} ) {
+        my $snips = $self->_get_offset_snips( $txt, $offsets );
+        return $self->_token( join( '', @$snips ) );
+    }
+
+    return $self->_dumb('') if $self->_offset_misses( $txt, $offsets );
+
+    # tokenize just the windows around the offsets, in place.
+    my $tokens = $self->{_tokenizer}->tokenize_windows( $txt, $offsets,
+        $self->max_chars * 10,
+        $self->{_compiled}->heat_seeker );
+    return $self->_heat_snip( $txt, $tokens );
+}
+
+# as with _get_offset_snips(), a text as long as the window
+# with no offsets has nothing to snip.
+sub _offset_misses {
+    my ( $self, $txt, $offsets ) = @_;
+    return !@$offsets && $self->max_chars * 10 <= length $txt;
 }
 
 sub _get_offset_snips {
@@ -366,7 +509,7 @@ sub _loop {
     my $debug = $self->debug || 0;
 
     # no matches
-    return $self->_dumb($txt) unless $txt =~ m/$regexp/;
+    return $self->_dumb($txt) unless @{ $self->_get_offsets( $txt, 1 ) };
 
     #carp "loop snip: $txt";
 
@@ -881,7 +1024,8 @@ Available via new().
 
 Boolean flag indicating whether snip() should attempt to remove any
 HTML/XML markup in the original text before snipping is applied. Default 
-is 0 (false).
+is 0 (false). Unless use_pp() is set, decoding the text, stripping
+markup and collapsing whitespace are all done in one pass in C.
 
 Available via new().
 
@@ -920,7 +1064,8 @@ See also the B<use_pp> feature.
 
 =item offset (default)
 
-Same as C<re> but optimized slightly to look at a substr of text.
+Same as C<token> but only tokenizes the text in windows around the
+matches of the query regex. See Tokenizer tokenize_windows().
 
 =item re
 
@@ -954,11 +1099,24 @@ the nobreak space (C<\xa0>). Default is 1 (true).
 
 Available via new().
 
+=head2 max_offsets( I<n> )
+
+The most query matches the C<offset> snipper looks for. Once it has
+found I<n>, the rest of the text is not searched, so only the windows
+around the first I<n> matches are snipped. Setting a few times occur()
+can speed up snipping long documents full of matches a great deal, at
+the cost of never seeing a better snip later in the text. Default is
+no limit.
+
+Available via new().
+
 =head2 use_pp( I<n> )
 
 Set to a true value to use Tokenizer->tokenize_pp() and TokenListPP
 and TokenPP instead of the XS versions of the same. XS is the default
-and is much faster, but harder to modify or subclass.
+and is much faster, but harder to modify or subclass. Also strips
+markup with Search::Tools::XML no_html() and collapses whitespace
+with regular expressions.
 
 Available via new().
 
@@ -983,6 +1141,26 @@ I<query> plus context() words of context. Matches are case insensitive.
 The snippet returned will be in UTF-8 encoding, regardless of the encoding
 of I<text>.
 
+=head2 snip_batch( I<texts> )
+
+Like calling snip() on each string in the array ref I<texts>, and
+returns an array ref of the snippets in the same order. When the
+C<token> or C<offset> type would be used, the tokenizing and heat
+ranking for the whole batch happen in C, outside the Perl interpreter,
+spread across threads() workers. Other types (and the pure-Perl,
+stemmer and custom snipper() cases) fall back to calling snip()
+on each text.
+
+ my $snips = $snipper->snip_batch( [ map { $_->{body} } @results ] );
+
+=head2 threads
+
+The number of threads snip_batch() may use, including the calling
+thread. The default is 1. Has no effect unless the XS was built with
+pthread support.
+
+Available via new().
+
 =head1 AUTHOR
 
 Peter Karman C<< <karman at cpan dot org> >>
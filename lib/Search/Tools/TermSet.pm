@@ -0,0 +1,105 @@
+package Search::Tools::TermSet;
+use strict;
+use warnings;
+use Search::Tools;    # XS required
+
+our $VERSION = '1.007';
+
+sub CLONE_SKIP {1}
+
+1;
+
+__END__
+
+=head1 NAME
+
+Search::Tools::TermSet - compiled set of query terms for fast token checks
+
+=head1 SYNOPSIS
+
+ use Search::Tools::TermSet;
+ use Search::Tools::Tokenizer;
+ my $terms = Search::Tools::TermSet->new( [qw( quick brown* )] );
+ if ( $terms->contains('Browning') ) {
+     # case-insensitive, wildcard aware
+ }
+ 
+ # use as a heat_seeker
+ my $tokenizer = Search::Tools::Tokenizer->new();
+ my $tokens = $tokenizer->tokenize( 'the quick brown dog', $terms );
+
+=head1 DESCRIPTION
+
+A TermSet is a C-side set of case-folded words, built once from a list
+of query terms. Phrases are split into their words. Words containing
+the wildcard character are kept as simple patterns where the wildcard
+matches any run of characters.
+
+Passing a TermSet as the I<heat_seeker> to Tokenizer tokenize() tests
+each token with a hash lookup instead of running a regex against it.
+
+=head1 METHODS
+
+Search::Tools::TermSet is written in C/XS. Look at the source for
+Tools.xs and search-tools.c if you are interested in the internals.
+
+=head2 new( I<terms> [, I<wildcard>] )
+
+Returns a new TermSet. I<terms> is an array ref of strings.
+I<wildcard> is a single character and defaults to C<*>.
+
+=head2 contains( I<string> )
+
+Returns true if I<string> case-insensitively matches one of the words
+in the set.
+
+=head2 num_terms
+
+Returns the number of unique words in the set.
+
+=head1 AUTHOR
+
+Peter Karman C<< <karman@cpan.org> >>
+
+=head1 BUGS
+
+Please report any bugs or feature requests to C<bug-search-tools at rt.cpan.org>, or through
+the web interface at L<http://rt.cpan.org/NoAuth/ReportBug.html?Queue=Search-Tools>.  
+I will be notified, and then you'll
+automatically be notified of progress on your bug as I make changes.
+
+=head1 SUPPORT
+
+You can find documentation for this module with the perldoc command.
+
+    perldoc Search::Tools
+
+
+You can also look for information at:
+
+=over 4
+
+=item * RT: CPAN's request tracker
+
+L<http://rt.cpan.org/NoAuth/Bugs.html?Dist=Search-Tools>
+
+=item * AnnoCPAN: Annotated CPAN documentation
+
+L<http://annocpan.org/dist/Search-Tools>
+
+=item * CPAN Ratings
+
+L<http://cpanratings.perl.org/d/Search-Tools>
+
+=item * Search CPAN
+
+L<http://search.cpan.org/dist/Search-Tools/>
+
+=back
+
+=head1 COPYRIGHT
+
+Copyright 2009 by Peter Karman.
+
+This package is free software; you can redistribute it and/or modify it under the 
+same terms as Perl itself.
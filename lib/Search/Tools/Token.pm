@@ -9,6 +9,8 @@ use Search::Tools;    # XS required
 
 our $VERSION = '1.007';
 
+sub CLONE_SKIP {1}
+
 1;
 
 __END__
@@ -13,6 +13,8 @@ use namespace::autoclean;
 
 our $VERSION = '1.007';
 
+sub CLONE_SKIP {1}
+
 1;
 
 __END__
@@ -120,6 +122,11 @@ value as len() unless you alter the TokenList via as_array().
 Returns an array ref to the internal AV (array) of tokens. If you alter
 the array, it will alter the len() value but not the num() value.
 
+Token objects are created lazily, the first time next(), prev(),
+get_token(), matches() or as_array() asks for them. Since as_array()
+must create every Token, prefer get_token() for sparse access to
+large TokenLists.
+
 =head2 dump
 
 Prints internal XS attributes to stderr.
@@ -136,6 +143,21 @@ See Search::Tools::Tokenizer.
 Returns an array ref to the internal AV (array) of sentence start
 positions for each position in get_heat().
 
+Both get_heat() and get_sentence_starts() build a new array on each
+call, from native integer arrays kept by the TokenList.
+
+=head2 get_heat_packed
+
+=head2 get_sentence_starts_packed
+
+Like get_heat() and get_sentence_starts() but return the native
+arrays as a single string of 32-bit integers, without creating a
+scalar per position:
+
+ my @heat = unpack( 'l*', $tokens->get_heat_packed );
+
+The number of hot tokens is C<length($packed) / 4>.
+
 =head2 matches
 
 Returns an array ref of all the Tokens with is_match() set. The
@@ -149,11 +171,22 @@ Like calling:
 
  my $num = scalar @{ $tokens->matches };
 
+but counts the Tokenizer's match flags directly, without creating
+any Token objects. Tokens pushed onto as_array() are included; a
+Token I<replaced> in the as_array() array is not seen by either
+method.
+
 =head2 get_token( I<position> )
 
 Returns the Token at I<position>. If I<position> is invalid returns
 undef.
 
+=head2 heat_spans( I<window_size>, I<as_sentences> )
+
+Used internally by Search::Tools::HeatMap. Returns a two-item list:
+an array ref of span hash refs, ranked best first, and a hash ref
+of the positions used in those spans. See Search::Tools::HeatMap.
+
 =head1 AUTHOR
 
 Peter Karman C<< <karman@cpan.org> >>
@@ -21,6 +21,10 @@ sub get_heat {
     return $_[0]->{heat};
 }
 
+sub get_heat_packed {
+    return pack( 'l*', @{ $_[0]->{heat} } );
+}
+
 sub next {
     my $self   = shift;
     my $tokens = $self->{tokens};
@@ -195,6 +199,11 @@ is_hot() set by the original Tokenizer. This method will return an
 empty list unless you have passed a heat_seeker to the tokenize_pp() method.
 See Search::Tools::Tokenizer.
 
+=head2 get_heat_packed
+
+Returns get_heat() as a string of 32-bit integers, like
+Search::Tools::TokenList get_heat_packed().
+
 =head2 matches
 
 Returns an array ref of all the Tokens with is_match() set. The
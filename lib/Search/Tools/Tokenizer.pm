@@ -5,11 +5,15 @@ use Search::Tools;    # XS package required
 use Search::Tools::Token;
 use Search::Tools::TokenList;
 use Search::Tools::UTF8;
+use Search::Tools::TermSet;
+use Search::Tools::TokenStream;
+use Scalar::Util qw( blessed );
 use Carp;
 
 our $VERSION = '1.007';
 
 has 're' => ( is => 'rw', default => sub {qr/\w+(?:[\'\-\.]\w+)*/} );
+has 'lang' => ( is => 'rw', default => sub {'en'} );
 
 sub BUILD {
     my $self = shift;
@@ -19,6 +23,27 @@ sub BUILD {
     return $self;
 }
 
+sub tokenize_fh {
+    my $self     = shift;
+    my $fh       = shift or croak "filehandle required";
+    my $callback = shift;
+    if ( !$callback or ref($callback) ne 'CODE' ) {
+        croak "callback CODE reference required";
+    }
+    my $stream     = $self->stream(@_);
+    my $chunk_size = 65536;
+    while (1) {
+        my $n = read( $fh, my $buf, $chunk_size );
+        croak "read failed: $!" unless defined $n;
+        my $tokens = $n ? $stream->push($buf) : $stream->finish;
+        while ( my $tok = $tokens->next ) {
+            $callback->($tok);
+        }
+        last unless $n;
+    }
+    return $stream->num_tokens;
+}
+
 sub tokenize_pp {
     require Search::Tools::TokenPP;
     require Search::Tools::TokenListPP;
@@ -43,6 +68,9 @@ sub tokenize_pp {
     my $re     = $self->{re};
     my $heat_seeker_is_coderef
         = ( defined $heat_seeker and ref($heat_seeker) eq 'CODE' ) ? 1 : 0;
+    my $heat_seeker_is_termset
+        = ( blessed($heat_seeker)
+            and $heat_seeker->isa('Search::Tools::TermSet') ) ? 1 : 0;
 
     # TODO is_sentence_* logic
     for ( split( m/($re)/, $_[0] ) ) {
@@ -62,6 +90,9 @@ sub tokenize_pp {
             if ($heat_seeker_is_coderef) {
                 $heat_seeker->($tok);
             }
+            elsif ($heat_seeker_is_termset) {
+                $tok->{is_hot} = $heat_seeker->contains($_) ? 1 : 0;
+            }
             elsif ( defined $heat_seeker ) {
                 $tok->{is_hot} = $_ =~ m/$heat_seeker/;
             }
@@ -129,17 +160,47 @@ Called by new().
 Get/set the I<regex> used by tokenize() tokenize_pp(). Typically
 you set this once in new(). The default value is:
 
- qr/\w+(?:'\w+)*/
+ qr/\w+(?:[\'\-\.]\w+)*/
+
+which will match words, contractions and hyphenated or dotted words
+(e.g., "do", "don't", "e-mail" and "U.S.A").
 
-which will match words and contractions (e.g., "do", "not" and "don't").
+tokenize() recognizes the default value and matches it with a dedicated
+C scanner instead of the Perl regex engine, which is considerably faster.
+Any other I<regex> (or a non-zero I<match_num>) uses the regex engine.
+
+=head2 lang([ I<lang> ])
+
+Get/set the language whose abbreviations tokenize() and stream() use
+to decide whether a token such as C<Dr> or C<z.B> is an
+abbreviation, so that its period does not end a sentence. The default
+is C<en>. Sets for C<en>, C<de>, C<fr> and C<es> are built in. A
+locale such as C<de_DE> uses its language's set, and a language with
+no set falls back to C<en>.
+
+=head2 add_abbreviations( I<lang>, I<words> )
+
+Class method. Adds the array ref of I<words> to the abbreviations
+for I<lang>, creating the set if I<lang> is new, and returns the
+number of words in the set. A trailing period on a word is ignored
+and matching is case insensitive.
+
+ Search::Tools::Tokenizer->add_abbreviations( it => [qw( sig sigg dott )] );
+ my $tokenizer = Search::Tools::Tokenizer->new( lang => 'it' );
+
+Each set is compiled once into a sorted C table shared by every
+Tokenizer in the process. Call add_abbreviations() at startup,
+before creating threads.
 
 =head2 tokenize( I<string> [, I<heat_seeker>, I<match_num>] )
 
 Returns a TokenList object representin the Tokens in I<string>.
 I<string> is "split" according to the regex in re().
 
-I<heat_seeker> can be either a CODE reference or a regex object (qr//)
-to use for testing is_hot per token. An example CODE reference:
+I<heat_seeker> can be a CODE reference, a regex object (qr//)
+or a Search::Tools::TermSet to use for testing is_hot per token.
+A TermSet is fastest, since it checks each token with a hash lookup
+instead of the regex engine. An example CODE reference:
 
  my $tokens = $tokenizer->tokenize('foo bar', sub { 
     my ($token) = @_;
@@ -149,6 +210,47 @@ to use for testing is_hot per token. An example CODE reference:
 I<match_num> is the parentheses number to consider the matching token
 in the re() value. The default is 0 (the entire matching pattern).
 
+=head2 tokenize_batch( I<docs> [, I<heat_seeker>, I<match_num>] )
+
+Like calling tokenize() on each string in the array ref I<docs>, but
+in a single call, looking up re(), lang() and I<heat_seeker> only once.
+Returns an array ref of TokenList objects in the same order as I<docs>.
+Useful when tokenizing many short documents, such as a page of search
+results.
+
+ my $lists = $tokenizer->tokenize_batch( \@docs, $termset );
+
+=head2 tokenize_windows( I<string>, I<offsets>, I<size> [, I<heat_seeker>, I<match_num>] )
+
+Like tokenize(), but only for the bytes of I<string> within
+I<size> / 2 of each byte offset in the array ref I<offsets>, as
+returned by get_offsets(). Overlapping windows are merged, and each
+window starts a new sentence. The TokenList shares I<string>'s
+buffer rather than a copy of the windows, so no substrings are made.
+If I<size> is as big as I<string>, all of it is tokenized.
+Used by Search::Tools::Snipper for the C<offset> snipper.
+
+ my $offsets = $tokenizer->get_offsets( $text, $regex );
+ my $tokens  = $tokenizer->tokenize_windows( $text, $offsets, 3000 );
+
+=head2 stream([ I<heat_seeker>, I<match_num> ])
+
+Returns a Search::Tools::TokenStream for tokenizing a document in
+chunks, for documents too large to hold in memory at once. The
+arguments are the same as the ones tokenize() takes after I<string>.
+
+=head2 tokenize_fh( I<filehandle>, I<callback> [, I<heat_seeker>, I<match_num>] )
+
+Reads I<filehandle> in 64KB chunks through a stream() and calls
+the CODE reference I<callback> with each Token in order. Memory use
+stays constant regardless of the size of the file. Returns the number
+of tokens seen.
+
+ $tokenizer->tokenize_fh( $fh, sub {
+     my ($token) = @_;
+     print "$token\n" if $token->is_hot;
+ }, qr/^foo$/ );
+
 =head2 tokenize_pp( I<string> )
 
 Returns a TokenListPP object.
@@ -158,10 +260,35 @@ see what the XS algorithm does, if you are so inclined, and so the author
 could benchmark the two implementations and thereby feel some satisfaction 
 at having spent the time writing the XS/C version (2-3x faster than Perl).
 
-=head2 get_offsets( I<string>, I<regex> )
+=head2 snip_spans_batch( I<docs>, I<heat_seeker>, I<window>, I<as_sentences>, I<max_spans>, I<threads> [, I<offsets>, I<size>] )
+
+Used by Search::Tools::Snipper->snip_batch(). For each string in the
+array ref I<docs>, tokenizes and ranks the hot spans of I<window>
+tokens around matches of the TermSet I<heat_seeker>, the same way
+get_heat() would, and returns an array ref with one entry per doc:
+either undef (no heat) or an array ref of up to I<max_spans> span
+strings (0 means all). The work is done without the Perl interpreter,
+on up to I<threads> threads, so re() must be one the C scanner
+recognizes and I<heat_seeker> must be a Search::Tools::TermSet.
+
+If the array ref I<offsets> holds an array ref of offsets for a doc,
+only the windows around them are tokenized, as tokenize_windows()
+does with I<size>.
+
+=head2 get_offsets( I<string>, I<regex> [, I<max_hits>, I<max_bytes>, I<literals>, I<max_len>] )
 
 Returns an array ref of pos() values for start offsets of I<regex> within
-I<string>
+I<string>, in bytes. Stops after I<max_hits> matches, and only
+looks for matches within the first I<max_bytes> of I<string>, if
+either is given and not 0.
+
+I<literals> is an optional array ref of strings one of which,
+ignoring ASCII case, starts every match of I<regex>, and I<max_len>
+the most bytes a match can span (0 if unknown). I<regex> is then run
+only where one of the I<literals> occurs, which is much faster for
+a long I<string> with few matches. Pass the literals() and
+max_match_bytes() of a Search::Tools::CompiledQuery along with its
+regex().
 
 =head2 set_debug( I<n> )
 
@@ -14,8 +14,10 @@ our @EXPORT = qw(
     is_perl_utf8_string
     is_ascii
     is_latin1
+    classify_buffer
     is_sane_utf8
     find_bad_utf8
+    find_bad_utf8_offset
     find_bad_ascii
     find_bad_latin1
     find_bad_latin1_report
@@ -40,12 +42,13 @@ sub to_utf8 {
         $Debug and carp "string '$str' is flagged utf8 already";
         return $str;
     }
-    if ( is_ascii($str) ) {
+    my ( $ascii, $latin1, $utf8 ) = classify_buffer($str);
+    if ($ascii) {
         Encode::_utf8_on($str);
         $Debug and carp "string '$str' is ascii; utf8 flag turned on";
         return $str;
     }
-    if ( is_valid_utf8($str) ) {
+    if ($utf8) {
 
         # we got here only because the flag was off and it wasn't ascii.
         # however, is_valid_utf8() claims that it is valid internal UTF8,
@@ -119,13 +122,7 @@ sub is_sane_utf8 {
 }
 
 sub is_valid_utf8 {
-    if (   is_latin1( $_[0] )
-        && !is_ascii( $_[0] )
-        && !is_perl_utf8_string( $_[0] ) )
-    {
-        return 0;
-    }
-    return is_perl_utf8_string( $_[0] );
+    return find_bad_utf8_offset( $_[0] ) < 0 ? 1 : 0;
 }
 
 sub find_bad_latin1_report {
@@ -267,14 +264,26 @@ though the string doesn't represent the same Unicode codepoint(s). Example:
 Thus is_latin1() (and likewise find_bad_latin1()) are not foolproof. Use them
 in combination with is_flagged_utf8() to get a better test.
 
+=head2 classify_buffer( I<text> )
+
+Returns a list of three booleans describing the bytes of I<text>:
+whether it is ASCII, Latin1 (as is_latin1()) and valid UTF-8
+(as is_perl_utf8_string()). All three are computed in a single pass
+over I<text>, which is cheaper than calling the tests one at a time.
+
+ my ( $is_ascii, $is_latin1, $is_utf8 ) = classify_buffer($str);
+
+is_ascii(), is_latin1(), find_bad_ascii(), find_bad_latin1() and
+classify_buffer() use SSE2/AVX2 instructions where the CPU supports them.
+
 =head2 is_flagged_utf8( I<text> )
 
 Returns true if Perl thinks I<text> is UTF-8. Same as Encode::is_utf8().
 
 =head2 is_perl_utf8_string( I<text> )
 
-Wrapper around the native Perl is_utf8_string() function. Called
-by is_valid_utf8().
+Wrapper around the native Perl is_utf8_string() function.
+is_valid_utf8() gives the same answer without calling it.
 
 =head2 is_sane_utf8( I<text> [,I<warnings>] )
 
@@ -295,6 +304,12 @@ is not valid UTF-8, so use it like:
     
 If I<text> is a valid UTF-8 string, returns undef.
 
+=head2 find_bad_utf8_offset( I<text> )
+
+Returns the byte offset of the first malformed UTF-8 sequence in I<text>,
+or -1 if I<text> is valid UTF-8. is_valid_utf8() and find_bad_utf8() are
+built on the same single-pass validator.
+
 =head2 find_bad_ascii( I<text> )
 
 Returns position of first non-ASCII byte or -1 if I<text> is all ASCII.
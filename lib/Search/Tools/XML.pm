@@ -61,6 +61,8 @@ This affects things like the unescape* methods.
 =head2 %HTML_ents
 
 Complete map of all named HTML entities to their decimal values.
+The unescape() methods use a copy compiled into the XS, so changes
+to %HTML_ents do not affect them.
 
 =cut
 
@@ -608,7 +610,12 @@ Similar to unescape() functions in more famous CPAN modules, but without the add
 dependency. unescape() will convert all entities to their chr() equivalents.
 
 B<NOTE:> unescape() does more than reverse the effects of escape(). It attempts
-to resolve B<all> entities, not just the special XML entities (><'"&).
+to resolve B<all> entities, not just the special XML entities (><'"&):
+named ones in %HTML_ents, and decimal and hex ones, in a single pass
+in C. Each entity is decoded once, so C<&amp;lt;> becomes C<&lt;>,
+except that an escaped numeric entity like C<&amp;#60;> becomes C<E<lt>>
+as it always has. Numeric entities for NUL, surrogates or code points
+past U+10FFFF are left as they are.
 
 B<IMPORTANT:> The API for this method has changed as of version 0.16.
 I<text> is no longer modified in-place.
@@ -617,9 +624,8 @@ I<text> is no longer modified in-place.
 
 sub unescape {
     my $text = pop;
-    $text = unescape_named($text);
-    $text = unescape_decimal($text);
-    return $text;
+    return $text unless defined $text;
+    return _unescape( $text, 1, 1, 1 );
 }
 
 =head2 unescape_named( I<text> )
@@ -632,20 +638,8 @@ Returns modified copy of I<text>.
 
 sub unescape_named {
     my $t = pop;
-    if ( defined($t) ) {
-
-        # named entities - check first to see if it is worth looping
-        if ( $t =~ m/&[a-zA-Z0-9]+;/ ) {
-            for my $e ( keys %HTML_ents ) {
-                my $dec = $HTML_ents{$e};
-                if ( my $n = $t =~ s/&$e;/chr($dec)/eg ) {
-
-                #warn "replaced $e ($dec) -> $HTML_ents{$e} $n times in text";
-                }
-            }
-        }
-    }
-    return $t;
+    return $t unless defined $t;
+    return _unescape( $t, 1, 0, 0 );
 }
 
 =head2 unescape_decimal( I<text> )
@@ -658,10 +652,8 @@ Returns modified copy of I<text>.
 
 sub unescape_decimal {
     my $t = pop;
-
-    # resolve numeric entities as best we can
-    $t =~ s/&#(\d+);/chr($1)/ego if defined($t);
-    return $t;
+    return $t unless defined $t;
+    return _unescape( $t, 0, 1, 0 );
 }
 
 =head2 perl_to_xml( I<ref> [, I<options>] )
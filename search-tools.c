@@ -11,62 +11,13 @@
 #include <wctype.h>
 #include "search-tools.h"
 
-/* global vars */
-static HV* ST_ABBREVS = NULL;
-
-/* perl versions < 5.8.8 do not have this */
-#ifndef is_utf8_string_loclen
-bool
-is_utf8_string_loclen(const U8 *s, STRLEN len, const U8 **ep, STRLEN *el)
-{
-    dTHX;
-    const U8* x = s;
-    const U8* send;
-    STRLEN c;
-
-    if (!len)
-        len = strlen((const char *)s);
-    send = s + len;
-    if (el)
-        *el = 0;
-
-    while (x < send) {
-         /* Inline the easy bits of is_utf8_char() here for speed... */
-         if (UTF8_IS_INVARIANT(*x))
-             c = 1;
-         else if (!UTF8_IS_START(*x))
-             goto out;
-         else {
-             /* ... and call is_utf8_char() only if really needed. */
-#ifdef IS_UTF8_CHAR
-             c = UTF8SKIP(x);
-             if (IS_UTF8_CHAR_FAST(c)) {
-                 if (!IS_UTF8_CHAR(x, c))
-                     c = 0;
-             } else
-                 c = is_utf8_char_slow(x, c);
-#else
-             c = is_utf8_char(x);
-#endif /* #ifdef IS_UTF8_CHAR */
-             if (!c)
-                 goto out;
-         }
-         x += c;
-         if (el)
-             (*el)++;
-    }
-
- out:
-    if (ep)
-        *ep = x;
-    if (x != send)
-        return FALSE;
-
-    return TRUE;
-}
-
+#if defined(__SSE2__)
+#include <emmintrin.h>
 #endif
- 
+#if ST_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
 
 static SV*
 st_hv_store( HV* h, const char* key, SV* val) {
@@ -89,6 +40,7 @@ st_hv_store_char( HV* h, const char *key, char *val) {
     return value;
 }
 
+/* UNUSED
 static SV*      
 st_hv_store_int( HV* h, const char* key, int i) {
     dTHX;
@@ -98,6 +50,7 @@ st_hv_store_int( HV* h, const char* key, int i) {
     SvREFCNT_dec(value);
     return value;
 }
+*/
 
 /* UNUSED
 static SV*
@@ -132,6 +85,7 @@ st_av_fetch( AV* a, I32 index ) {
     return *ok;
 }
 
+/* UNUSED
 static void * 
 st_av_fetch_ptr( AV* a, I32 index ) {
     dTHX;
@@ -145,6 +99,7 @@ st_av_fetch_ptr( AV* a, I32 index ) {
     //warn("%s refcnt == %d", SvPV_nolen(*ok), SvREFCNT(*ok));
     return ptr;
 }
+*/
 
 /* fetch SV* from hash */
 static SV*
@@ -195,108 +150,411 @@ st_hvref_fetch_as_int( SV* h, const char* key ) {
 }
 */
 
+/* the st_snip_batch() worker running on this thread, if any */
+#ifdef ST_HAVE_PTHREAD
+static pthread_key_t    st_snip_worker_key;
+static pthread_once_t   st_snip_worker_once = PTHREAD_ONCE_INIT;
+
+static void
+st_snip_worker_make_key() {
+    pthread_key_create(&st_snip_worker_key, NULL);
+}
+
+static void
+st_set_snip_worker( st_snip_worker *worker ) {
+    pthread_once(&st_snip_worker_once, st_snip_worker_make_key);
+    pthread_setspecific(st_snip_worker_key, worker);
+}
+
+static st_snip_worker*
+st_get_snip_worker() {
+    pthread_once(&st_snip_worker_once, st_snip_worker_make_key);
+    return (st_snip_worker*)pthread_getspecific(st_snip_worker_key);
+}
+#else
+static st_snip_worker *ST_SNIP_WORKER = NULL;
+
+static void
+st_set_snip_worker( st_snip_worker *worker ) {
+    ST_SNIP_WORKER = worker;
+}
+
+static st_snip_worker*
+st_get_snip_worker() {
+    return ST_SNIP_WORKER;
+}
+#endif
+
+/*
+    A worker can't croak, so it hands the failure to its pool and
+    jumps back out of st_snip_batch_work(). st_snip_batch() croaks 
+    once the workers are done.
+*/
+static void
+st_out_of_memory( const char *what, size_t size ) {
+    st_snip_worker *worker = st_get_snip_worker();
+    
+    if (worker != NULL) {
+        st_snip_pool *pool = worker->pool;
+#ifdef ST_HAVE_PTHREAD
+        pthread_mutex_lock(&pool->lock);
+#endif
+        if (!pool->failed_size) {
+            pool->failed_size = size;
+        }
+        pool->next = pool->num_jobs;
+#ifdef ST_HAVE_PTHREAD
+        pthread_mutex_unlock(&pool->lock);
+#endif
+        longjmp(worker->env, 1);
+    }
+    ST_CROAK("Out of memory! Can't %s %lu bytes", what, (unsigned long)size);
+}
+
 void *
 st_malloc(size_t size) {
-    dTHX;
     void *ptr;
     ptr = malloc(size);
     if (ptr == NULL) {
-        ST_CROAK("Out of memory! Can't malloc %lu bytes",
-                    (unsigned long)size);
+        st_out_of_memory("malloc", size);
+    }
+    return ptr;
+}
+
+static void*
+st_realloc(void *ptr, size_t size) {
+    ptr = realloc(ptr, size);
+    if (ptr == NULL) {
+        st_out_of_memory("realloc", size);
     }
     return ptr;
 }
 
 
-static st_token*    
+static I32    
 st_new_token(
-    I32 pos, 
+    st_token_list *tl,
     I32 len,
     I32 u8len,
     const char *ptr,
-    I32 is_hot,
-    boolean is_match
+    I32 is_hot
 ) {
-    dTHX;
-    st_token *tok;
+    I32 idx;
     
     if (!len) {
         ST_CROAK("cannot create token with zero length: '%s'", ptr);
     }
     
-    tok = st_malloc(sizeof(st_token));
-    tok->pos = pos;
-    tok->len = len;
-    tok->u8len = u8len;
-    tok->is_hot = is_hot;
-    tok->is_match = is_match;
-    tok->is_sentence_start = 0;
-    tok->is_sentence_end = 0;
-    tok->is_abbreviation = 0;
-    tok->str = newSVpvn(ptr, len); /* newSVpvn_utf8 not available in some perls? */
-    SvUTF8_on(tok->str);
-    tok->ref_cnt = 1;
-    return tok;
+    if (tl->num == tl->max) {
+        st_token_list_grow(tl);
+    }
+    idx = tl->num++;
+    tl->offset[idx] = ptr - SvPVX(tl->buf);
+    tl->len[idx]    = len;
+    tl->u8len[idx]  = u8len;
+    tl->hot[idx]    = is_hot;
+    return idx;
+}
+
+/* tokens point into the list buffer rather than holding their own copy */
+static const char*
+st_token_list_ptr(st_token_list *tl, I32 idx) {
+    return SvPVX(tl->buf) + tl->offset[idx];
+}
+
+/* build an SV for the token string, only when someone asks for it */
+static SV*
+st_token_list_str(st_token_list *tl, I32 idx) {
+    dTHX;
+    SV *str;
+    str = newSVpvn(st_token_list_ptr(tl, idx), tl->len[idx]); /* newSVpvn_utf8 not available in some perls? */
+    SvUTF8_on(str);
+    return str;
+}
+
+static SV*
+st_token_str(st_token *tok) {
+    return st_token_list_str(tok->list, tok->pos);
 }
 
 static st_token_list*
-st_new_token_list(
-    AV *tokens,
-    AV *heat,
-    AV *sentence_starts,
-    unsigned int num
-) {
+st_new_token_list() {
     dTHX;
     st_token_list *tl;
     tl = st_malloc(sizeof(st_token_list));
     tl->pos = 0;
-    tl->tokens = tokens;
-    tl->heat   = heat;
-    tl->sentence_starts = sentence_starts;
-    tl->num = (IV)num;
+    tl->tokens = newAV();
+    tl->buf = NULL;
+    tl->offset = NULL;
+    tl->len    = NULL;
+    tl->u8len  = NULL;
+    tl->hot    = NULL;
+    Zero(tl->bits, ST_TOKEN_NUM_FLAGS, U64*);
+    tl->heat   = NULL;
+    tl->sentence_starts = NULL;
+    tl->num_hot = 0;
+    tl->max_hot = 0;
+    tl->max = 0;
+    tl->handles = NULL;
+    tl->num_blocks = 0;
+    tl->num = 0;
     tl->ref_cnt = 1;
     return tl;
 }
 
+/* max is always a multiple of 64, so the bitsets are max/64 words */
+static void
+st_token_list_grow(st_token_list *tl) {
+    I32 old_words, words, f;
+    
+    old_words  = tl->max >> 6;
+    tl->max    = tl->max ? tl->max * 2 : 256;
+    words      = tl->max >> 6;
+    tl->offset = st_realloc(tl->offset, sizeof(I32) * tl->max);
+    tl->len    = st_realloc(tl->len,    sizeof(I32) * tl->max);
+    tl->u8len  = st_realloc(tl->u8len,  sizeof(I32) * tl->max);
+    tl->hot    = st_realloc(tl->hot,    sizeof(I32) * tl->max);
+    for (f = 0; f < ST_TOKEN_NUM_FLAGS; f++) {
+        tl->bits[f] = st_realloc(tl->bits[f], sizeof(U64) * words);
+        Zero(tl->bits[f] + old_words, words - old_words, U64);
+    }
+}
+
+static int
+st_popcount64(U64 x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* x must not be 0 */
+static int
+st_ctz64(U64 x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* number of bits set in positions [0, end) */
+static IV
+st_bits_count(const U64 *bits, I32 end) {
+    IV n = 0;
+    I32 i, words;
+    
+    words = end >> 6;
+    for (i = 0; i < words; i++) {
+        n += st_popcount64(bits[i]);
+    }
+    if (end & 63) {
+        n += st_popcount64(bits[words] & (((U64)1 << (end & 63)) - 1));
+    }
+    return n;
+}
+
+/* first set bit in [from, end), or end if there is none */
+static I32
+st_bits_next(const U64 *bits, I32 from, I32 end) {
+    I32 i;
+    U64 w;
+    
+    if (from >= end) {
+        return end;
+    }
+    i = from >> 6;
+    w = bits[i] & (~(U64)0 << (from & 63));
+    while (!w) {
+        if ((++i << 6) >= end) {
+            return end;
+        }
+        w = bits[i];
+    }
+    from = (i << 6) + st_ctz64(w);
+    return from < end ? from : end;
+}
+
+/* each blessed Token holds a reference to the list that owns its memory */
+static SV*
+st_token_list_bless_token(st_token_list *tl, I32 idx) {
+    st_token *tok;
+    I32 block, i;
+    
+    block = idx >> ST_TOKEN_BLOCK_SHIFT;
+    if (block >= tl->num_blocks) {
+        i = tl->num_blocks;
+        tl->num_blocks = (tl->max >> ST_TOKEN_BLOCK_SHIFT) + 1;
+        tl->handles = st_realloc(tl->handles, sizeof(st_token*) * tl->num_blocks);
+        while (i < tl->num_blocks) {
+            tl->handles[i++] = NULL;
+        }
+    }
+    if (tl->handles[block] == NULL) {
+        tl->handles[block] = st_malloc(sizeof(st_token) * ST_TOKEN_BLOCK_SIZE);
+    }
+    tok = &tl->handles[block][idx & ST_TOKEN_BLOCK_MASK];
+    tok->list = tl;
+    tok->pos  = idx;
+    tl->ref_cnt++;
+    return st_bless_ptr(ST_CLASS_TOKEN, tok);
+}
+
+static void
+st_token_list_release(st_token_list *tl) {
+    if (--tl->ref_cnt < 1) {
+        st_free_token_list(tl);
+    }
+}
+
+/* the Token object at idx in the tokens AV, if one has been created */
+static st_token*
+st_token_list_token_at(st_token_list *tl, I32 idx) {
+    dTHX;
+    SV **svp;
+    svp = av_fetch(tl->tokens, idx, 0);
+    if (svp != NULL && *svp != NULL && SvROK(*svp)) {
+        return (st_token*)st_extract_ptr(*svp);
+    }
+    return NULL;
+}
+
+/* Token objects are only created when asked for. Slots in the
+ * tokens AV stay empty until then. Returns NULL for bad idx.
+ */
+static SV*
+st_token_list_fetch(st_token_list *tl, I32 idx) {
+    dTHX;
+    SV **svp;
+    SV *tok;
+    
+    if (idx < 0 || idx > av_len(tl->tokens)) {
+        return NULL;
+    }
+    svp = av_fetch(tl->tokens, idx, 0);
+    if (svp != NULL && *svp != NULL) {
+        return *svp;
+    }
+    if (idx >= tl->num) {
+        return NULL;
+    }
+    tok = st_token_list_bless_token(tl, idx);
+    av_store(tl->tokens, idx, tok);
+    return tok;
+}
+
+/* create every missing Token object so the AV can be handed out */
+static AV*
+st_token_list_as_array(st_token_list *tl) {
+    dTHX;
+    I32 i, len;
+    len = av_len(tl->tokens) + 1;
+    for (i = 0; i < len; i++) {
+        st_token_list_fetch(tl, i);
+    }
+    return tl->tokens;
+}
+
+/* the parsed tokens are counted from the match bitset. Tokens pushed
+ * on via as_array() are checked one by one.
+ */
+static IV
+st_token_list_num_matches(st_token_list *tl) {
+    dTHX;
+    IV num_matches = 0;
+    I32 i, len;
+    st_token *tok;
+    
+    len = av_len(tl->tokens) + 1;
+    i   = tl->num < len ? tl->num : len;
+    if (i) {
+        num_matches = st_bits_count(tl->bits[ST_TOKEN_MATCH], i);
+    }
+    for (; i < len; i++) {
+        tok = st_token_list_token_at(tl, i);
+        if (tok != NULL && ST_TOKEN_FLAG(tok->list, tok->pos, ST_TOKEN_MATCH)) {
+            num_matches++;
+        }
+    }
+    return num_matches;
+}
+
 static void
-st_free_token(st_token *tok) {
+st_token_list_add_heat(st_token_list *tl, I32 pos, I32 sentence_start) {
+    if (tl->num_hot == tl->max_hot) {
+        tl->max_hot = tl->max_hot ? tl->max_hot * 2 : 64;
+        tl->heat    = st_realloc(tl->heat, sizeof(I32) * tl->max_hot);
+        tl->sentence_starts = st_realloc(tl->sentence_starts, 
+                                sizeof(I32) * tl->max_hot);
+    }
+    tl->heat[tl->num_hot]            = pos;
+    tl->sentence_starts[tl->num_hot] = sentence_start;
+    tl->num_hot++;
+}
+
+/* new AV of IVs, for get_heat() and get_sentence_starts() */
+static AV*
+st_i32_to_av(const I32 *ints, I32 num) {
     dTHX;
-    if (tok->ref_cnt != 0) {
-        ST_CROAK("Won't free token 0x%x with ref_cnt != 0 [%d]", 
-            tok, tok->ref_cnt);
+    AV *av;
+    I32 i;
+    
+    av = newAV();
+    if (num) {
+        av_extend(av, num - 1);
     }
-    SvREFCNT_dec(tok->str);
-    free(tok);
+    for (i = 0; i < num; i++) {
+        av_push(av, newSViv(ints[i]));
+    }
+    return av;
 }
 
 static void
 st_free_token_list(st_token_list *token_list) {
     dTHX;
+    I32 i;
+
     if (token_list->ref_cnt != 0) {
-        ST_CROAK("Won't free token_list 0x%x with ref_cnt > 0 [%d]", 
+        ST_CROAK("Won't free token_list %p with ref_cnt > 0 [%" IVdf "]", 
             token_list, token_list->ref_cnt);
     }
     
     //warn("about to free st_token_list C struct\n");
     //st_dump_token_list(token_list);
 
-    SvREFCNT_dec(token_list->tokens);
-    if (SvREFCNT(token_list->tokens)) {
-        warn("Warning: possible memory leak for token_list->tokens 0x%lx with REFCNT %d\n", 
-            (unsigned long)token_list->tokens, SvREFCNT(token_list->tokens));
+    /* tokens AV is released by TokenList DESTROY, since the Tokens
+     * in it hold references back to this list.
+     */
+    if (token_list->tokens != NULL) {
+        SvREFCNT_dec(token_list->tokens);
     }
     
-    SvREFCNT_dec(token_list->heat);
-    if (SvREFCNT(token_list->heat)) {
-        warn("Warning: possible memory leak for token_list->heat 0x%lx with REFCNT %d\n", 
-            (unsigned long)token_list->heat, SvREFCNT(token_list->heat));
+    if (token_list->buf != NULL) {
+        SvREFCNT_dec(token_list->buf);
     }
 
-    SvREFCNT_dec(token_list->sentence_starts);
-    if (SvREFCNT(token_list->sentence_starts)) {
-        warn("Warning: possible memory leak for token_list->sentence_starts 0x%lx with REFCNT %d\n", 
-            (unsigned long)token_list->sentence_starts, SvREFCNT(token_list->sentence_starts));
+    free(token_list->offset);
+    free(token_list->len);
+    free(token_list->u8len);
+    free(token_list->hot);
+    free(token_list->heat);
+    free(token_list->sentence_starts);
+    for (i = 0; i < ST_TOKEN_NUM_FLAGS; i++) {
+        free(token_list->bits[i]);
+    }
+    for (i = 0; i < token_list->num_blocks; i++) {
+        free(token_list->handles[i]);
     }
+    free(token_list->handles);
 
     free(token_list);
 }
@@ -305,38 +563,35 @@ static void
 st_dump_token_list(st_token_list *tl) {
     dTHX;
     IV len, pos;
-    SV* tok;
-    len = av_len(tl->tokens);
+    len = tl->tokens == NULL ? -1 : av_len(tl->tokens);
     pos = 0;
     warn("TokenList 0x%lx", (unsigned long)tl);
     warn(" pos = %ld\n", (unsigned long)tl->pos);
     warn(" len = %ld\n", (unsigned long)len + 1);
     warn(" num = %ld\n", (unsigned long)tl->num);
     warn(" ref_cnt = %ld\n", (unsigned long)tl->ref_cnt);
-    warn(" tokens REFCNT = %ld\n", (unsigned long)SvREFCNT(tl->tokens));
-    warn(" heat REFCNT = %ld\n", (unsigned long)SvREFCNT(tl->heat));
-    warn(" sen_starts REFCNT = %ld\n", (unsigned long)SvREFCNT(tl->sentence_starts));
-    while (pos < len) {
-        tok = st_av_fetch(tl->tokens, pos++);
-        warn("  Token REFCNT = %ld\n", (unsigned long)SvREFCNT(tok));
-        st_dump_token((st_token*)st_extract_ptr(tok));
+    if (tl->tokens != NULL)
+        warn(" tokens REFCNT = %ld\n", (unsigned long)SvREFCNT(tl->tokens));
+    warn(" num_hot = %ld\n", (unsigned long)tl->num_hot);
+    while (pos < len && pos < tl->num) {
+        st_dump_token(tl, pos++);
     }
 }
 
 static void
-st_dump_token(st_token *tok) {
+st_dump_token(st_token_list *tl, I32 idx) {
     dTHX;
-    warn("Token 0x%lx", (unsigned long)tok);
-    warn(" str = '%s'\n", SvPV_nolen(tok->str));
-    warn(" pos = %ld\n", (unsigned long)tok->pos);
-    warn(" len = %ld\n", (unsigned long)tok->len);
-    warn(" u8len = %ld\n", (unsigned long)tok->u8len);
-    warn(" is_match = %d\n", tok->is_match);
-    warn(" is_sentence_start = %d\n", tok->is_sentence_start);
-    warn(" is_sentence_end   = %d\n", tok->is_sentence_end);
-    warn(" is_abbreviation   = %d\n", tok->is_abbreviation);
-    warn(" is_hot   = %d\n", tok->is_hot);
-    warn(" ref_cnt  = %ld\n", (unsigned long)tok->ref_cnt);
+    warn("Token %ld of 0x%lx", (long)idx, (unsigned long)tl);
+    warn(" str = '%.*s'\n", (int)tl->len[idx], st_token_list_ptr(tl, idx));
+    warn(" pos = %ld\n", (unsigned long)idx);
+    warn(" offset = %ld\n", (unsigned long)tl->offset[idx]);
+    warn(" len = %ld\n", (unsigned long)tl->len[idx]);
+    warn(" u8len = %ld\n", (unsigned long)tl->u8len[idx]);
+    warn(" is_match = %d\n", ST_TOKEN_FLAG(tl, idx, ST_TOKEN_MATCH));
+    warn(" is_sentence_start = %d\n", ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_START));
+    warn(" is_sentence_end   = %d\n", ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_END));
+    warn(" is_abbreviation   = %d\n", ST_TOKEN_FLAG(tl, idx, ST_TOKEN_ABBREVIATION));
+    warn(" is_hot   = %d\n", (int)tl->hot[idx]);
 }
 
 /* make a Perl blessed object from a C pointer */
@@ -368,8 +623,7 @@ st_croak(
     va_list args;
     va_start(args, msgfmt);
     warn("Search::Tools error at %s:%d %s: ", file, line, func);
-    //warn(msgfmt, args);
-    croak(msgfmt, args);
+    vcroak(msgfmt, &args);
     /* NEVER REACH HERE */
     va_end(args);
 }
@@ -475,15 +729,330 @@ st_is_ascii( SV* str ) {
 
 static boolean
 st_char_is_ascii( unsigned char* str, STRLEN len ) {
-    dTHX;
-    IV i;
+    return st_find_non_ascii(str, len) == len;
+}
+
+/*
+    Byte scanning kernels.
+
+    st_find_non_ascii() returns the offset of the first byte >= 0x80
+    and st_find_c1() the offset of the first byte in 0x80-0x9f (the
+    bytes is_latin1() rejects), or len if there is none. Each has a
+    word-at-a-time version plus SSE2 and AVX2 versions, picked once at
+    runtime by st_simd_level().
+*/
+
+#define ST_SIMD_NONE    0
+#define ST_SIMD_SSE2    1
+#define ST_SIMD_AVX2    2
+
+#define ST_WORD_HIGH_BITS   ((UV)(~(UV)0 / 0xff) * 0x80)
+
+static int
+st_simd_level() {
+    static int level = -1;
+    
+    if (level < 0) {
+        int l = ST_SIMD_NONE;
+#if defined(__SSE2__)
+        l = ST_SIMD_SSE2;
+#endif
+#if ST_HAVE_AVX2
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            l = ST_SIMD_AVX2;
+        }
+#endif
+        level = l;
+    }
+    return level;
+}
+
+static STRLEN
+st_find_non_ascii_word( const U8 *s, STRLEN len ) {
+    STRLEN i = 0;
+    UV w;
+    
+    for ( ; i + sizeof(UV) <= len; i += sizeof(UV)) {
+        Copy(s + i, &w, 1, UV);
+        if (w & ST_WORD_HIGH_BITS) {
+            break;
+        }
+    }
+    for ( ; i < len; i++) {
+        if (s[i] >= 0x80) {
+            break;
+        }
+    }
+    return i;
+}
+
+static STRLEN
+st_find_c1_word( const U8 *s, STRLEN len ) {
+    STRLEN i = 0;
+    
+    while (i < len) {
+        i += st_find_non_ascii_word(s + i, len - i);
+        if (i == len || s[i] < 0xa0) {
+            break;
+        }
+        i++;
+    }
+    return i;
+}
+
+#if defined(__SSE2__)
+static STRLEN
+st_find_non_ascii_sse2( const U8 *s, STRLEN len ) {
+    STRLEN i = 0;
+    int mask;
+    
+    for ( ; i + 16 <= len; i += 16) {
+        mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(s + i)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + st_find_non_ascii_word(s + i, len - i);
+}
+
+static STRLEN
+st_find_c1_sse2( const U8 *s, STRLEN len ) {
+    STRLEN i = 0;
+    int mask;
+    /* flip the high bit so 0x80-0x9f become the only bytes in 0-31 */
+    const __m128i flip = _mm_set1_epi8((char)0x80);
+    const __m128i lo   = _mm_set1_epi8(-1);
+    const __m128i hi   = _mm_set1_epi8(0x20);
+    
+    for ( ; i + 16 <= len; i += 16) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(s + i)), flip);
+        mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + st_find_c1_word(s + i, len - i);
+}
+#endif
+
+#if ST_HAVE_AVX2
+__attribute__((target("avx2")))
+static STRLEN
+st_find_non_ascii_avx2( const U8 *s, STRLEN len ) {
+    STRLEN i = 0;
+    unsigned int mask;
+    
+    for ( ; i + 32 <= len; i += 32) {
+        mask = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(s + i)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + st_find_non_ascii_sse2(s + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static STRLEN
+st_find_c1_avx2( const U8 *s, STRLEN len ) {
+    STRLEN i = 0;
+    unsigned int mask;
+    const __m256i flip = _mm256_set1_epi8((char)0x80);
+    const __m256i lo   = _mm256_set1_epi8(-1);
+    const __m256i hi   = _mm256_set1_epi8(0x20);
+    
+    for ( ; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(s + i)), flip);
+        mask = _mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpgt_epi8(v, lo), _mm256_cmpgt_epi8(hi, v)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + st_find_c1_sse2(s + i, len - i);
+}
+#endif
+
+static STRLEN
+st_find_non_ascii( const U8 *s, STRLEN len ) {
+    /* short strings (most tokens) are not worth the dispatch */
+    if (len < 16) {
+        return st_find_non_ascii_word(s, len);
+    }
+    switch (st_simd_level()) {
+#if ST_HAVE_AVX2
+    case ST_SIMD_AVX2:
+        return st_find_non_ascii_avx2(s, len);
+#endif
+#if defined(__SSE2__)
+    case ST_SIMD_SSE2:
+        return st_find_non_ascii_sse2(s, len);
+#endif
+    default:
+        return st_find_non_ascii_word(s, len);
+    }
+}
+
+static STRLEN
+st_find_c1( const U8 *s, STRLEN len ) {
+    if (len < 16) {
+        return st_find_c1_word(s, len);
+    }
+    switch (st_simd_level()) {
+#if ST_HAVE_AVX2
+    case ST_SIMD_AVX2:
+        return st_find_c1_avx2(s, len);
+#endif
+#if defined(__SSE2__)
+    case ST_SIMD_SSE2:
+        return st_find_c1_sse2(s, len);
+#endif
+    default:
+        return st_find_c1_word(s, len);
+    }
+}
+
+/*
+    Length of the well-formed UTF-8 sequence starting with the non-ASCII
+    byte at p, or 0 if it is malformed. Accepts what is_utf8_string()
+    accepts: surrogates and noncharacters are allowed, overlongs and
+    truncated sequences are not. Sequences above U+10FFFF (Perl's
+    extended UTF-8) are rare enough to hand to perl.
+*/
+static STRLEN
+st_utf8_seq_len( const U8 *p, const U8 *end ) {
+    const U8 c    = *p;
+    const STRLEN avail = end - p;
     
-    for(i=0; i<len; i++) {
-        if (str[i] >= 0x80) {
+    if (c < 0xc2) {
+        /* stray continuation byte or overlong 2-byte lead */
+        return 0;
+    }
+    if (c < 0xe0) {
+        return (avail >= 2 && (p[1] & 0xc0) == 0x80) ? 2 : 0;
+    }
+    if (c < 0xf0) {
+        if (avail < 3
+            || (p[1] & 0xc0) != 0x80 
+            || (p[2] & 0xc0) != 0x80
+            || (c == 0xe0 && p[1] < 0xa0)
+        ) {
             return 0;
-        }  
+        }
+        return 3;
     }
-    return 1;
+    if (c < 0xf4 || (c == 0xf4 && avail >= 2 && p[1] < 0x90)) {
+        if (avail < 4
+            || (p[1] & 0xc0) != 0x80 
+            || (p[2] & 0xc0) != 0x80
+            || (p[3] & 0xc0) != 0x80
+            || (c == 0xf0 && p[1] < 0x90)
+        ) {
+            return 0;
+        }
+        return 4;
+    }
+#if ((PERL_VERSION > 24) || (PERL_VERSION == 26 && PERL_SUBVERSION >= 5))
+    return isUTF8_CHAR(p, end);
+#elif (PERL_VERSION >= 16)
+    return is_utf8_char_buf(p, end);
+#else
+    return (UTF8SKIP(p) <= avail) ? is_utf8_char((U8*)p) : 0;
+#endif
+}
+
+/* number of chars in len bytes of valid UTF-8 */
+static STRLEN
+st_utf8_num_chars(const U8 *s, STRLEN len)
+{
+    STRLEN n = 0;
+    while (len--) {
+        if ((*s++ & 0xC0) != 0x80) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/*
+    Validate len bytes at s as UTF-8 in a single pass, skipping ASCII
+    runs with st_find_non_ascii(). Returns the offset of the first byte
+    of the first malformed sequence, or len if s is valid.
+*/
+static STRLEN
+st_find_bad_utf8_offset( const U8 *s, STRLEN len ) {
+    const U8 *p   = s;
+    const U8 *end = s + len;
+    STRLEN n;
+    
+    while (p < end) {
+        if (*p < 0x80) {
+            p += st_find_non_ascii(p, end - p);
+            continue;
+        }
+        if (!(n = st_utf8_seq_len(p, end))) {
+            break;
+        }
+        p += n;
+    }
+    return p - s;
+}
+
+/*
+    Classify len bytes at s in one pass. Returns a mask of ST_BUF_ASCII
+    (no bytes >= 0x80), ST_BUF_LATIN1 (no bytes in 0x80-0x9f) and 
+    ST_BUF_UTF8 (valid UTF-8 by the same rules as is_utf8_string()).
+    ASCII runs are skipped with st_find_non_ascii().
+*/
+static int
+st_classify_buf( const U8 *s, STRLEN len ) {
+    dTHX;
+    
+    const U8 *p   = s;
+    const U8 *end = s + len;
+    int flags;
+    
+    p += st_find_non_ascii(p, len);
+    if (p == end) {
+        return ST_BUF_ASCII | ST_BUF_LATIN1 | ST_BUF_UTF8;
+    }
+    flags = ST_BUF_LATIN1 | ST_BUF_UTF8;
+    while (p < end) {
+        if (*p < 0x80) {
+            p += st_find_non_ascii(p, end - p);
+            continue;
+        }
+        if (*p < 0xa0) {
+            flags &= ~ST_BUF_LATIN1;
+        }
+        if (flags & ST_BUF_UTF8) {
+            STRLEN n = st_utf8_seq_len(p, end);
+            if (n) {
+                /* continuation bytes can be C1 too */
+                while (--n) {
+                    if (*++p < 0xa0) {
+                        flags &= ~ST_BUF_LATIN1;
+                    }
+                }
+                p++;
+                continue;
+            }
+            flags &= ~ST_BUF_UTF8;
+        }
+        if (!flags) {
+            break;
+        }
+        if (!(flags & ST_BUF_UTF8)) {
+            /* only latin1 left to decide */
+            if (st_find_c1(p, end - p) != (STRLEN)(end - p)) {
+                flags &= ~ST_BUF_LATIN1;
+            }
+            break;
+        }
+        p++;
+    }
+    return flags;
 }
 
 /* SvRX does this in Perl >= 5.10 */
@@ -520,34 +1089,190 @@ st_get_regex_from_sv( SV *regex_sv ) {
     return rx;
 }
 
-static void
-st_heat_seeker( st_token *token, SV *re ) {
+static I32
+st_heat_seeker( st_token_list *tl, I32 idx, SV *re ) {
     dTHX;   /* thread-safe perlism */
     
     REGEXP *rx;
     char *buf, *str_end;
     
     rx = st_get_regex_from_sv(re);
-    buf = SvPVX(token->str);
-    str_end = buf + token->len;
+    buf = (char*)st_token_list_ptr(tl, idx);
+    str_end = buf + tl->len[idx];
 
-    if ( pregexec(rx, buf, str_end, buf, 1, token->str, 1) ) {
+    /* match in place against the shared buffer, anchored at the token */
+    if ( pregexec(rx, buf, str_end, buf, 1, tl->buf, 1) ) {
         if (ST_DEBUG > 1) {
-            warn("st_heat_seeker: token is hot: %s", buf);
+            warn("st_heat_seeker: token is hot: %.*s", (int)tl->len[idx], buf);
         }
-        token->is_hot = 1;
+        return 1;
     }
-
+    return 0;
 }
 
-static AV*
-st_heat_seeker_offsets( SV *str, SV *re ) {
+/*
+    The literals must be lowercase ASCII, as CompiledQuery literals()
+    makes them. Returns NULL if any literal is empty, since then a match
+    could start anywhere.
+*/
+static st_prefilter*
+st_new_prefilter( AV *literals, IV max_len ) {
+    dTHX;
+    st_prefilter *pf;
+    I32 i, num;
+    STRLEN j;
+    
+    num = av_len(literals) + 1;
+    if (!num) {
+        return NULL;
+    }
+    for (i = 0; i < num; i++) {
+        if (!sv_len(st_av_fetch(literals, i))) {
+            return NULL;
+        }
+    }
+    
+    pf = st_malloc(sizeof(st_prefilter));
+    Zero(pf, 1, st_prefilter);
+    pf->lits = st_malloc(sizeof(U8*) * num);
+    pf->lens = st_malloc(sizeof(STRLEN) * num);
+    pf->num = num;
+    pf->max_len = max_len > 0 ? (STRLEN)max_len : 0;
+    for (i = 0; i < num; i++) {
+        STRLEN len;
+        const U8 *lit = (U8*)SvPV(st_av_fetch(literals, i), len);
+        U8 c;
+        
+        pf->lits[i] = st_malloc(len);
+        for (j = 0; j < len; j++) {
+            pf->lits[i][j] = toLOWER_A(lit[j]);
+        }
+        pf->lens[i] = len;
+        
+        c = pf->lits[i][0];
+        if (!pf->first[c]) {
+            pf->first[c] = 1;
+            pf->first[toUPPER_A(c)] = 1;
+            if (pf->num_bytes >= 0) {
+                pf->num_bytes += c == toUPPER_A(c) ? 1 : 2;
+            }
+            if (pf->num_bytes > ST_PREFILTER_MAX_MEMCHR) {
+                pf->num_bytes = -1;
+            }
+        }
+    }
+    
+    /* with few distinct first bytes libc memchr() beats a table
+       lookup per byte. Each byte remembers where memchr() last found
+       it, so every byte of the str is scanned once per byte value.
+     */
+    if (pf->num_bytes > 0) {
+        I32 n = 0;
+        for (i = 0; i < 256; i++) {
+            if (pf->first[i]) {
+                pf->bytes[n] = (U8)i;
+                pf->next[n] = NULL;
+                n++;
+            }
+        }
+    }
+    else {
+        pf->num_bytes = 0;
+    }
+    
+    return pf;
+}
+
+static void
+st_free_prefilter( st_prefilter *pf ) {
+    I32 i;
+    for (i = 0; i < pf->num; i++) {
+        free(pf->lits[i]);
+    }
+    free(pf->lits);
+    free(pf->lens);
+    free(pf);
+}
+
+/*
+    The first position at or after s where one of the pf literals
+    starts, or NULL. Positions must only move forward between calls
+    with the same str.
+*/
+static const U8*
+st_prefilter_next( st_prefilter *pf, const U8 *s, const U8 *end ) {
+    const U8 *cand;
+    I32 i;
+    STRLEN j;
+    
+    while (s < end) {
+        if (pf->num_bytes) {
+            cand = end;
+            for (i = 0; i < pf->num_bytes; i++) {
+                if (pf->next[i] < s) {
+                    pf->next[i] = memchr(s, pf->bytes[i], end - s);
+                    if (!pf->next[i]) {
+                        pf->next[i] = end;
+                    }
+                }
+                if (pf->next[i] < cand) {
+                    cand = pf->next[i];
+                }
+            }
+        }
+        else {
+            for (cand = s; cand < end && !pf->first[*cand]; cand++) {
+                /* skip */
+            }
+        }
+        if (cand == end) {
+            return NULL;
+        }
+        
+        for (i = 0; i < pf->num; i++) {
+            const U8 *lit = pf->lits[i];
+            if (pf->lens[i] > (STRLEN)(end - cand)
+                || toLOWER_A(*cand) != lit[0]
+            ) {
+                continue;
+            }
+            for (j = 1; j < pf->lens[i]; j++) {
+                if (toLOWER_A(cand[j]) != lit[j]) {
+                    break;
+                }
+            }
+            if (j == pf->lens[i]) {
+                return cand;
+            }
+        }
+        s = cand + 1;
+    }
+    return NULL;
+}
+
+/*
+    The byte offsets of the matches of re in str. Stops after max_hits
+    matches, and looks for matches only in the first max_bytes of str
+    (rounded up to a whole char), either of which may be 0 for no limit.
+    
+    If literals is not NULL every match of re must start with one of
+    them (see CompiledQuery literals()), and re is tried only where
+    they do. max_len is the most bytes a match can span, or 0 if
+    unknown. With a max_len re only looks at the max_len bytes at each
+    candidate, so a long str with no matches costs a scan for the
+    literals instead of a regex run at every byte, until more than
+    ST_PREFILTER_MAX_MISSES candidates have come to nothing.
+*/
+static AV*
+st_heat_seeker_offsets( SV *str, SV *re, IV max_hits, IV max_bytes, AV *literals, IV max_len ) {
     dTHX;
     
     REGEXP *rx;
     char *buf, *str_end, *str_start;
     STRLEN str_len;
     AV *offsets;
+    st_prefilter *pf;
+    IV misses = 0;
 #if (PERL_VERSION > 10)
     regexp *r;
 #endif
@@ -560,530 +1285,4123 @@ st_heat_seeker_offsets( SV *str, SV *re ) {
     str_start = buf;
     str_end = buf + str_len;
     offsets = newAV();
+    if (max_bytes > 0 && (STRLEN)max_bytes < str_len) {
+        str_end = buf + max_bytes;
+        while (SvUTF8(str) && str_end < buf + str_len
+            && UTF8_IS_CONTINUATION(*(U8*)str_end)
+        ) {
+            str_end++;
+        }
+    }
+    pf = literals ? st_new_prefilter(literals, max_len) : NULL;
     
-    while ( pregexec(rx, buf, str_end, buf, 1, str, 1) ) {
-        const char *start_ptr, *end_ptr;
+    while (buf < str_end) {
+        const char *start_ptr, *end_ptr, *from, *to;
+        
+        from = buf;
+        to   = str_end;
+        if (pf) {
+            from = (char*)st_prefilter_next(pf, (U8*)buf, (U8*)str_end);
+            if (!from) {
+                break;
+            }
+            if (pf->max_len && pf->max_len < (STRLEN)(str_end - from)) {
+                to = from + pf->max_len;
+                while (SvUTF8(str) && to < str_end
+                    && UTF8_IS_CONTINUATION(*(U8*)to)
+                ) {
+                    to++;
+                }
+            }
+        }
+        if (!pregexec(rx, (char*)from, (char*)to, (char*)from, 1, str, 1)) {
+            if (to == str_end) {
+                break;
+            }
+            buf = (char*)from + 1;
+            
+            /* a literal too common to be worth a regex run each, so
+               let the regex find the next match on its own, which also
+               ends the scan if there are no more. */
+            if (++misses > ST_PREFILTER_MAX_MISSES) {
+                pf->max_len = 0;
+            }
+            continue;
+        }
         
 #if ((PERL_VERSION == 10) || (PERL_VERSION == 9 && PERL_SUBVERSION >= 5))
-        start_ptr = buf + rx->offs[0].start;
-        end_ptr   = buf + rx->offs[0].end;
+        start_ptr = from + rx->offs[0].start;
+        end_ptr   = from + rx->offs[0].end;
 #elif (PERL_VERSION > 10)
-        start_ptr = buf + r->offs[0].start;
-        end_ptr   = buf + r->offs[0].end;
+        start_ptr = from + r->offs[0].start;
+        end_ptr   = from + r->offs[0].end;
 #else
-        start_ptr = buf + rx->startp[0];
-        end_ptr   = buf + rx->endp[0];
+        start_ptr = from + rx->startp[0];
+        end_ptr   = from + rx->endp[0];
 #endif
+        /* in a max_len window only a match at the candidate counts,
+           any later one will be found from its own candidate */
+        if (to != str_end && start_ptr != from) {
+            buf = (char*)from + 1;
+            continue;
+        }
+        
         /* advance the pointer */
         buf = (char*)end_ptr;
         
         //warn("got heat match at %ld", start_ptr - str_start);
         av_push(offsets, newSViv(start_ptr - str_start));
-        
+        if (max_hits > 0 && av_len(offsets) + 1 >= max_hits) {
+            break;
+        }
+    }
+    
+    if (pf) {
+        st_free_prefilter(pf);
     }
             
     return offsets;
 }
 
 /*
-    st_tokenize() et al based on KinoSearch::Analysis::Tokenizer 
-    by Marvin Humphrey.
-    He dared go where no XS regex user had gone before...
+    Unicode tables for code running outside perl. NULL until
+    st_init_uni(), after which st_word_char_len(), st_fold_utf8() and
+    st_string_to_lower() use them in every thread. Never freed.
 */
+static st_uni *ST_UNI = NULL;
 
-static SV*
-st_tokenize( SV* str, SV* token_re, SV* heat_seeker, I32 match_num ) {
-    dTHX;   /* thread-safe perlism */
-    
-/* declare */
-    IV               num_tokens, prev_sentence_start;
-    REGEXP          *rx;
-#if (PERL_VERSION > 10)
-    regexp          *r;
-#endif
-    char            *buf, *str_start, *str_end, *token_str;
-    STRLEN           str_len;
-    const char      *prev_end, *prev_start;
-    AV              *tokens;
-    AV              *heat;
-    AV              *sentence_starts;   /* list of sentence start points for hot tokens */
-    SV              *tok;
-    boolean          heat_seeker_is_CV, inside_sentence, prev_was_abbrev;
-
-/* initialize */
-    num_tokens      = 0;
-    rx              = st_get_regex_from_sv(token_re);
-#if (PERL_VERSION > 10)
-    r               = (regexp*)SvANY(rx);
-#endif
-    buf             = SvPV(str, str_len);
-    str_start       = buf;
-    str_end         = str_start + str_len;
-    prev_start      = str_start;
-    prev_end        = prev_start;
-    tokens          = newAV();
-    heat            = newAV();
-    sentence_starts = newAV();
-    prev_sentence_start = 0;
-    inside_sentence     = 0;    // assume we start with a sentence start
-    heat_seeker_is_CV   = 0;
-    prev_was_abbrev     = 0;
-    if (heat_seeker != NULL && (SvTYPE(SvRV(heat_seeker))==SVt_PVCV)) {
-         heat_seeker_is_CV = 1;
+static void
+st_uni_map_push( st_uni_map **map, I32 *num, I32 *max, UV cp, const U8 *utf8, STRLEN len ) {
+    if (*num == *max) {
+        *max = *max ? *max * 2 : 1024;
+        *map = st_realloc(*map, sizeof(st_uni_map) * *max);
     }
+    (*map)[*num].cp  = (U32)cp;
+    (*map)[*num].len = (U8)len;
+    Copy(utf8, (*map)[*num].utf8, len, U8);
+    (*num)++;
+}
+
+/* 
+    Ask the interpreter about every code point above ASCII, once.
+    Must be called from a perl thread before any other thread relies
+    on ST_UNI.
+*/
+static void
+st_init_uni() {
+    dTHX;
     
-    if (ST_DEBUG) {    
-        warn("tokenizing string %ld bytes long\n", str_len);
-    }
+    st_uni *uni;
+    UV cp;
+    I32 max_word, max_fold, max_lower;
+    boolean in_word, is_word;
+    U8 orig[UTF8_MAXBYTES+1], mapped[UTF8_MAXBYTES_CASE+1];
+    STRLEN orig_len, len;
     
-    while ( pregexec(rx, buf, str_end, buf, 1, str, 1) ) {
-        const char *start_ptr, *end_ptr;
-        st_token *token;
-        
-#if ((PERL_VERSION == 10) || (PERL_VERSION == 9 && PERL_SUBVERSION >= 5))
-        start_ptr = buf + rx->offs[match_num].start;
-        end_ptr   = buf + rx->offs[match_num].end;
-#elif (PERL_VERSION > 10)
-        start_ptr = buf + r->offs[match_num].start;
-        end_ptr   = buf + r->offs[match_num].end;
-#else
-        start_ptr = buf + rx->startp[match_num];
-        end_ptr   = buf + rx->endp[match_num];
-#endif
-
-        /* advance the pointers */
-        buf = (char*)end_ptr;
-        
-        /*  create token for the bytes between the last match and this one
-         *  check first that we have moved past first byte 
-         *  and that the regex has moved us forward at least one byte
-         */
-        if (start_ptr != str_start && start_ptr != prev_end) {
-            token = st_new_token(num_tokens++, 
-                                (start_ptr - prev_end),
-                                utf8_distance((U8*)start_ptr, (U8*)prev_end),
-                                prev_end, 0, 0);
-            token_str = SvPV_nolen(token->str);
-            
-            /* TODO
-            there is an edge case here where a token that ends a sentence
-            (e.g. punctuation) also matches the start of the next sentence
-            (e.g. more punctuation, inverted question mark).
-            Need to split that into 2 tokens in order to distinguish
-            the end and start
-            */
-            
-            if (!inside_sentence) {
-                if (num_tokens == 1
-                    ||
-                    st_looks_like_sentence_start((unsigned char*)token_str, token->len)
-                ) {
-                    token->is_sentence_start = 1;
-                    inside_sentence          = 1;
-                }
-            }
-            else if (!prev_was_abbrev
-                    &&
-                    st_looks_like_sentence_end((unsigned char*)token_str, token->len)
-            ) {
-                token->is_sentence_end = 1;
-                inside_sentence        = 0;
-            }
-            if (st_is_abbreviation((unsigned char*)token_str, token->len)) {
-                token->is_abbreviation = 1;
-                prev_was_abbrev = 1;
-            }
-            else {
-                prev_was_abbrev = 0;
-            }
-            
-            if (ST_DEBUG > 1) {
-                warn("prev [%d] [%d] [%d] [%s] [%d] [%d]", 
-                    token->pos, token->len, token->u8len, token_str,
-                    token->is_sentence_start, token->is_sentence_end);
-            }
-            
-            tok = st_bless_ptr(ST_CLASS_TOKEN, token);
-            av_push(tokens, tok);
-            if (token->is_sentence_start) {
-                //av_push(sentence_starts, newSViv(token->pos));
-                prev_sentence_start = token->pos;
-            }
-        }
-        
-        /* create token object for the current match */            
-        token = st_new_token(num_tokens++, 
-                            (end_ptr - start_ptr),
-                            utf8_distance((U8*)end_ptr, (U8*)start_ptr),
-                            start_ptr,
-                            0, 1);
-        token_str = SvPV_nolen(token->str);
-        
-        if (!inside_sentence) {
-            token->is_sentence_start = 1;
-            inside_sentence          = 1;
-            prev_sentence_start      = token->pos;
-        }
-        else if (!prev_was_abbrev 
-                && 
-                st_looks_like_sentence_end((unsigned char*)token_str, token->len)
-        ) {
-            token->is_sentence_end = 1;
-            inside_sentence        = 0;
+    if (ST_UNI != NULL) {
+        return;
+    }
+    uni = st_malloc(sizeof(st_uni));
+    Zero(uni, 1, st_uni);
+    max_word = max_fold = max_lower = 0;
+    in_word = 0;
+    for (cp = 0x80; cp <= 0x10FFFF; cp++) {
+        if (cp >= 0xD800 && cp <= 0xDFFF) {
+            continue;
         }
-        if (st_is_abbreviation((unsigned char*)token_str, token->len)) {
-            token->is_abbreviation = 1;
-            prev_was_abbrev = 1;
+        is_word = isWORDCHAR_uvchr(cp) != 0;
+        if (cp >= 0x100 && is_word != in_word) {
+            if (uni->num_word == max_word) {
+                max_word  = max_word ? max_word * 2 : 1024;
+                uni->word = st_realloc(uni->word, sizeof(UV) * max_word);
+            }
+            uni->word[uni->num_word++] = cp;
+            in_word = is_word;
         }
-        else {
-            prev_was_abbrev = 0;
+        /* every code point with a case mapping is Alphabetic, so \w.
+         * Asking only about those saves most of the time here.
+         */
+        if (!is_word) {
+            continue;
         }
-        
-        if (ST_DEBUG > 1) {
-            warn("main [%d] [%d] [%d] [%s] [%d] [%d]", 
-                token->pos, token->len, token->u8len, token_str,
-                token->is_sentence_start, token->is_sentence_end
-            );
+        orig_len = uvchr_to_utf8(orig, cp) - orig;
+        toFOLD_uvchr(cp, mapped, &len);
+        if (len != orig_len || memNE(mapped, orig, len)) {
+            st_uni_map_push(&uni->fold, &uni->num_fold, &max_fold, cp, mapped, len);
         }
-        
-        tok = st_bless_ptr(ST_CLASS_TOKEN, token);
-        if (heat_seeker != NULL) {
-            if (heat_seeker_is_CV) {
-                dSP;
-                ENTER;
-                SAVETMPS;
-                PUSHMARK(SP);
-                XPUSHs(tok);
-                PUTBACK;
-                if (call_sv(heat_seeker, G_SCALAR) != 1) {
-                    croak("Invalid return value from heat_seeker SUB -- should be single integer");
-                }
-                SPAGAIN;
-                token->is_hot = POPi;
-                //warn("heat_seeker CV returned %d\n", token->is_hot);
-                PUTBACK;
-                FREETMPS;
-                LEAVE;
-            }
-            else {
-                st_heat_seeker(token, heat_seeker);
-            }
+        toLOWER_uvchr(cp, mapped, &len);
+        if (len != orig_len || memNE(mapped, orig, len)) {
+            st_uni_map_push(&uni->lower, &uni->num_lower, &max_lower, cp, mapped, len);
         }
-        av_push(tokens, tok);
-        if (token->is_sentence_start) {
-            //av_push(sentence_starts, newSViv(token->pos));
-            prev_sentence_start = token->pos;
+    }
+    ST_UNI = uni;
+}
+
+static boolean
+st_uni_is_word( UV cp ) {
+    I32 lo, hi, mid;
+    
+    /* the last entry <= cp; even entries start a \w range */
+    lo = 0;
+    hi = ST_UNI->num_word - 1;
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        if (ST_UNI->word[mid] <= cp) {
+            lo = mid + 1;
         }
-        if (token->is_hot) {
-            av_push(heat, newSViv(token->pos));
-            if (ST_DEBUG)
-                warn("%s: sentence_start = %ld for hot token at pos %ld\n",
-                    FUNCTION__, (unsigned long)prev_sentence_start, (unsigned long)token->pos);
-                    
-            av_push(sentence_starts, newSViv(prev_sentence_start));
+        else {
+            hi = mid - 1;
         }
-        
-        /* remember where we are for next time */
-        prev_end = end_ptr;
-        prev_start = start_ptr;
     }
+    return hi >= 0 && !(hi & 1);
+}
+
+static const st_uni_map*
+st_uni_find( const st_uni_map *map, I32 num, UV cp ) {
+    I32 lo, hi, mid;
     
-    if (prev_end != str_end) {
-        /* some bytes after the last match */
-        st_token *token = st_new_token(num_tokens++, 
-                                    (str_end - prev_end),
-                                    utf8_distance((U8*)str_end, (U8*)prev_end),
-                                    prev_end, 
-                                    0, 0);
-        token_str = SvPV_nolen(token->str);
-        if (st_looks_like_sentence_start((unsigned char*)token_str, token->len)) {
-            token->is_sentence_start = 1;
+    lo = 0;
+    hi = num - 1;
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        if (map[mid].cp == cp) {
+            return &map[mid];
         }
-        else if (st_looks_like_sentence_end((unsigned char*)token_str, token->len)) {
-            token->is_sentence_end = 1;
+        if (map[mid].cp < cp) {
+            lo = mid + 1;
         }
-        if (ST_DEBUG > 1) {
-            warn("tail: [%d] [%d] [%d] [%s] [%d] [%d]", 
-                token->pos, token->len, token->u8len, token_str,
-                token->is_sentence_start, token->is_sentence_end
-            );
+        else {
+            hi = mid - 1;
         }
+    }
+    return NULL;
+}
 
-        tok = st_bless_ptr(ST_CLASS_TOKEN, token);
-        av_push(tokens, tok);
+/* map the u byte UTF-8 char at s into d, returning the bytes written */
+static STRLEN
+st_uni_case( const st_uni_map *map, I32 num, const U8 *s, STRLEN u, U8 *d ) {
+    const st_uni_map *m;
+    
+    m = st_uni_find(map, num, (UV)st_utf8_codepoint(s, u));
+    if (m == NULL) {
+        Copy(s, d, u, U8);
+        return u;
     }
-        
-    return st_bless_ptr(
-            ST_CLASS_TOKENLIST, 
-            st_new_token_list(tokens, heat, sentence_starts, num_tokens)
-           );
+    Copy(m->utf8, d, m->len, U8);
+    return m->len;
 }
 
-static SV*
-st_find_bad_utf8( SV* str ) {
+/*
+    If token_re is the Search::Tools::Tokenizer default, or the
+    Search::Tools::QueryParser default term_re, return the ST_SCAN_* mode
+    st_scan_word() should use to match it against str.
+    Returns ST_SCAN_NONE for any other regex, which goes through pregexec().
+*/
+static U8
+st_scan_mode( SV *str, SV *token_re, I32 match_num ) {
     dTHX;
     
+    const char *pat;
     STRLEN len;
-    U8 *bytes;
-    const U8 *pos;
-    STRLEN *el;
-
-    bytes   = (U8*)SvPV(str, len);
-    el      = 0;
-    if (is_utf8_string(bytes, len)) {
-        return &PL_sv_undef;
+    
+    if (match_num != 0) {
+        return ST_SCAN_NONE;
     }
-    else {
-        is_utf8_string_loclen(bytes, len, &pos, el);
-        return newSVpvn((char*)pos, strlen((char*)pos));
+    pat = SvPV(token_re, len);
+    if (strEQ(pat, "(?^:" ST_DEFAULT_TOKEN_RE ")")
+        ||
+        strEQ(pat, "(?-xism:" ST_DEFAULT_TOKEN_RE ")")
+    ) {
+        return SvUTF8(str) ? ST_SCAN_UTF8 : ST_SCAN_ASCII;
+    }
+    if (strEQ(pat, "(?^u:" ST_DEFAULT_TOKEN_RE ")")) {
+        return SvUTF8(str) ? ST_SCAN_UTF8 : ST_SCAN_LATIN1;
     }
+    if (strEQ(pat, "(?^:" ST_QUERY_TERM_RE ")")
+        ||
+        strEQ(pat, "(?-xism:" ST_QUERY_TERM_RE ")")
+    ) {
+        return ST_SCAN_NO_DOT | (SvUTF8(str) ? ST_SCAN_UTF8 : ST_SCAN_ASCII);
+    }
+    return ST_SCAN_NONE;
 }
 
-/* lifted nearly verbatim from mod_perl */
-static SV *st_escape_xml(char *s) {
-    dTHX;
-
-    int i, j;
-    SV *x;
-
-    /* first, count the number of extra characters */
-    for (i = 0, j = 0; s[i] != '\0'; i++)
-        if (s[i] == '<' || s[i] == '>')
-            j += 3;
-        else if (s[i] == '&')
-            j += 4;
-        else if (s[i] == '"' || s[i] == '\'')
-            j += 5;
-
-    if (j == 0)
-        return newSVpv(s,i);
-
-    x = newSV(i + j + 1);
-
-    for (i = 0, j = 0; s[i] != '\0'; i++, j++)
-    if (s[i] == '<') {
-        memcpy(&SvPVX(x)[j], "&lt;", 4);
-        j += 3;
+/* byte length of the \w char at s, or 0 if s is not a \w char */
+static STRLEN
+st_word_char_len( const U8 *s, const U8 *end, U8 mode ) {
+    if (UTF8_IS_INVARIANT(*s)) {
+        return isWORDCHAR_A(*s) ? 1 : 0;
     }
-    else if (s[i] == '>') {
-        memcpy(&SvPVX(x)[j], "&gt;", 4);
-        j += 3;
+    switch (mode) {
+    case ST_SCAN_ASCII:
+        return 0;
+    case ST_SCAN_LATIN1:
+        return isWORDCHAR_L1(*s) ? 1 : 0;
+    default:
+        if (ST_UNI != NULL) {
+            STRLEN u = UTF8SKIP(s);
+            UV cp;
+            if (u > (STRLEN)(end - s)) {
+                return 0;
+            }
+            cp = st_utf8_codepoint(s, u);
+            if (cp < 256) {
+                return isWORDCHAR_L1(cp) ? u : 0;
+            }
+            return st_uni_is_word(cp) ? u : 0;
+        }
+        {
+            dTHX;
+#if ((PERL_VERSION > 24) || (PERL_VERSION == 26 && PERL_SUBVERSION >= 5))
+            return isWORDCHAR_utf8_safe(s, end) ? UTF8SKIP(s) : 0;
+#else
+            return isALNUM_utf8((U8*)s) ? UTF8SKIP(s) : 0;
+#endif
+        }
     }
-    else if (s[i] == '&') {
-        memcpy(&SvPVX(x)[j], "&amp;", 5);
-        j += 4;
+}
+
+/*
+    Find the next match for ST_DEFAULT_TOKEN_RE, i.e. 
+    \w+(?:['\-.]\w+)*, in buf, or for ST_QUERY_TERM_RE with
+    ST_SCAN_NO_DOT. The pattern never needs to backtrack,
+    so a single forward scan gives the same match as the regex engine.
+*/
+static boolean
+st_scan_word( const U8 *buf, const U8 *end, U8 scan_mode, const U8 **start, const U8 **stop ) {
+    STRLEN n;
+    const U8 *s = buf;
+    U8 mode = ST_SCAN_CLASS(scan_mode);
+    boolean dot = !(scan_mode & ST_SCAN_NO_DOT);
+    
+    /* skip to the first word char */
+    while (s < end && !(n = st_word_char_len(s, end, mode))) {
+        s += UTF8_IS_INVARIANT(*s) || mode != ST_SCAN_UTF8 ? 1 : UTF8SKIP(s);
     }
-    else if (s[i] == '"') {
-        memcpy(&SvPVX(x)[j], "&quot;", 6);
-        j += 5;
+    if (s >= end) {
+        return 0;
     }
-    else if (s[i] == '\'') {
-        memcpy(&SvPVX(x)[j], "&#39;", 5);
-        j += 4;
+    *start = s;
+    s += n;
+    
+    while (s < end) {
+        if ((n = st_word_char_len(s, end, mode))) {
+            s += n;
+        }
+        else if ((*s == '\'' || *s == '-' || (*s == '.' && dot))
+                 && s + 1 < end
+                 && (n = st_word_char_len(s + 1, end, mode))
+        ) {
+            s += 1 + n;
+        }
+        else {
+            break;
+        }
     }
-    else
-        SvPVX(x)[j] = s[i];
-
-    SvPVX(x)[j] = '\0';
-    SvCUR_set(x, j);
-    SvPOK_on(x);
-    return x;
+    *stop = s;
+    return 1;
 }
 
-/* returns the UCS32 value for a UTF8 string -- the character's Unicode value.
-   see http://scripts.sil.org/cms/scripts/page.php?site_id=nrsi&item_id=IWS-AppendixA
+/*
+    st_tokenize() et al based on KinoSearch::Analysis::Tokenizer 
+    by Marvin Humphrey.
+    He dared go where no XS regex user had gone before...
 */
-static IV
-st_utf8_codepoint(
-    const unsigned char *utf8,
-    IV len
-)
-{
-    dTHX;
-    
-    switch (len) {
 
-    case 1:
-        return utf8[0];
+/* start a new document */
+static void
+st_reset_tokenizer( st_tokenizer *st ) {
+    st->num                 = 0;
+    st->prev_sentence_start = 0;
+    st->inside_sentence     = 0;    // assume we start with a sentence start
+    st->prev_was_abbrev     = 0;
+}
 
-    case 2:
-        return (utf8[0] - 192) * 64 + utf8[1] - 128;
-
-    case 3:
-        return (utf8[0] - 224) * 4096 + (utf8[1] - 128) * 64 + utf8[2] - 128;
-
-    case 4:
-    default:
-        return (utf8[0] - 240) * 262144 + (utf8[1] - 128) * 4096 + (utf8[2] - 128) * 64 +
-            utf8[3] - 128;
+static void
+st_init_tokenizer( st_tokenizer *st, SV *token_re, SV *heat_seeker, I32 match_num, st_abbrevs *abbrevs ) {
+    dTHX;
+    
+    st->token_re            = token_re;
+    st->rx                  = st_get_regex_from_sv(token_re);
+    st->heat_seeker         = heat_seeker;
+    st->match_num           = match_num;
+    st->heat_seeker_is_CV   = 0;
+    st->term_set            = NULL;
+    st->abbrevs             = abbrevs;
+    st->debug               = ST_DEBUG;     /* get_sv() is too slow to call per token */
+    st->carry               = NULL;
+    st->ref_cnt             = 1;
+    st_reset_tokenizer(st);
+    if (heat_seeker != NULL && (SvTYPE(SvRV(heat_seeker))==SVt_PVCV)) {
+         st->heat_seeker_is_CV = 1;
+    }
+    else if (heat_seeker != NULL && sv_derived_from(heat_seeker, ST_CLASS_TERMSET)) {
+         st->term_set = (st_term_set*)st_extract_ptr(heat_seeker);
+    }
+}
 
+/* create token for the bytes between the last match and the next one */
+static void
+st_tokenize_gap( st_tokenizer *st, st_token_list *tl, const char *ptr, STRLEN len ) {
+    I32 idx;
+    
+    idx = st_new_token(tl, len, st_utf8_num_chars((const U8*)ptr, len), ptr, 0);
+    
+    /* TODO
+    there is an edge case here where a token that ends a sentence
+    (e.g. punctuation) also matches the start of the next sentence
+    (e.g. more punctuation, inverted question mark).
+    Need to split that into 2 tokens in order to distinguish
+    the end and start
+    */
+    
+    if (!st->inside_sentence) {
+        if (st->num + tl->num == 1
+            ||
+            st_looks_like_sentence_start((unsigned char*)ptr, len)
+        ) {
+            ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_SENTENCE_START);
+            st->inside_sentence = 1;
+            st->prev_sentence_start = idx;
+        }
+    }
+    else if (!st->prev_was_abbrev
+            &&
+            st_looks_like_sentence_end((unsigned char*)ptr, len)
+    ) {
+        ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_SENTENCE_END);
+        st->inside_sentence = 0;
+    }
+    st->prev_was_abbrev = st_is_abbreviation(st->abbrevs, 
+                            (unsigned char*)ptr, len);
+    if (st->prev_was_abbrev) {
+        ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_ABBREVIATION);
+    }
+    
+    if (st->debug > 1) {
+        warn("prev [%d] [%d] [%d] [%.*s] [%d] [%d]", 
+            idx, tl->len[idx], tl->u8len[idx], (int)len, ptr,
+            ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_START), 
+            ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_END));
     }
 }
 
-static IV
-st_looks_like_sentence_start(const unsigned char *ptr, IV len) 
-{
-    dTHX;
+/* create token object for a regex match */
+static void
+st_tokenize_match( st_tokenizer *st, st_token_list *tl, const char *ptr, STRLEN len ) {
+    I32         idx;
+    boolean     is_abbrev;
+    SV         *tok;
     
-    I32 u8len, u32pt;
+    idx = st_new_token(tl, len, st_utf8_num_chars((const U8*)ptr, len), ptr, 0);
+    ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_MATCH);
+    /* an abbreviation with a dot in it (e.g. Ph.D) does not end a sentence */
+    is_abbrev = st_is_abbreviation(st->abbrevs, (unsigned char*)ptr, len);
+    if (is_abbrev) {
+        ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_ABBREVIATION);
+    }
     
-    if (ST_DEBUG > 1)
-        warn("%s: >%s< %ld\n", FUNCTION__, ptr, len); 
+    if (!st->inside_sentence) {
+        ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_SENTENCE_START);
+        st->inside_sentence     = 1;
+        st->prev_sentence_start = idx;
+    }
+    else if (!st->prev_was_abbrev 
+            && 
+            !is_abbrev
+            &&
+            st_looks_like_sentence_end((unsigned char*)ptr, len)
+    ) {
+        ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_SENTENCE_END);
+        st->inside_sentence = 0;
+    }
+    st->prev_was_abbrev = is_abbrev;
     
-    /* optimized for ASCII */
-    if (st_char_is_ascii((unsigned char*)ptr, len)) {
-        
-        /* if the string is more than one byte long,
-           make sure the second char is NOT UPPER
-           since that is likely a false positive.
-        */
-        if (len > 1) {
-            if (isUPPER(ptr[0]) && !isUPPER(ptr[1])) {
-                return 1;
-            }
-            else {
-                return 0;
+    if (st->debug > 1) {
+        warn("main [%d] [%d] [%d] [%.*s] [%d] [%d]", 
+            idx, tl->len[idx], tl->u8len[idx], (int)len, ptr,
+            ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_START), 
+            ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_END)
+        );
+    }
+    
+    if (st->heat_seeker != NULL) {
+        if (st->heat_seeker_is_CV) {
+            dTHX;
+            dSP;
+            /* the CV needs a real Token, so keep it in its slot */
+            tok = st_token_list_bless_token(tl, idx);
+            av_store(tl->tokens, idx, tok);
+            ENTER;
+            SAVETMPS;
+            PUSHMARK(SP);
+            XPUSHs(tok);
+            PUTBACK;
+            if (call_sv(st->heat_seeker, G_SCALAR) != 1) {
+                croak("Invalid return value from heat_seeker SUB -- should be single integer");
             }
+            SPAGAIN;
+            tl->hot[idx] = POPi;
+            //warn("heat_seeker CV returned %d\n", tl->hot[idx]);
+            PUTBACK;
+            FREETMPS;
+            LEAVE;
+        }
+        else if (st->term_set != NULL) {
+            tl->hot[idx] = st_term_set_contains(st->term_set, (const U8*)ptr, len);
         }
         else {
-            return isUPPER(ptr[0]);
+            tl->hot[idx] = st_heat_seeker(tl, idx, st->heat_seeker);
         }
     }
+    if (tl->hot[idx]) {
+        st_token_list_add_heat(tl, idx, st->prev_sentence_start);
+        if (st->debug)
+            warn("%s: sentence_start = %ld for hot token at pos %ld\n",
+                FUNCTION__, (unsigned long)st->prev_sentence_start, (unsigned long)idx);
+    }
+}
+
+/* some bytes after the last match */
+static void
+st_tokenize_tail( st_tokenizer *st, st_token_list *tl, const char *ptr, STRLEN len ) {
+    I32 idx;
     
-    if (!len) {
-        return 0;
+    idx = st_new_token(tl, len, st_utf8_num_chars((const U8*)ptr, len), ptr, 0);
+    if (st_looks_like_sentence_start((unsigned char*)ptr, len)) {
+        ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_SENTENCE_START);
+    }
+    else if (st_looks_like_sentence_end((unsigned char*)ptr, len)) {
+        ST_TOKEN_SET_FLAG(tl, idx, ST_TOKEN_SENTENCE_END);
     }
+    if (st->debug > 1) {
+        warn("tail: [%d] [%d] [%d] [%.*s] [%d] [%d]", 
+            idx, tl->len[idx], tl->u8len[idx], (int)len, ptr,
+            ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_START), 
+            ST_TOKEN_FLAG(tl, idx, ST_TOKEN_SENTENCE_END)
+        );
+    }
+}
+
+/*
+    Tokenize tl->buf into tl, carrying sentence state in st.
+    If final is false the bytes from the end of the second-to-last
+    match onward are left alone, since more input could still extend
+    the last match (or turn a trailing gap into part of one).
+    Returns the number of bytes of tl->buf consumed.
+*/
+static STRLEN
+st_tokenize_buf( st_tokenizer *st, st_token_list *tl, boolean final ) {
+    dTHX;
     
-    /* TODO if any char is UPPER in the string, consider it a start? */
+    char            *buf;
+    STRLEN           str_len, consumed;
     
-    /* get first full UTF-8 char */
-#if (PERL_VERSION >= 16)
-    //warn("WE HAVE utf8_char_buf\n");
-    u8len = is_utf8_char_buf((const U8*)ptr, (const U8*)ptr+UTF8SKIP(ptr));
-#else
-    //warn("WE HAVE utf8_char\n");
-    u8len = is_utf8_char((U8*)ptr);
+    buf      = SvPV(tl->buf, str_len);
+    consumed = st_tokenize_bytes(st, tl, buf, str_len,
+                    st_scan_mode(tl->buf, st->token_re, st->match_num), final);
+        
+    /* leave a slot for each token, filled in on demand */
+    if (tl->num) {
+        av_fill(tl->tokens, tl->num - 1);
+    }
+    return consumed;
+}
+
+/*
+    The work of st_tokenize_buf() on the str_len bytes of tl->buf at buf.
+    With a scan_mode other than ST_SCAN_NONE this makes no calls into
+    perl, as long as the heat seeker is NULL or a TermSet and st->debug
+    is off, so it is safe to run outside the interpreter's thread.
+*/
+static STRLEN
+st_tokenize_bytes( st_tokenizer *st, st_token_list *tl, const char *buf, STRLEN str_len, U8 scan_mode, boolean final ) {
+/* declare */
+    REGEXP          *rx;
+#if (PERL_VERSION > 10)
+    regexp          *r;
 #endif
+    const char      *str_start, *str_end;
+    const char      *prev_end;
+    const char      *start_ptr, *end_ptr;
+    const char      *pending_start, *pending_end;
+    I32              match_num;
 
-    if (ST_DEBUG > 1)
-        warn("%s: %s is utf8 u8len %d\n", FUNCTION__, ptr, u8len);
+/* initialize */
+    rx              = st->rx;
+#if (PERL_VERSION > 10)
+    r               = (regexp*)SvANY(rx);
+#endif
+    match_num       = st->match_num;
+    str_start       = buf;
+    str_end         = str_start + str_len;
+    prev_end        = str_start;
+    pending_start   = NULL;
+    pending_end     = NULL;
+    /* positions are relative to this list */
+    st->prev_sentence_start = 0;
     
-    u32pt = st_utf8_codepoint(ptr, u8len);
+    if (st->debug) {    
+        warn("tokenizing string %ld bytes long\n", str_len);
+    }
+    
+    while (1) {
+        if (scan_mode) {
+            /* the default re, without the regex engine */
+            if (!st_scan_word((U8*)buf, (U8*)str_end, scan_mode,
+                              (const U8**)&start_ptr, (const U8**)&end_ptr))
+                break;
+        }
+        else {
+            dTHX;
+            if (!pregexec(rx, (char*)buf, (char*)str_end, (char*)buf, 1, tl->buf, 1))
+                break;
         
-    if (ST_DEBUG > 1)
-        warn("%s: u32 code point %d\n", FUNCTION__, u32pt);
+#if ((PERL_VERSION == 10) || (PERL_VERSION == 9 && PERL_SUBVERSION >= 5))
+            start_ptr = buf + rx->offs[match_num].start;
+            end_ptr   = buf + rx->offs[match_num].end;
+#elif (PERL_VERSION > 10)
+            start_ptr = buf + r->offs[match_num].start;
+            end_ptr   = buf + r->offs[match_num].end;
+#else
+            start_ptr = buf + rx->startp[match_num];
+            end_ptr   = buf + rx->endp[match_num];
+#endif
+        }
+
+        /* advance the pointers */
+        buf = (char*)end_ptr;
         
-    if (iswupper((wint_t)u32pt)) {
-        return 1;
+        /* a match is complete once the next one is found */
+        if (pending_start != NULL) {
+            if (pending_start > prev_end) {
+                st_tokenize_gap(st, tl, prev_end, pending_start - prev_end);
+            }
+            st_tokenize_match(st, tl, pending_start, pending_end - pending_start);
+            prev_end = pending_end;
+        }
+        pending_start = start_ptr;
+        pending_end   = end_ptr;
     }
-    if (u32pt == 191) { /* INVERTED QUESTION MARK */
-        return 1;
+    
+    if (final) {
+        if (pending_start != NULL) {
+            if (pending_start > prev_end) {
+                st_tokenize_gap(st, tl, prev_end, pending_start - prev_end);
+            }
+            st_tokenize_match(st, tl, pending_start, pending_end - pending_start);
+            prev_end = pending_end;
+        }
+        if (prev_end != str_end) {
+            st_tokenize_tail(st, tl, prev_end, str_end - prev_end);
+        }
+        prev_end = str_end;
     }
-        
-    /* TODO more here? */
+    else if (str_end - prev_end > ST_STREAM_MAX_CARRY) {
+        /* do not let the carry grow without bound. More input could
+         * extend a last match that runs to str_end, so keep just that;
+         * anything else is done. */
+        if (pending_start != NULL) {
+            if (pending_start > prev_end) {
+                st_tokenize_gap(st, tl, prev_end, pending_start - prev_end);
+            }
+            prev_end = pending_start;
+            if (pending_end != str_end) {
+                st_tokenize_match(st, tl, pending_start, pending_end - pending_start);
+                prev_end = pending_end;
+            }
+        }
+        if (pending_start == NULL || pending_end != str_end) {
+            if (prev_end != str_end) {
+                st_tokenize_gap(st, tl, prev_end, str_end - prev_end);
+            }
+            prev_end = str_end;
+        }
+    }
+    return prev_end - str_start;
+}
+
+static SV*
+st_tokenize( SV* str, SV* token_re, SV* heat_seeker, I32 match_num, st_abbrevs *abbrevs ) {
+    dTHX;
     
-    return 0;
+    st_tokenizer     st;
+    st_token_list   *tl;
+    
+    st_init_tokenizer(&st, token_re, heat_seeker, match_num, abbrevs);
+    tl              = st_new_token_list();
+    /* one copy (copy-on-write where perl can) shared by all the tokens */
+    tl->buf         = newSVsv(str);
+    st_tokenize_buf(&st, tl, 1);
+    return st_bless_ptr(ST_CLASS_TOKENLIST, tl);
+}
 
+/*
+    Tokenize each str in docs with the same tokenizer state, resolved
+    once, returning a mortal AV of TokenLists in the same order.
+*/
+static AV*
+st_tokenize_batch( AV* docs, SV* token_re, SV* heat_seeker, I32 match_num, st_abbrevs *abbrevs ) {
+    dTHX;
+    
+    st_tokenizer     st;
+    st_token_list   *tl;
+    AV              *lists;
+    SV             **doc;
+    SV              *str;
+    I32              i, num_docs;
+    
+    num_docs = av_len(docs) + 1;
+    /* mortal, so a croak from a heat_seeker or a bad doc does not leak it */
+    lists = (AV*)sv_2mortal((SV*)newAV());
+    if (num_docs) {
+        av_extend(lists, num_docs - 1);
+    }
+    st_init_tokenizer(&st, token_re, heat_seeker, match_num, abbrevs);
+    for (i = 0; i < num_docs; i++) {
+        doc = av_fetch(docs, i, 0);
+        str = doc != NULL ? *doc : &PL_sv_undef;
+        st_tokenize_check_utf8(str);
+        st_reset_tokenizer(&st);
+        tl          = st_new_token_list();
+        tl->buf     = newSVsv(str);
+        st_tokenize_buf(&st, tl, 1);
+        av_push(lists, st_bless_ptr(ST_CLASS_TOKENLIST, tl));
+    }
+    return lists;
 }
 
-/* does any char in the string look like a sentence ending? */
-static IV
-st_looks_like_sentence_end(const unsigned char *ptr, IV len) 
-{
+/*
+    The byte ranges of buf within size / 2 of each of the (ascending)
+    byte offsets, as get_offsets() returns them, as start, end pairs.
+    Ranges that overlap are merged, and a window as big as buf takes
+    all of it, offsets or not. Sets *num to the number of ranges.
+*/
+static STRLEN*
+st_merge_windows( const U8 *buf, STRLEN len, AV *offsets, IV size, I32 *num ) {
     dTHX;
     
-    IV i;
-    IV num_dots = 0;
+    STRLEN          *windows, start, end, next_start, next_end;
+    IV               half, pos;
+    I32              i, num_offsets;
     
-    /* right now this assumes ASCII sentence punctuation.
-     * if we ever wanted utf8 support we'd need to iterate
-     * per-character instead of per byte.
-     */
+    num_offsets = av_len(offsets) + 1;
+    windows     = st_malloc(sizeof(STRLEN) * 2 * (num_offsets + 1));
+    *num        = 0;
+    if (size >= (IV)len) {
+        windows[0] = 0;
+        windows[1] = len;
+        *num       = 1;
+        return windows;
+    }
+    half = size > 0 ? size / 2 : 0;
     
-    if (ST_DEBUG > 1)
-        warn("%s: %s\n", FUNCTION__, ptr);
-                    
-    for (i=0; i<len; i++) {
-        switch (ptr[i]) {
-            case '.':
-                /* if abbrev like e.g. U.S.A. then check before and after */
-                num_dots++;
-                break;
-            
-            case '?':
-                return 1;
-                break;
-            
-            case '!':
-                return 1;
+    i = 0;
+    while (i < num_offsets) {
+        pos   = st_av_fetch_iv(offsets, i++);
+        start = pos > half ? (STRLEN)(pos - half) : 0;
+        end   = pos + half < (IV)len ? (STRLEN)(pos + half) : len;
+        if (start >= len) {
+            break;
+        }
+        while (i < num_offsets) {
+            pos        = st_av_fetch_iv(offsets, i);
+            next_start = pos > half ? (STRLEN)(pos - half) : 0;
+            next_end   = pos + half < (IV)len ? (STRLEN)(pos + half) : len;
+            if (next_start > end) {
                 break;
-                                
-            default:
-                continue;
-                
+            }
+            if (next_end > end) {
+                end = next_end;
+            }
+            i++;
+        }
+        
+        /* never split a UTF-8 char */
+        while (start > 0 && UTF8_IS_CONTINUATION(buf[start])) {
+            start--;
         }
+        while (end < len && UTF8_IS_CONTINUATION(buf[end])) {
+            end++;
+        }
+        windows[2 * *num]     = start;
+        windows[2 * *num + 1] = end;
+        (*num)++;
     }
-    if (num_dots > 1 && num_dots < len) {
-        return 0;
+    return windows;
+}
+
+/* 
+    Tokenize the num_windows ranges of tl->buf in windows, in order,
+    into tl. Like st_tokenize_bytes() it is safe to run outside perl.
+*/
+static void
+st_tokenize_window_bytes( st_tokenizer *st, st_token_list *tl, const STRLEN *windows, I32 num_windows, U8 scan_mode ) {
+    I32 i;
+    
+    for (i = 0; i < num_windows; i++) {
+        /* each window starts a new run of sentences */
+        st_reset_tokenizer(st);
+        st_tokenize_bytes(st, tl, SvPVX(tl->buf) + windows[2 * i], 
+            windows[2 * i + 1] - windows[2 * i], scan_mode, 1);
     }
-    else if (num_dots == 1) {
-        return 1;
+}
+
+/*
+    Tokenize only the windows of str around offsets (see
+    st_merge_windows()). The TokenList shares str's buffer, 
+    so the token offsets are true document positions.
+*/
+static SV*
+st_tokenize_windows( SV* str, AV* offsets, IV size, SV* token_re, SV* heat_seeker, I32 match_num, st_abbrevs *abbrevs ) {
+    dTHX;
+    
+    st_tokenizer     st;
+    st_token_list   *tl;
+    const U8        *buf;
+    STRLEN           len, *windows;
+    I32              num_windows;
+    
+    st_init_tokenizer(&st, token_re, heat_seeker, match_num, abbrevs);
+    tl          = st_new_token_list();
+    tl->buf     = newSVsv(str);
+    buf         = (U8*)SvPV(tl->buf, len);
+    windows     = st_merge_windows(buf, len, offsets, size, &num_windows);
+    st_tokenize_window_bytes(&st, tl, windows, num_windows,
+        st_scan_mode(tl->buf, token_re, match_num));
+    free(windows);
+    if (tl->num) {
+        av_fill(tl->tokens, tl->num - 1);
     }
-    return 0;
+    return st_bless_ptr(ST_CLASS_TOKENLIST, tl);
 }
 
-static U8*
-st_string_to_lower(const unsigned char *ptr, IV len)
-{
+/* 
+    test if utf8 flag on and make sure it is.
+    otherwise, regex for \w can fail for multibyte chars.
+    we do a slight (~7%) optimization for ascii str because
+    the regex engine is faster for all-ascii texts.
+    the logic is: 
+     if the flag is on, ok.
+     else, 
+         if the string is ascii, ok for flag to be off,
+         but we don't turn it off. 
+         if the string is NOT ascii, make sure it is utf8
+         and turn the flag on. 
+*/
+static void
+st_tokenize_check_utf8( SV* str ) {
     dTHX;
     
-    U8 *lc, *d;
-    U8 *s = (U8*)ptr;
-    const U8 *const send = s + len;
-    U8 tmpbuf[UTF8_MAXBYTES_CASE+1];
-    lc = st_malloc((UTF8_MAXBYTES_CASE*len)+1);
-    d  = lc;
-    while (s < send) {
-        const STRLEN u = UTF8SKIP(s);
-        STRLEN ulen;
-#if ((PERL_VERSION > 24) || (PERL_VERSION == 26 && PERL_SUBVERSION >= 5))
-        const UV uv = toLOWER_utf8_safe(s, send, tmpbuf, &ulen);
-#else
-        const UV uv = toLOWER_utf8(s, tmpbuf, &ulen);
-#endif
-        Copy(tmpbuf, lc, ulen, U8);
-        lc += ulen;
-        s += u; 
+    U8     *bytes;
+    STRLEN  len;
+    int     flags;
+    
+    if (SvUTF8(str)) {
+        return;
+    }
+    bytes = (U8*)SvPV(str, len);
+    flags = st_classify_buf(bytes, len);
+    if (!(flags & ST_BUF_ASCII)) {
+        if (!(flags & ST_BUF_UTF8)) {
+            croak(ST_BAD_UTF8);
+        }
+        SvUTF8_on(str);
     }
-    *lc = '\0';
-    return d;
 }
 
-static IV
-st_is_abbreviation(const unsigned char *ptr, IV len) 
-{
+/*
+    Streaming: each chunk is appended to the bytes left over from the
+    previous one, and the tokens that can no longer change are returned
+    as a TokenList. A UTF-8 character split across chunks is held back
+    along with the unfinished token. With final set, everything left
+    is tokenized and the stream is reset for a new document.
+*/
+static st_tokenizer*
+st_new_tokenizer( SV *token_re, SV *heat_seeker, I32 match_num, st_abbrevs *abbrevs ) {
     dTHX;
+    
+    st_tokenizer *st;
+    
+    st = st_malloc(sizeof(st_tokenizer));
+    st_init_tokenizer(st, SvREFCNT_inc(token_re), 
+        heat_seeker ? SvREFCNT_inc(heat_seeker) : NULL, match_num, abbrevs);
+    st->carry = newSVpvn("", 0);
+    return st;
+}
 
-    IV i;
-    unsigned char *ptr_lc;
+static void
+st_free_tokenizer( st_tokenizer *st ) {
+    dTHX;
+    
+    SvREFCNT_dec(st->token_re);
+    if (st->heat_seeker != NULL) {
+        SvREFCNT_dec(st->heat_seeker);
+    }
+    SvREFCNT_dec(st->carry);
+    free(st);
+}
 
-    /* only consider strings of abbreviation-like length */
-    if (len < 2 || len > 5) {
-        return 0;
+static SV*
+st_tokenizer_push( st_tokenizer *st, SV *chunk, boolean final ) {
+    dTHX;
+    
+    st_token_list   *tl;
+    SV              *buf;
+    U8              *bytes, *chunk_bytes;
+    STRLEN           len, chunk_len, use_len, bad, consumed;
+    
+    buf = newSVpvn(SvPVX(st->carry), SvCUR(st->carry));
+    if (chunk != NULL) {
+        chunk_bytes = (U8*)SvPV(chunk, chunk_len);
+        sv_catpvn(buf, (char*)chunk_bytes, chunk_len);
     }
+    bytes = (U8*)SvPV(buf, len);
     
-    if (ST_ABBREVS == NULL) {
-        //warn("ST_ABBREVS not yet built\n");
-        i = 0;
-        ST_ABBREVS = newHV();
-        while(en_abbrevs[i] != NULL) {
-            st_hv_store_int( ST_ABBREVS, en_abbrevs[i], i);
-            i++;
+    /* a multi-byte character cut off by the end of the chunk */
+    use_len = len;
+    bad     = st_find_bad_utf8_offset(bytes, len);
+    if (bad != len) {
+        STRLEN i;
+        boolean partial = !final && bytes[bad] >= 0xc2 && UTF8SKIP(bytes + bad) > len - bad;
+        for (i = bad + 1; partial && i < len; i++) {
+            if ((bytes[i] & 0xc0) != 0x80) {
+                partial = 0;
+            }
+        }
+        if (!partial) {
+            SvREFCNT_dec(buf);
+            croak(ST_BAD_UTF8);
         }
+        use_len = bad;
     }
-    ptr_lc = (unsigned char*)st_string_to_lower(ptr, len);
-    //warn("ptr=%s ptr_lc=%s\n", ptr, ptr_lc);
-    i = hv_fetch(ST_ABBREVS, (const char *)ptr_lc, len, 0) ? 1 : 0;
-    free(ptr_lc);
-    return i;
+    
+    SvCUR_set(buf, use_len);
+    if (st_find_non_ascii(bytes, use_len) != use_len) {
+        SvUTF8_on(buf);
+    }
+    tl       = st_new_token_list();
+    tl->buf  = buf;
+    consumed = st_tokenize_buf(st, tl, final);
+    
+    /* keep what is left over, including any held back bytes */
+    sv_setpvn(st->carry, (char*)bytes + consumed, len - consumed);
+    st->num += tl->num;
+    if (final) {
+        st_reset_tokenizer(st);
+    }
+    
+    return st_bless_ptr(ST_CLASS_TOKENLIST, tl);
+}
+
+/*
+    HeatMap spans, ported from Search::Tools::HeatMap _no_sentences()
+    and _as_sentences(). See HeatMap.pm for the commentary on the
+    algorithm; the Perl version is still used for TokenListPP.
+    Returns an AV of span hashes ranked by _sort_spans() order,
+    before the phrase checks HeatMap applies afterwards.
+*/
+
+static int
+st_span_cmp( const void *a, const void *b ) {
+    const st_span *x = (const st_span*)a;
+    const st_span *y = (const st_span*)b;
+    
+    if (x->unique != y->unique)
+        return y->unique - x->unique;
+    if (x->proximate != y->proximate)
+        return y->proximate - x->proximate;
+    if (x->heat != y->heat)
+        return y->heat > x->heat ? 1 : -1;
+    return x->pos[0] - y->pos[0];
+}
+
+static IV
+st_av_fetch_iv( AV *a, I32 index ) {
+    dTHX;
+    return SvIV(st_av_fetch(a, index));
+}
+
+/* 
+    Fill in heat, unique and proximate for the positions in span,
+    all of which are already known to exist.
+*/
+static void
+st_score_span( st_token_list *tl, st_span *span ) {
+    I32 i, j, num_hot, idx;
+    U8 **lc;
+    
+    lc = st_malloc(sizeof(U8*) * span->num);
+    num_hot = 0;
+    span->unique    = 0;
+    span->proximate = 1;    /* one for the single hot token */
+    for (i = 0; i < span->num; i++) {
+        idx = span->pos[i];
+        if (!tl->hot[idx]) {
+            continue;
+        }
+        lc[num_hot] = st_string_to_lower((U8*)st_token_list_ptr(tl, idx), tl->len[idx]);
+        for (j = 0; j < num_hot; j++) {
+            if (strEQ((char*)lc[j], (char*)lc[num_hot])) {
+                break;
+            }
+        }
+        if (j == num_hot) {
+            span->unique++;
+        }
+        num_hot++;
+        /* same as HeatMap.pm, $cluster_pos[ $i - 2 ] (so [-1] when $i == 1) */
+        if (i) {
+            I32 prev = i >= 2 ? i - 2 : span->num - 1;
+            if (tl->hot[span->pos[prev]]) {
+                span->proximate++;
+            }
+        }
+    }
+    for (j = 0; j < num_hot; j++) {
+        free(lc[j]);
+    }
+    free(lc);
+}
+
+static SV*
+st_span_str( st_token_list *tl, st_span *span, boolean as_sentences ) {
+    dTHX;
+    
+    SV *str;
+    I32 i;
+    
+    str = newSVpvn("", 0);
+    for (i = 0; i < span->num; i++) {
+        const char *ptr;
+        STRLEN len;
+        
+        ptr = st_token_list_ptr(tl, span->pos[i]);
+        len = tl->len[span->pos[i]];
+        if (as_sentences && i == span->num - 1 && len 
+            && (*ptr == '.' || *ptr == '?' || *ptr == '!')
+        ) {
+            /* s/^([\.\?\!]).*$/$1/ on the final string */
+            const char *nl = memchr(ptr, '\n', len);
+            sv_catpvn(str, ptr, 1);
+            if (nl != NULL) {
+                sv_catpvn(str, nl, len - (nl - ptr));
+            }
+            continue;
+        }
+        sv_catpvn(str, ptr, len);
+    }
+    SvUTF8_on(str);
+    return str;
+}
+
+static SV*
+st_span_to_hv( st_token_list *tl, st_span *span, boolean as_sentences ) {
+    dTHX;
+    
+    HV *hv;
+    AV *pos, *key;
+    I32 i;
+    
+    hv  = newHV();
+    pos = newAV();
+    av_extend(pos, span->num - 1);
+    for (i = 0; i < span->num; i++) {
+        av_push(pos, newSViv(span->pos[i]));
+    }
+    key = newAV();
+    if (as_sentences) {
+        av_push(key, newSViv(span->start));
+        av_push(key, newSViv(span->hot));
+        av_push(key, newSViv(span->end));
+    }
+    else {
+        for (i = 0; i < span->cluster_len; i++) {
+            av_push(key, newSViv(tl->heat[span->cluster + i]));
+        }
+    }
+    
+    hv_store(hv, (as_sentences ? "start_end" : "cluster"), 
+        (as_sentences ? 9 : 7), newRV_noinc((SV*)key), 0);
+    hv_store(hv, "heat", 4, newSViv(span->heat), 0);
+    hv_store(hv, "pos", 3, newRV_noinc((SV*)pos), 0);
+    hv_store(hv, "str", 3, st_span_str(tl, span, as_sentences), 0);
+    hv_store(hv, "unique", 6, newSViv(span->unique), 0);
+    hv_store(hv, "proximate", 9, newSViv(span->proximate), 0);
+    return newRV_noinc((SV*)hv);
+}
+
+static AV*
+st_heat_spans( st_token_list *tl, IV window, boolean as_sentences ) {
+    dTHX;
+    
+    st_span *spans;
+    I32 num_spans, i;
+    AV *ranked;
+    
+    ranked = newAV();
+    spans  = st_rank_spans(tl, window, as_sentences, &num_spans);
+    for (i = 0; i < num_spans; i++) {
+        av_push(ranked, st_span_to_hv(tl, &spans[i], as_sentences));
+    }
+    st_free_spans(spans, num_spans);
+    return ranked;
+}
+
+static void
+st_free_spans( st_span *spans, I32 num_spans ) {
+    I32 i;
+    
+    for (i = 0; i < num_spans; i++) {
+        free(spans[i].pos);
+    }
+    free(spans);
+}
+
+/*
+    The spans for st_heat_spans(), ranked, as a malloc'd array of
+    num_spans (NULL if none). Makes no calls into perl. In a
+    st_snip_batch_work() worker the buffers are kept in the worker's
+    rank, so they can be freed if st_malloc() jumps out of here.
+*/
+static st_span*
+st_rank_spans( st_token_list *tl, IV window, boolean as_sentences, I32 *num_spans_ptr ) {
+    I32 num_heat, num_spans, i, j, k, n;
+    I32 *positions, *heat_pos, *sen_starts;
+    U8 *seen;
+    st_span *spans;
+    st_snip_worker *worker;
+    st_rank_buffers local, *b;
+    
+    num_heat  = tl->num_hot;
+    *num_spans_ptr = 0;
+    if (!num_heat || !tl->num) {
+        return NULL;
+    }
+    worker    = st_get_snip_worker();
+    b         = worker != NULL ? &worker->rank : &local;
+    Zero(b, 1, st_rank_buffers);
+    heat_pos  = tl->heat;
+    sen_starts = tl->sentence_starts;
+    b->seen   = seen = st_malloc(tl->num);
+    Zero(seen, tl->num, U8);
+    b->positions = positions = st_malloc(sizeof(I32) * tl->num);
+    b->spans  = spans = st_malloc(sizeof(st_span) * num_heat);
+    num_spans = 0;
+    
+    if (as_sentences) {
+        IV cached_start = -1, cached_end = -1;
+        
+        for (i = 0; i < num_heat; i++) {
+            IV token_pos = heat_pos[i];
+            IV start     = sen_starts[i];
+            IV end, max_end, pos;
+            IV heat;
+            boolean has_hot;
+            
+            if (start == cached_start) {
+                end = cached_end;
+            }
+            else {
+                if (i + 1 < num_heat 
+                    && sen_starts[i + 1] != start
+                ) {
+                    max_end = sen_starts[i + 1] - 1;
+                }
+                else {
+                    max_end = tl->num - 1;
+                }
+                end = start;
+                while (end < max_end) {
+                    if (ST_TOKEN_FLAG(tl, end, ST_TOKEN_SENTENCE_END)) {
+                        break;
+                    }
+                    end++;
+                }
+                if (end > tl->num) {
+                    end = tl->num;
+                }
+                if (end < token_pos) {
+                    end = token_pos;
+                }
+                cached_start = start;
+                cached_end   = end;
+            }
+            
+            /* get full window, ignoring positions we've already seen. */
+            n       = 0;
+            heat    = 0;
+            has_hot = 0;
+            for (pos = start; pos <= end && pos < tl->num; pos++) {
+                I32 is_hot;
+                if (seen[pos]++) {
+                    continue;
+                }
+                is_hot   = tl->hot[pos];
+                heat    += is_hot;
+                has_hot |= (is_hot != 0);
+                positions[n++] = pos;
+            }
+            if (!has_hot) {
+                continue;
+            }
+            
+            spans[num_spans].start = start;
+            spans[num_spans].hot   = token_pos;
+            spans[num_spans].end   = end;
+            spans[num_spans].heat  = heat;
+            spans[num_spans].num  = n;
+            spans[num_spans].pos  = st_malloc(sizeof(I32) * n);
+            Copy(positions, spans[num_spans].pos, n, I32);
+            b->num_spans = ++num_spans;
+        }
+    }
+    else {
+        IV lhs_window = window / 2;
+        IV proximity  = lhs_window / 2 + 1;
+        IV max_index  = tl->num - 1;
+        I32 *cluster_start, *cluster_len, *order;
+        I32 num_clusters;
+        
+        b->cluster_start = cluster_start = st_malloc(sizeof(I32) * num_heat);
+        b->cluster_len   = cluster_len   = st_malloc(sizeof(I32) * num_heat);
+        b->order         = order         = st_malloc(sizeof(I32) * num_heat);
+        
+        /* make clusters of positions no more than proximity apart */
+        num_clusters = 0;
+        for (i = 0; i < num_heat; i++) {
+            if (i == 0 || heat_pos[i] - heat_pos[i - 1] > proximity) {
+                cluster_start[num_clusters] = i;
+                cluster_len[num_clusters]   = 0;
+                num_clusters++;
+            }
+            cluster_len[num_clusters - 1]++;
+        }
+        
+        /* biggest, then hottest first position, then earliest */
+        for (i = 0; i < num_clusters; i++) {
+            order[i] = i;
+        }
+        for (i = 1; i < num_clusters; i++) {
+            I32 c = order[i];
+            for (j = i; j > 0; j--) {
+                I32 p = order[j - 1];
+                I32 hot_c = tl->hot[heat_pos[cluster_start[c]]];
+                I32 hot_p = tl->hot[heat_pos[cluster_start[p]]];
+                if (cluster_len[p] > cluster_len[c]
+                    || (cluster_len[p] == cluster_len[c] && hot_p >= hot_c)
+                ) {
+                    break;
+                }
+                order[j] = p;
+            }
+            order[j] = c;
+        }
+        
+        for (k = 0; k < num_clusters; k++) {
+            I32 c = order[k];
+            I32 first, last;
+            IV heat;
+            
+            n    = 0;
+            heat = 0;
+            for (i = cluster_start[c]; i < cluster_start[c] + cluster_len[c]; i++) {
+                IV pos = heat_pos[i];
+                IV start, end, pos2;
+                
+                /* same as TokenListUtils get_window() */
+                start = pos > window ? pos - window : 0;
+                end   = pos < max_index - window ? pos + window : max_index;
+                for (pos2 = start; pos2 <= end; pos2++) {
+                    if (seen[pos2]++) {
+                        continue;
+                    }
+                    heat += tl->hot[pos2];
+                    positions[n++] = pos2;
+                }
+            }
+            
+            /* make sure we still start/end on a match */
+            first = 0;
+            last  = n - 1;
+            while (first <= last && !ST_TOKEN_FLAG(tl, positions[first], ST_TOKEN_MATCH)) {
+                first++;
+            }
+            while (last >= first && !ST_TOKEN_FLAG(tl, positions[last], ST_TOKEN_MATCH)) {
+                last--;
+            }
+            for (i = first; i <= last; i++) {
+                if (tl->hot[positions[i]])
+                    break;
+            }
+            if (i > last) {
+                continue;
+            }
+            
+            spans[num_spans].cluster     = cluster_start[c];
+            spans[num_spans].cluster_len = cluster_len[c];
+            spans[num_spans].heat = heat;
+            spans[num_spans].num  = last - first + 1;
+            spans[num_spans].pos  = st_malloc(sizeof(I32) * spans[num_spans].num);
+            Copy(positions + first, spans[num_spans].pos, spans[num_spans].num, I32);
+            b->num_spans = ++num_spans;
+        }
+        
+        free(cluster_start);
+        free(cluster_len);
+        free(order);
+        b->cluster_start = b->cluster_len = b->order = NULL;
+    }
+    
+    for (i = 0; i < num_spans; i++) {
+        st_score_span(tl, &spans[i]);
+    }
+    qsort(spans, num_spans, sizeof(st_span), st_span_cmp);
+    
+    free(positions);
+    free(seen);
+    Zero(b, 1, st_rank_buffers);
+    if (!num_spans) {
+        free(spans);
+        return NULL;
+    }
+    *num_spans_ptr = num_spans;
+    return spans;
+}
+
+static void
+st_free_rank_buffers( st_rank_buffers *b ) {
+    if (b->seen != NULL) {
+        free(b->seen);
+    }
+    if (b->positions != NULL) {
+        free(b->positions);
+    }
+    if (b->spans != NULL) {
+        st_free_spans(b->spans, b->num_spans);
+    }
+    if (b->cluster_start != NULL) {
+        free(b->cluster_start);
+    }
+    if (b->cluster_len != NULL) {
+        free(b->cluster_len);
+    }
+    if (b->order != NULL) {
+        free(b->order);
+    }
+    Zero(b, 1, st_rank_buffers);
+}
+
+/*
+    Snip spans for each str in docs, on num_threads threads. Each
+    worker tokenizes with term_set as the heat seeker and ranks the
+    spans. If offsets holds an array ref of byte offsets for a doc,
+    only the windows of size bytes around them are tokenized (see
+    st_merge_windows()). Workers touch only C structs made here
+    beforehand, so no perl API is called off the main thread. token_re must be one 
+    st_scan_word() can match. Returns a mortal AV with, for each doc,
+    undef if it has no spans, else an array ref of up to max_spans 
+    (0 for all) span strings, ranked as st_heat_spans() ranks them.
+*/
+static AV*
+st_snip_batch( AV* docs, AV* offsets, IV size, SV* token_re, SV* term_set, st_abbrevs *abbrevs, IV window, boolean as_sentences, I32 max_spans, I32 num_threads ) {
+    dTHX;
+    
+    st_tokenizer     st;
+    st_snip_pool     pool;
+    st_snip_job     *jobs;
+    AV              *results;
+    SV             **doc, **doc_offsets;
+    SV              *str;
+    I32              i, j, num_docs;
+    STRLEN           len;
+    const char      *bytes;
+    
+    if (!sv_isobject(term_set) || !sv_derived_from(term_set, ST_CLASS_TERMSET)) {
+        croak("term_set must be a %s object", ST_CLASS_TERMSET);
+    }
+    if (st_scan_mode(&PL_sv_no, token_re, 0) == ST_SCAN_NONE) {
+        croak("Tokenizer re %" SVf " cannot be used outside perl", 
+            SVfARG(token_re));
+    }
+    num_docs = av_len(docs) + 1;
+    results  = (AV*)sv_2mortal((SV*)newAV());
+    
+    /* check every doc before anything is allocated, so croak is safe */
+    for (i = 0; i < num_docs; i++) {
+        doc = av_fetch(docs, i, 0);
+        st_tokenize_check_utf8(doc != NULL ? *doc : &PL_sv_undef);
+    }
+    if (!num_docs) {
+        return results;
+    }
+    
+    st_init_uni();
+    st_init_tokenizer(&st, token_re, term_set, 0, abbrevs);
+    st.debug = 0;   /* warn() needs perl */
+    
+    jobs = st_malloc(sizeof(st_snip_job) * num_docs);
+    for (i = 0; i < num_docs; i++) {
+        doc   = av_fetch(docs, i, 0);
+        str   = doc != NULL ? *doc : &PL_sv_undef;
+        bytes = SvOK(str) ? SvPV(str, len) : "";
+        if (!SvOK(str)) {
+            len = 0;
+        }
+        jobs[i].tl          = st_new_token_list();
+        jobs[i].tl->buf     = newSVpvn(bytes, len);
+        if (SvUTF8(str)) {
+            SvUTF8_on(jobs[i].tl->buf);
+        }
+        jobs[i].scan_mode   = st_scan_mode(jobs[i].tl->buf, token_re, 0);
+        jobs[i].windows     = NULL;
+        jobs[i].num_windows = 0;
+        doc_offsets = offsets != NULL ? av_fetch(offsets, i, 0) : NULL;
+        if (doc_offsets != NULL && SvROK(*doc_offsets) 
+            && SvTYPE(SvRV(*doc_offsets)) == SVt_PVAV
+        ) {
+            jobs[i].windows = st_merge_windows((U8*)bytes, len,
+                (AV*)SvRV(*doc_offsets), size, &jobs[i].num_windows);
+        }
+        jobs[i].spans       = NULL;
+        jobs[i].num_spans   = 0;
+    }
+    
+    pool.st             = &st;
+    pool.jobs           = jobs;
+    pool.num_jobs       = num_docs;
+    pool.next           = 0;
+    pool.failed_size    = 0;
+    pool.window         = window;
+    pool.as_sentences   = as_sentences;
+    
+#ifdef ST_HAVE_PTHREAD
+    {
+        pthread_t *workers;
+        I32 started;
+        
+        if (num_threads > num_docs) {
+            num_threads = num_docs;
+        }
+        if (num_threads < 1) {
+            num_threads = 1;
+        }
+        pthread_mutex_init(&pool.lock, NULL);
+        workers = st_malloc(sizeof(pthread_t) * num_threads);
+        /* this thread is a worker too; if a thread can't be made,
+         * the rest just take more of the jobs. 
+         */
+        for (started = 0; started < num_threads - 1; started++) {
+            if (pthread_create(&workers[started], NULL, st_snip_batch_work, &pool)) {
+                break;
+            }
+        }
+        st_snip_batch_work(&pool);
+        for (i = 0; i < started; i++) {
+            pthread_join(workers[i], NULL);
+        }
+        free(workers);
+        pthread_mutex_destroy(&pool.lock);
+    }
+#else
+    st_snip_batch_work(&pool);
+#endif
+    
+    if (pool.failed_size) {
+        st_free_snip_jobs(jobs, num_docs);
+        croak("Out of memory! Can't allocate %lu bytes", 
+            (unsigned long)pool.failed_size);
+    }
+    
+    av_extend(results, num_docs - 1);
+    for (i = 0; i < num_docs; i++) {
+        st_snip_job *job = &jobs[i];
+        I32 num = job->num_spans;
+        
+        if (max_spans > 0 && num > max_spans) {
+            num = max_spans;
+        }
+        if (num) {
+            AV *strs = newAV();
+            av_extend(strs, num - 1);
+            for (j = 0; j < num; j++) {
+                av_push(strs, st_span_str(job->tl, &job->spans[j], as_sentences));
+            }
+            av_push(results, newRV_noinc((SV*)strs));
+        }
+        else {
+            av_push(results, newSV(0));
+        }
+    }
+    st_free_snip_jobs(jobs, num_docs);
+    return results;
+}
+
+static void
+st_free_snip_jobs( st_snip_job *jobs, I32 num_jobs ) {
+    I32 i;
+    
+    for (i = 0; i < num_jobs; i++) {
+        st_free_spans(jobs[i].spans, jobs[i].num_spans);
+        st_token_list_release(jobs[i].tl);
+        if (jobs[i].windows != NULL) {
+            free(jobs[i].windows);
+        }
+    }
+    free(jobs);
+}
+
+/* 
+    Take jobs from the pool until there are none left. Runs outside
+    perl, so nothing in here may croak, warn or touch an SV other than
+    to read tl->buf. If st_malloc() fails, st_out_of_memory() empties
+    the pool and jumps back here. The job's tl owns what the tokenizer
+    allocated, and worker.rank holds what st_rank_spans() had.
+*/
+static void*
+st_snip_batch_work( void *pool_ptr ) {
+    st_snip_pool    *pool = (st_snip_pool*)pool_ptr;
+    st_snip_worker   worker;
+    st_tokenizer     st;
+    st_snip_job     *job;
+    I32              i;
+    
+    st       = *pool->st;
+    st.debug = 0;   /* warn() needs perl */
+    worker.pool = pool;
+    Zero(&worker.rank, 1, st_rank_buffers);
+    if (setjmp(worker.env)) {
+        st_free_rank_buffers(&worker.rank);
+        st_set_snip_worker(NULL);
+        return NULL;
+    }
+    st_set_snip_worker(&worker);
+    while (1) {
+#ifdef ST_HAVE_PTHREAD
+        pthread_mutex_lock(&pool->lock);
+        i = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+#else
+        i = pool->next++;
+#endif
+        if (i >= pool->num_jobs) {
+            break;
+        }
+        job = &pool->jobs[i];
+        if (job->windows != NULL) {
+            st_tokenize_window_bytes(&st, job->tl, job->windows, 
+                job->num_windows, job->scan_mode);
+        }
+        else {
+            st_reset_tokenizer(&st);
+            st_tokenize_bytes(&st, job->tl, SvPVX(job->tl->buf), 
+                SvCUR(job->tl->buf), job->scan_mode, 1);
+        }
+        job->spans = st_rank_spans(job->tl, pool->window, 
+                        pool->as_sentences, &job->num_spans);
+    }
+    st_set_snip_worker(NULL);
+    return NULL;
+}
+
+static SV*
+st_find_bad_utf8( SV* str ) {
+    dTHX;
+    
+    STRLEN len, bad;
+    U8 *bytes;
+
+    bytes = (U8*)SvPV(str, len);
+    bad   = st_find_bad_utf8_offset(bytes, len);
+    if (bad == len) {
+        return &PL_sv_undef;
+    }
+    return newSVpvn((char*)bytes + bad, len - bad);
+}
+
+/* lifted nearly verbatim from mod_perl */
+static SV *st_escape_xml(char *s) {
+    dTHX;
+
+    int i, j;
+    SV *x;
+
+    /* first, count the number of extra characters */
+    for (i = 0, j = 0; s[i] != '\0'; i++)
+        if (s[i] == '<' || s[i] == '>')
+            j += 3;
+        else if (s[i] == '&')
+            j += 4;
+        else if (s[i] == '"' || s[i] == '\'')
+            j += 5;
+
+    if (j == 0)
+        return newSVpv(s,i);
+
+    x = newSV(i + j + 1);
+
+    for (i = 0, j = 0; s[i] != '\0'; i++, j++)
+    if (s[i] == '<') {
+        memcpy(&SvPVX(x)[j], "&lt;", 4);
+        j += 3;
+    }
+    else if (s[i] == '>') {
+        memcpy(&SvPVX(x)[j], "&gt;", 4);
+        j += 3;
+    }
+    else if (s[i] == '&') {
+        memcpy(&SvPVX(x)[j], "&amp;", 5);
+        j += 4;
+    }
+    else if (s[i] == '"') {
+        memcpy(&SvPVX(x)[j], "&quot;", 6);
+        j += 5;
+    }
+    else if (s[i] == '\'') {
+        memcpy(&SvPVX(x)[j], "&#39;", 5);
+        j += 4;
+    }
+    else
+        SvPVX(x)[j] = s[i];
+
+    SvPVX(x)[j] = '\0';
+    SvCUR_set(x, j);
+    SvPOK_on(x);
+    return x;
+}
+
+/*
+    str decoded as to_utf8() does, with tags dropped and entities
+    decoded as XML no_html() does if strip_markup is true, and runs of
+    whitespace made one space as Snipper collapse_whitespace does if
+    collapse_ws is true, all in one pass. Sets *in_chars to the length
+    of the decoded str before any of that, in chars.
+*/
+static SV*
+st_plain_text( SV *str, boolean strip_markup, boolean collapse_ws, STRLEN *in_chars )
+{
+    dTHX;
+    
+    const U8 *p, *end, *gt;
+    U8 *o;
+    STRLEN len, n;
+    boolean utf8, tags, in_ws, is_ws;
+    SV *plain;
+    UV cp;
+    
+    p     = (U8*)SvPV(str, len);
+    end   = p + len;
+    utf8  = SvUTF8(str) || (st_classify_buf(p, len) & ST_BUF_UTF8);
+    
+    /* Latin-1 doubles at most, and no entity decodes to more bytes
+       than it takes (see st_html_entity()) */
+    plain = newSV((utf8 ? len : len * 2) + 1);
+    SvPOK_on(plain);
+    o     = (U8*)SvPVX(plain);
+    tags  = strip_markup;
+    in_ws = 0;
+    *in_chars = 0;
+    
+    while (p < end) {
+    
+        /* a tag is <[^>]+> as in XML tag_re() */
+        if (*p == '<' && tags) {
+            gt = memchr(p + 1, '>', end - p - 1);
+            if (gt == NULL) {
+                tags = 0;   /* and none further on either */
+            }
+            else if (gt > p + 1) {
+                *in_chars += utf8 ? utf8_length(p, gt + 1) : (STRLEN)(gt + 1 - p);
+                p = gt + 1;
+                continue;
+            }
+        }
+        
+        cp = 0;
+        n  = 1;
+        if (*p == '&' && strip_markup) {
+            cp = st_unescape_entity(p, end,
+                    ST_ENT_NAMED | ST_ENT_DECIMAL | ST_ENT_HEX, &n);
+            if (!cp) {
+                n = 1;
+            }
+        }
+        if (cp) {
+            is_ws = cp == 0xa0 || (cp < 0x80 && strchr(" \n\r\t", (char)cp));
+        }
+        else if (*p < 0x80) {
+            is_ws = *p == ' ' || *p == '\n' || *p == '\r' || *p == '\t';
+        }
+        else if (utf8) {
+            n = UTF8SKIP(p);
+            if (n > (STRLEN)(end - p)) {
+                n = end - p;
+            }
+            is_ws = n == 2 && p[0] == 0xc2 && p[1] == 0xa0;
+        }
+        else {
+            cp    = *p;
+            is_ws = cp == 0xa0;
+        }
+        
+        if (is_ws && collapse_ws) {
+            if (!in_ws) {
+                *o++ = ' ';
+            }
+            in_ws = 1;
+        }
+        else {
+            if (cp) {
+                o = uvchr_to_utf8(o, cp);
+            }
+            else {
+                Copy(p, o, n, U8);
+                o += n;
+            }
+            in_ws = 0;
+        }
+        *in_chars += *p == '&' ? n : 1;
+        p += n;
+    }
+    
+    *o = '\0';
+    SvCUR_set(plain, o - (U8*)SvPVX(plain));
+    SvUTF8_on(plain);
+    return plain;
+}
+
+/* returns the UCS32 value for a UTF8 string -- the character's Unicode value.
+   see http://scripts.sil.org/cms/scripts/page.php?site_id=nrsi&item_id=IWS-AppendixA
+*/
+static IV
+st_utf8_codepoint(
+    const unsigned char *utf8,
+    IV len
+)
+{
+    switch (len) {
+
+    case 1:
+        return utf8[0];
+
+    case 2:
+        return (utf8[0] - 192) * 64 + utf8[1] - 128;
+
+    case 3:
+        return (utf8[0] - 224) * 4096 + (utf8[1] - 128) * 64 + utf8[2] - 128;
+
+    case 4:
+    default:
+        return (utf8[0] - 240) * 262144 + (utf8[1] - 128) * 4096 + (utf8[2] - 128) * 64 +
+            utf8[3] - 128;
+
+    }
+}
+
+static IV
+st_looks_like_sentence_start(const unsigned char *ptr, IV len) 
+{
+    I32 u8len, u32pt;
+    
+    /* optimized for ASCII */
+    if (st_char_is_ascii((unsigned char*)ptr, len)) {
+        
+        /* if the string is more than one byte long,
+           make sure the second char is NOT UPPER
+           since that is likely a false positive.
+        */
+        if (len > 1) {
+            if (isUPPER(ptr[0]) && !isUPPER(ptr[1])) {
+                return 1;
+            }
+            else {
+                return 0;
+            }
+        }
+        else {
+            return isUPPER(ptr[0]);
+        }
+    }
+    
+    if (!len) {
+        return 0;
+    }
+    
+    /* TODO if any char is UPPER in the string, consider it a start? */
+    
+    /* get first full UTF-8 char */
+#if (PERL_VERSION >= 16)
+    //warn("WE HAVE utf8_char_buf\n");
+    u8len = is_utf8_char_buf((const U8*)ptr, (const U8*)ptr+UTF8SKIP(ptr));
+#else
+    //warn("WE HAVE utf8_char\n");
+    u8len = is_utf8_char((U8*)ptr);
+#endif
+
+    /* no ST_DEBUG here: st_snip_batch() calls this outside perl */
+    u32pt = st_utf8_codepoint(ptr, u8len);
+        
+    if (iswupper((wint_t)u32pt)) {
+        return 1;
+    }
+    if (u32pt == 191) { /* INVERTED QUESTION MARK */
+        return 1;
+    }
+        
+    /* TODO more here? */
+    
+    return 0;
+
+}
+
+/* does any char in the string look like a sentence ending? */
+static IV
+st_looks_like_sentence_end(const unsigned char *ptr, IV len) 
+{
+    IV i;
+    IV num_dots = 0;
+    
+    /* right now this assumes ASCII sentence punctuation.
+     * if we ever wanted utf8 support we'd need to iterate
+     * per-character instead of per byte.
+     */
+    
+    for (i=0; i<len; i++) {
+        switch (ptr[i]) {
+            case '.':
+                /* if abbrev like e.g. U.S.A. then check before and after */
+                num_dots++;
+                break;
+            
+            case '?':
+                return 1;
+                break;
+            
+            case '!':
+                return 1;
+                break;
+                                
+            default:
+                continue;
+                
+        }
+    }
+    if (num_dots > 1 && num_dots < len) {
+        return 0;
+    }
+    else if (num_dots == 1) {
+        return 1;
+    }
+    return 0;
+}
+
+static U8*
+st_string_to_lower(const unsigned char *ptr, IV len)
+{
+    U8 *lc, *d;
+    U8 *s = (U8*)ptr;
+    const U8 *const send = s + len;
+    lc = st_malloc((UTF8_MAXBYTES_CASE*len)+1);
+    d  = lc;
+    while (s < send) {
+        const STRLEN u = UTF8SKIP(s);
+        if (ST_UNI != NULL) {
+            if (UTF8_IS_INVARIANT(*s)) {
+                *lc++ = toLOWER(*s);
+            }
+            else {
+                lc += st_uni_case(ST_UNI->lower, ST_UNI->num_lower, s, u, lc);
+            }
+        }
+        else {
+            dTHX;
+            U8 tmpbuf[UTF8_MAXBYTES_CASE+1];
+            STRLEN ulen;
+#if ((PERL_VERSION > 24) || (PERL_VERSION == 26 && PERL_SUBVERSION >= 5))
+            toLOWER_utf8_safe(s, send, tmpbuf, &ulen);
+#else
+            toLOWER_utf8(s, tmpbuf, &ulen);
+#endif
+            Copy(tmpbuf, lc, ulen, U8);
+            lc += ulen;
+        }
+        s += u; 
+    }
+    *lc = '\0';
+    return d;
+}
+
+/* abbreviation registry, newest first. Built at boot from
+ * st_builtin_abbrevs[] and extended by Tokenizer->add_abbreviations().
+ * Sets are never freed: a TokenStream may hold one indefinitely.
+ */
+static st_abbrevs *ST_ABBREV_SETS = NULL;
+
+static int
+st_abbrev_cmp( const void *a, const void *b )
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* new, unregistered set with room for size words besides those in base */
+static st_abbrevs*
+st_new_abbrevs( const char *lang, STRLEN len, st_abbrevs *base, IV size )
+{
+    dTHX;
+    
+    st_abbrevs *ab;
+    
+    if (len == 0 || len > ST_MAX_LANG_LEN) {
+        ST_CROAK("Invalid lang '%.*s'", (int)len, lang);
+    }
+    ab = st_malloc(sizeof(st_abbrevs));
+    Copy(lang, ab->lang, len, char);
+    ab->lang[len] = '\0';
+    ab->num       = 0;
+    ab->min_len   = ST_MAX_ABBREV_BYTES;
+    ab->max_len   = 0;
+    ab->has_utf8  = 0;
+    ab->next      = NULL;
+    if (base != NULL) {
+        size += base->num;
+    }
+    ab->words = st_malloc(sizeof(char*) * (size + 1));
+    if (base != NULL) {
+        /* words are never freed, so they can be shared */
+        Copy(base->words, ab->words, base->num, char*);
+        ab->num      = base->num;
+        ab->min_len  = base->min_len;
+        ab->max_len  = base->max_len;
+        ab->has_utf8 = base->has_utf8;
+    }
+    return ab;
+}
+
+/* fold len bytes of UTF-8 at ptr into buf, ignoring a trailing '.',
+ * and return the folded length, 0 for an empty word. Croaks if the
+ * word is too long, before anything is allocated for it. */
+static STRLEN
+st_abbrev_fold( const U8 *ptr, STRLEN len, U8 *buf )
+{
+    dTHX;
+    
+    STRLEN flen;
+    
+    if (len && ptr[len-1] == '.') {
+        len--;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    if (len > ST_MAX_ABBREV_BYTES
+        ||
+        (flen = st_fold_utf8(ptr, len, buf)) > ST_MAX_ABBREV_BYTES
+    ) {
+        ST_CROAK("abbreviation '%.*s' is longer than %d bytes", 
+            (int)len, ptr, ST_MAX_ABBREV_BYTES);
+    }
+    return flen;
+}
+
+/* add len bytes of UTF-8 at ptr, ignoring a trailing '.' */
+static void
+st_abbrevs_add( st_abbrevs *ab, const U8 *ptr, STRLEN len )
+{
+    U8 buf[(ST_MAX_ABBREV_BYTES*UTF8_MAXBYTES_CASE)+1];
+    STRLEN flen, i;
+    char *word;
+    
+    flen = st_abbrev_fold(ptr, len, buf);
+    if (flen == 0) {
+        return;
+    }
+    word = st_malloc(flen + 1);
+    Copy(buf, word, flen + 1, U8);
+    ab->words[ab->num++] = word;
+    if (flen < ab->min_len) {
+        ab->min_len = flen;
+    }
+    if (flen > ab->max_len) {
+        ab->max_len = flen;
+    }
+    for (i = 0; i < flen; i++) {
+        if (!isASCII(buf[i])) {
+            ab->has_utf8 = 1;
+            break;
+        }
+    }
+}
+
+/* sort and dedupe the words in ab and make it the set for its lang */
+static void
+st_abbrevs_register( st_abbrevs *ab )
+{
+    IV i, n;
+    
+    qsort(ab->words, ab->num, sizeof(char*), st_abbrev_cmp);
+    n = 0;
+    for (i = 0; i < ab->num; i++) {
+        if (n == 0 || strcmp(ab->words[n-1], ab->words[i]) != 0) {
+            ab->words[n++] = ab->words[i];
+        }
+    }
+    ab->num        = n;
+    ab->next       = ST_ABBREV_SETS;
+    ST_ABBREV_SETS = ab;
+}
+
+static void
+st_init_abbrevs()
+{
+    st_abbrevs *ab;
+    IV i, n;
+    
+    for (i = 0; st_builtin_abbrevs[i].lang != NULL; i++) {
+        for (n = 0; st_builtin_abbrevs[i].words[n] != NULL; n++) { }
+        ab = st_new_abbrevs(st_builtin_abbrevs[i].lang, 
+                strlen(st_builtin_abbrevs[i].lang), NULL, n);
+        for (n = 0; st_builtin_abbrevs[i].words[n] != NULL; n++) {
+            st_abbrevs_add(ab, (const U8*)st_builtin_abbrevs[i].words[n], 
+                strlen(st_builtin_abbrevs[i].words[n]));
+        }
+        st_abbrevs_register(ab);
+    }
+}
+
+static st_abbrevs*
+st_find_abbrevs( const char *lang, STRLEN len )
+{
+    st_abbrevs *ab;
+    
+    for (ab = ST_ABBREV_SETS; ab != NULL; ab = ab->next) {
+        if (strlen(ab->lang) == len && foldEQ(ab->lang, lang, len)) {
+            return ab;
+        }
+    }
+    return NULL;
+}
+
+/* the set for a Tokenizer lang. A locale like de_DE or de-AT falls back
+ * to its language, and a language without a set falls back to English.
+ */
+static st_abbrevs*
+st_lang_abbrevs( SV *lang )
+{
+    dTHX;
+    
+    st_abbrevs *ab = NULL;
+    const char *str;
+    STRLEN len, i;
+    
+    if (lang != NULL && SvOK(lang)) {
+        str = SvPV(lang, len);
+        ab  = st_find_abbrevs(str, len);
+        for (i = 0; ab == NULL && i < len; i++) {
+            if (str[i] == '_' || str[i] == '-' || str[i] == '.') {
+                ab = st_find_abbrevs(str, i);
+                break;
+            }
+        }
+    }
+    if (ab == NULL) {
+        ab = st_find_abbrevs("en", 2);
+    }
+    return ab;
+}
+
+static IV
+st_is_abbreviation( st_abbrevs *ab, const unsigned char *ptr, IV len ) 
+{
+    U8 buf[(ST_MAX_ABBREV_BYTES*UTF8_MAXBYTES_CASE)+1];
+    STRLEN flen;
+    IV i, lo, hi, mid;
+    int cmp;
+
+    /* only consider strings of abbreviation-like length */
+    if (len < (IV)ab->min_len || len > ST_MAX_ABBREV_BYTES) {
+        return 0;
+    }
+    
+    /* fold on the stack. Most tokens are ASCII, and folding
+     * cannot change their length.
+     */
+    for (i = 0; i < len; i++) {
+        if (!isASCII(ptr[i])) {
+            break;
+        }
+        buf[i] = toLOWER(ptr[i]);
+    }
+    if (i == len) {
+        if (len > (IV)ab->max_len) {
+            return 0;
+        }
+        buf[len] = '\0';
+    }
+    else {
+        if (!ab->has_utf8) {
+            return 0;
+        }
+        flen = st_fold_utf8(ptr, len, buf);
+        if (flen < ab->min_len || flen > ab->max_len) {
+            return 0;
+        }
+    }
+
+    lo = 0;
+    hi = ab->num - 1;
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        cmp = strcmp((char*)buf, ab->words[mid]);
+        if (cmp == 0) {
+            return 1;
+        }
+        if (cmp < 0) {
+            hi = mid - 1;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    return 0;
+}
+
+/* case fold len bytes of UTF-8 at ptr into buf, which must have room
+ * for UTF8_MAXBYTES_CASE*len+1 bytes (len+1 if ptr is ASCII).
+ * Returns the folded length. Same folding as m//i uses.
+ */
+static STRLEN
+st_fold_utf8(const U8 *ptr, STRLEN len, U8 *buf)
+{
+    U8 *d = buf;
+    const U8 *s = ptr;
+    const U8 *const send = s + len;
+    while (s < send) {
+        if (UTF8_IS_INVARIANT(*s)) {
+            *d++ = toFOLD(*s);
+            s++;
+        }
+        else if (ST_UNI != NULL) {
+            const STRLEN u = UTF8SKIP(s);
+            d += st_uni_case(ST_UNI->fold, ST_UNI->num_fold, s, u, d);
+            s += u;
+        }
+        else {
+            dTHX;
+            const STRLEN u = UTF8SKIP(s);
+            STRLEN ulen;
+#if ((PERL_VERSION > 24) || (PERL_VERSION == 26 && PERL_SUBVERSION >= 5))
+            toFOLD_utf8_safe(s, send, d, &ulen);
+#else
+            toFOLD_utf8((U8*)s, d, &ulen);
+#endif
+            d += ulen;
+            s += u;
+        }
+    }
+    *d = '\0';
+    return d - buf;
+}
+
+/* FNV-1a */
+static U32
+st_hash(const U8 *ptr, STRLEN len)
+{
+    U32 h = 2166136261U;
+    while (len--) {
+        h ^= *ptr++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/* does str match pat, where the wildcard byte matches any run of bytes? */
+static boolean
+st_glob_match(const U8 *pat, STRLEN plen, const U8 *str, STRLEN slen, U8 wildcard)
+{
+    STRLEN p = 0, s = 0, star_p = 0, star_s = 0;
+    boolean have_star = 0;
+    
+    while (s < slen) {
+        if (p < plen && pat[p] == wildcard) {
+            have_star = 1;
+            star_p = ++p;
+            star_s = s;
+        }
+        else if (p < plen && pat[p] == str[s]) {
+            p++;
+            s++;
+        }
+        else if (have_star) {
+            p = star_p;
+            s = ++star_s;
+        }
+        else {
+            return 0;
+        }
+    }
+    while (p < plen && pat[p] == wildcard) {
+        p++;
+    }
+    return p == plen;
+}
+
+static st_term_set*
+st_new_term_set(AV *terms, U8 wildcard)
+{
+    dTHX;
+    
+    st_term_set *ts;
+    I32 i, len, size;
+    STRLEN tlen, start, end;
+    U8 *term;
+    
+    len  = av_len(terms) + 1;
+    size = 16;
+    while (size < len * 4) {
+        size *= 2;
+    }
+    ts = st_malloc(sizeof(st_term_set));
+    ts->table     = st_malloc(sizeof(st_term) * size);
+    Zero(ts->table, size, st_term);
+    ts->size      = size;
+    ts->num       = 0;
+    ts->globs     = NULL;
+    ts->num_globs = 0;
+    ts->wildcard  = wildcard;
+    ts->ref_cnt   = 1;
+    
+    for (i = 0; i < len; i++) {
+        term = (U8*)SvPVutf8(st_av_fetch(terms, i), tlen);
+        
+        /* phrases are treated as their individual words */
+        start = 0;
+        while (start < tlen) {
+            while (start < tlen && term[start] == ' ') {
+                start++;
+            }
+            end = start;
+            while (end < tlen && term[end] != ' ') {
+                end++;
+            }
+            if (end > start) {
+                st_term_set_add(ts, term + start, end - start);
+            }
+            start = end;
+        }
+    }
+    return ts;
+}
+
+static void
+st_term_set_add(st_term_set *ts, const U8 *ptr, STRLEN len)
+{
+    dTHX;
+    
+    st_term term;
+    st_term *old;
+    I32 i, old_size, mask;
+    
+    term.str  = st_malloc((UTF8_MAXBYTES_CASE*len)+1);
+    term.len  = st_fold_utf8(ptr, len, term.str);
+    term.hash = st_hash(term.str, term.len);
+    
+    if (memchr(term.str, ts->wildcard, term.len) != NULL) {
+        ts->globs = st_realloc(ts->globs, sizeof(st_term) * (ts->num_globs + 1));
+        ts->globs[ts->num_globs++] = term;
+        return;
+    }
+    
+    /* keep the table at most half full */
+    if ((ts->num + 1) * 2 > ts->size) {
+        old      = ts->table;
+        old_size = ts->size;
+        ts->table = st_malloc(sizeof(st_term) * old_size * 2);
+        ts->size = old_size * 2;
+        Zero(ts->table, ts->size, st_term);
+        mask = ts->size - 1;
+        for (i = 0; i < old_size; i++) {
+            I32 slot;
+            if (old[i].str == NULL) {
+                continue;
+            }
+            slot = old[i].hash & mask;
+            while (ts->table[slot].str != NULL) {
+                slot = (slot + 1) & mask;
+            }
+            ts->table[slot] = old[i];
+        }
+        free(old);
+    }
+    
+    mask = ts->size - 1;
+    i = term.hash & mask;
+    while (ts->table[i].str != NULL) {
+        if (ts->table[i].hash == term.hash
+            && ts->table[i].len == term.len
+            && memEQ(ts->table[i].str, term.str, term.len)
+        ) {
+            free(term.str); /* duplicate */
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    ts->table[i] = term;
+    ts->num++;
+}
+
+static boolean
+st_term_set_contains(st_term_set *ts, const U8 *ptr, STRLEN len)
+{
+    U8 stack_buf[512];
+    U8 *folded;
+    STRLEN flen, need;
+    U32 hash;
+    I32 i, mask;
+    boolean found;
+    
+    need = st_char_is_ascii((unsigned char*)ptr, len)
+        ? len + 1
+        : (UTF8_MAXBYTES_CASE*len)+1;
+    folded = need > sizeof(stack_buf) ? st_malloc(need) : stack_buf;
+    flen   = st_fold_utf8(ptr, len, folded);
+    hash   = st_hash(folded, flen);
+    found  = 0;
+    
+    mask = ts->size - 1;
+    i = hash & mask;
+    while (ts->table[i].str != NULL) {
+        if (ts->table[i].hash == hash
+            && ts->table[i].len == flen
+            && memEQ(ts->table[i].str, folded, flen)
+        ) {
+            found = 1;
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    for (i = 0; !found && i < ts->num_globs; i++) {
+        found = st_glob_match(ts->globs[i].str, ts->globs[i].len, 
+                              folded, flen, ts->wildcard);
+    }
+    
+    if (folded != stack_buf) {
+        free(folded);
+    }
+    return found;
+}
+
+static void
+st_free_term_set(st_term_set *ts)
+{
+    dTHX;
+    I32 i;
+    
+    if (ts->ref_cnt != 0) {
+        ST_CROAK("Won't free term_set %p with ref_cnt != 0 [%" IVdf "]", 
+            ts, ts->ref_cnt);
+    }
+    for (i = 0; i < ts->size; i++) {
+        if (ts->table[i].str != NULL) {
+            free(ts->table[i].str);
+        }
+    }
+    for (i = 0; i < ts->num_globs; i++) {
+        free(ts->globs[i].str);
+    }
+    free(ts->table);
+    if (ts->globs != NULL) {
+        free(ts->globs);
+    }
+    free(ts);
+}
+
+/* is the byte at p one of the ignore_first_char/ignore_last_char
+ * defaults, which also join the words of a term? */
+#define ST_IS_WORD_SEP(p)   (*(p) == '\'' || *(p) == '-')
+
+/*
+    Search::Tools::TermMatcher
+
+    Decides, in one pass over a text, which query terms the QueryParser
+    plain (or html) regex of each term would match, for the default
+    word_characters \\w'- and ignore_first_char/ignore_last_char '-.
+
+    Those regexes only match a term in a maximal run of [\\w'-] chars
+    ("run") and only along a few boundaries, so each run is folded and
+    looked up once in a hash of all the term words:
+
+     - plain: at most one leading and any trailing ' or - are not
+       part of the word, e.g. "-dog--". A run at the start of the text
+       may not drop a leading ' or -, a run at the end no trailing one.
+     - html: the first word of a term may also start after,
+       and the last word end before, any ' or - in the run.
+     - the words of a phrase are in consecutive runs.
+
+    html with any < or & may match across tags and entities, so there
+    the terms not found are left undef for the caller to try
+    with the term's regex.
+*/
+
+static st_term_matcher*
+st_new_term_matcher(AV *terms, U8 wildcard)
+{
+    dTHX;
+    
+    st_term_matcher *tm;
+    I32 i, j, n, len, size;
+    STRLEN tlen, start, stop, wlen, u;
+    U8 *term, *p, *wend;
+    boolean ok, is_word, is_prefix;
+    
+    len  = av_len(terms) + 1;
+    size = 16;
+    while (size < len * 4) {
+        size *= 2;
+    }
+    tm = st_malloc(sizeof(st_term_matcher));
+    tm->table        = st_malloc(sizeof(st_match_word) * size);
+    Zero(tm->table, size, st_match_word);
+    tm->size         = size;
+    tm->num          = 0;
+    tm->max_len      = 0;
+    tm->prefixes     = NULL;
+    tm->num_prefixes = 0;
+    tm->num_words    = st_malloc(sizeof(I32) * (len ? len : 1));
+    tm->multi_fold   = st_malloc(len ? len : 1);
+    tm->num_terms    = len;
+    tm->ref_cnt      = 1;
+    
+    for (i = 0; i < len; i++) {
+        term = (U8*)SvPVutf8(st_av_fetch(terms, i), tlen);
+        
+        /* every word must start and end with a \w char and hold only
+         * \w, ' and -, or else the term is left to its regex.
+         */
+        n     = 0;
+        ok    = tlen > 0;
+        start = 0;
+        while (ok && start <= tlen) {
+            stop = start;
+            while (stop < tlen && term[stop] != ' ') {
+                stop++;
+            }
+            wlen = stop - start;
+            if (wlen && term[stop - 1] == wildcard) {
+                wlen--;
+            }
+            if (!wlen || ++n > 64) {
+                ok = 0;
+                break;
+            }
+            p       = term + start;
+            wend    = p + wlen;
+            is_word = 0;
+            while (ok && p < wend) {
+                u = st_word_char_len(p, wend, ST_SCAN_UTF8);
+                if (!u && (p == term + start || !ST_IS_WORD_SEP(p))) {
+                    ok = 0;
+                }
+                is_word = u > 0;
+                p += u ? u : 1;
+            }
+            if (!is_word) {
+                ok = 0;
+            }
+            start = stop + 1;
+        }
+        tm->num_words[i]  = ok ? n : 0;
+        tm->multi_fold[i] = 0;
+        if (!ok) {
+            continue;
+        }
+        
+        start = 0;
+        for (j = 0; j < n; j++) {
+            stop = start;
+            while (stop < tlen && term[stop] != ' ') {
+                stop++;
+            }
+            is_prefix = term[stop - 1] == wildcard;
+            st_term_matcher_add(tm, term + start,
+                                stop - start - (is_prefix ? 1 : 0),
+                                i, j, is_prefix);
+            for (p = term + start; p < term + stop; p += UTF8SKIP(p)) {
+                U8 fold[UTF8_MAXBYTES_CASE+1];
+                STRLEN flen = st_fold_utf8(p, UTF8SKIP(p), fold);
+                if (st_utf8_num_chars(fold, flen) != 1) {
+                    tm->multi_fold[i] = 1;
+                }
+            }
+            start = stop + 1;
+        }
+    }
+    return tm;
+}
+
+static void
+st_term_matcher_add(st_term_matcher *tm, const U8 *ptr, STRLEN len, I32 term, I32 pos, boolean is_prefix)
+{
+    dTHX;
+    
+    st_match_word word;
+    st_match_word *old;
+    I32 i, old_size, mask;
+    
+    word.str  = st_malloc((UTF8_MAXBYTES_CASE*len)+1);
+    word.len  = st_fold_utf8(ptr, len, word.str);
+    word.hash = st_hash(word.str, word.len);
+    word.term = term;
+    word.pos  = pos;
+    word.ascii = st_char_is_ascii((unsigned char*)ptr, len);
+    
+    if (is_prefix) {
+        tm->prefixes = st_realloc(tm->prefixes,
+                            sizeof(st_match_word) * (tm->num_prefixes + 1));
+        tm->prefixes[tm->num_prefixes++] = word;
+        return;
+    }
+    if (word.len > tm->max_len) {
+        tm->max_len = word.len;
+    }
+    
+    /* keep the table at most half full */
+    if ((tm->num + 1) * 2 > tm->size) {
+        old      = tm->table;
+        old_size = tm->size;
+        tm->size = old_size * 2;
+        tm->table = st_malloc(sizeof(st_match_word) * tm->size);
+        Zero(tm->table, tm->size, st_match_word);
+        mask = tm->size - 1;
+        for (i = 0; i < old_size; i++) {
+            I32 slot;
+            if (old[i].str == NULL) {
+                continue;
+            }
+            slot = old[i].hash & mask;
+            while (tm->table[slot].str != NULL) {
+                slot = (slot + 1) & mask;
+            }
+            tm->table[slot] = old[i];
+        }
+        free(old);
+    }
+    
+    /* the same word may be in several terms, so keep every copy */
+    mask = tm->size - 1;
+    i = word.hash & mask;
+    while (tm->table[i].str != NULL) {
+        i = (i + 1) & mask;
+    }
+    tm->table[i] = word;
+    tm->num++;
+}
+
+/* does s..e, case folded, start with prefix on a char boundary?
+ * With simple, a char folding to several never matches. */
+static boolean
+st_fold_has_prefix(const U8 *s, const U8 *e, const U8 *prefix, STRLEN plen, boolean simple)
+{
+    return st_fold_prefix_end(s, e, prefix, plen, simple) != NULL;
+}
+
+/* same, returning where the prefix ends in s..e, or NULL */
+static const U8*
+st_fold_prefix_end(const U8 *s, const U8 *e, const U8 *prefix, STRLEN plen, boolean simple)
+{
+    U8 buf[UTF8_MAXBYTES_CASE+1];
+    STRLEN got, flen, u;
+    
+    got = 0;
+    while (got < plen && s < e) {
+        u    = UTF8SKIP(s);
+        flen = st_fold_utf8(s, u, buf);
+        if (got + flen > plen || memNE(buf, prefix + got, flen)) {
+            return NULL;
+        }
+        if (simple && st_utf8_num_chars(buf, flen) != 1) {
+            return NULL;
+        }
+        got += flen;
+        s   += u;
+    }
+    return got == plen ? s : NULL;
+}
+
+/* a word of the text matched w; roles are the ST_MATCH_* it may play */
+static void
+st_term_matcher_hit(st_term_matcher *tm, const st_match_word *w, U8 roles,
+                    const U64 *active, U64 *next, char *hit)
+{
+    I32 last = tm->num_words[w->term] - 1;
+    
+    if (!(roles & (w->pos == 0 ? ST_MATCH_FIRST : ST_MATCH_INNER))) {
+        return;
+    }
+    if (w->pos > 0 && !(active[w->term] & ((U64)1 << (w->pos - 1)))) {
+        return;
+    }
+    if (w->pos == last) {
+        if (roles & ST_MATCH_LAST) {
+            hit[w->term] = 1;
+        }
+    }
+    else if (roles & ST_MATCH_MID) {
+        next[w->term] |= (U64)1 << w->pos;
+    }
+}
+
+/* match the run s..e of buf. seps are the offsets of the ' and -
+ * in the run (html only). */
+static void
+st_term_matcher_run(
+    st_term_matcher *tm,
+    const U8 *buf,
+    STRLEN len,
+    const U8 *s,
+    const U8 *e,
+    const STRLEN *seps,
+    I32 num_seps,
+    boolean html,
+    U8 **fbuf,
+    STRLEN *fbuf_len,
+    U64 *active,
+    U64 *next,
+    char *hit,
+    boolean *unsure
+)
+{
+    const U8 *inner_start, *inner_end, *starts[ST_MATCH_MAX_SEPS+1], *ends[ST_MATCH_MAX_SEPS+1];
+    I32 num_starts, num_ends, a, b, i, mask;
+    U8 roles;
+    STRLEN flen, need;
+    U32 hash;
+    
+    inner_start = ST_IS_WORD_SEP(s) ? s + 1 : s;
+    inner_end   = e;
+    while (inner_end > inner_start && ST_IS_WORD_SEP(inner_end - 1)) {
+        inner_end--;
+    }
+    if (inner_end <= inner_start) {
+        return;
+    }
+    
+    starts[0]  = inner_start;
+    ends[0]    = inner_end;
+    num_starts = 1;
+    num_ends   = 1;
+    if (html) {
+        for (i = 0; i < num_seps; i++) {
+            const U8 *sep = buf + seps[i];
+            if (sep + 1 > inner_start && sep + 1 < inner_end
+                && !ST_IS_WORD_SEP(sep + 1)
+            ) {
+                starts[num_starts++] = sep + 1;
+            }
+            if (sep > inner_start && sep < inner_end
+                && !ST_IS_WORD_SEP(sep - 1)
+            ) {
+                ends[num_ends++] = sep;
+            }
+        }
+    }
+    
+    for (a = 0; a < num_starts; a++) {
+        for (b = 0; b < num_ends; b++) {
+            if (ends[b] <= starts[a]) {
+                continue;
+            }
+            if (html) {
+                roles = ST_MATCH_FIRST | ST_MATCH_LAST
+                      | (a == 0 ? ST_MATCH_INNER : 0)
+                      | (b == 0 ? ST_MATCH_MID : 0);
+            }
+            else {
+                /* \A or a non-word char must come before a dropped '
+                 * or -, and \Z can't come after one */
+                roles = ST_MATCH_INNER | ST_MATCH_MID;
+                if (inner_start == s || s > buf) {
+                    roles |= ST_MATCH_FIRST;
+                }
+                if (inner_end == e || e < buf + len) {
+                    roles |= ST_MATCH_LAST;
+                }
+            }
+            
+            /* no fold shrinks a char to less than a third */
+            if ((STRLEN)(ends[b] - starts[a]) > tm->max_len * 3) {
+                continue;
+            }
+            need = (UTF8_MAXBYTES_CASE * (ends[b] - starts[a])) + 1;
+            if (need > *fbuf_len) {
+                *fbuf     = st_realloc(*fbuf, need);
+                *fbuf_len = need;
+            }
+            flen = st_fold_utf8(starts[a], ends[b] - starts[a], *fbuf);
+            if (flen > tm->max_len) {
+                continue;
+            }
+            
+            /* the html regex matches a char at a time, so a char
+             * folding to several (e.g. ß to ss) is up to the regex */
+            if (html
+                && st_utf8_num_chars(*fbuf, flen)
+                   != st_utf8_num_chars(starts[a], ends[b] - starts[a])
+            ) {
+                *unsure = 1;
+                continue;
+            }
+            hash = st_hash(*fbuf, flen);
+            mask = tm->size - 1;
+            i = hash & mask;
+            while (tm->table[i].str != NULL) {
+                if (tm->table[i].hash == hash
+                    && tm->table[i].len == flen
+                    && memEQ(tm->table[i].str, *fbuf, flen)
+                ) {
+                    st_term_matcher_hit(tm, &tm->table[i], roles,
+                                        active, next, hit);
+                }
+                i = (i + 1) & mask;
+            }
+        }
+    }
+    
+    /* a wildcard takes the rest of the run */
+    for (i = 0; i < tm->num_prefixes; i++) {
+        for (a = 0; a < num_starts; a++) {
+            if (html) {
+                roles = ST_MATCH_FIRST | (a == 0 ? ST_MATCH_INNER : 0);
+            }
+            else {
+                roles = ST_MATCH_INNER
+                      | ((inner_start == s || s > buf) ? ST_MATCH_FIRST : 0);
+            }
+            if (st_fold_has_prefix(starts[a], e, tm->prefixes[i].str,
+                                   tm->prefixes[i].len, html)
+            ) {
+                st_term_matcher_hit(tm, &tm->prefixes[i],
+                                    roles | ST_MATCH_LAST | ST_MATCH_MID,
+                                    active, next, hit);
+            }
+        }
+    }
+}
+
+/* case fold len bytes at s into a new buffer, sized for the result */
+static U8*
+st_fold_copy(const U8 *s, STRLEN len, STRLEN *flen)
+{
+    U8 *buf;
+    
+    buf = st_malloc(st_char_is_ascii((unsigned char*)s, len)
+                    ? len + 1
+                    : (UTF8_MAXBYTES_CASE*len)+1);
+    *flen = st_fold_utf8(s, len, buf);
+    return buf;
+}
+
+/*
+    The html regex of a term matches its chars, each written as
+    itself or as an entity, with whole tags (<[^>]+>) allowed in
+    between. So wherever it matches, the folded word is in the folded
+    html as is, with numeric entities decoded, or with those and the
+    tags it skipped removed.
+
+    A tag starts at a < right after a term char, an entity or another
+    tag, and ends at the next >. Between a < and the next > there may be
+    more <, e.g. in scripts. Exactly one of them can start a tag then,
+    or else we can't tell which to remove.
+
+    Sets absent[i] for each term with a word in none of the three.
+    Words with non-ASCII chars might be in named entities, so they
+    are only looked for if there are none.
+    Returns false if it couldn't tell which tags to remove.
+*/
+static boolean
+st_term_matcher_absent(st_term_matcher *tm, const U8 *buf, STRLEN len, char *absent)
+{
+    dTHX;
+    
+    U8 *dec, *strip, *folded[3];
+    STRLEN d, t, i, j, flens[3], region_end, strip_from;
+    UV cp;
+    I32 k, n, f, starts;
+    boolean named;
+    st_match_word *w;
+    
+    dec        = st_malloc(len + 1);
+    strip      = st_malloc(len + 1);
+    d          = 0;
+    t          = 0;
+    named      = 0;
+    region_end = 0;
+    strip_from = len;
+    for (i = 0; i < len; ) {
+        if (buf[i] == '<' && (i >= region_end || region_end == 0)) {
+            starts     = 0;
+            strip_from = len;
+            for (j = i; j < len && buf[j] != '>'; j++) {
+                if (buf[j] == '<'
+                    && j > 0
+                    && (!UTF8_IS_INVARIANT(buf[j - 1])
+                        || isWORDCHAR_A(buf[j - 1])
+                        || ST_IS_WORD_SEP(buf + j - 1)
+                        || buf[j - 1] == ';'
+                        || buf[j - 1] == '>')
+                ) {
+                    starts++;
+                    strip_from = j;
+                }
+            }
+            if (starts > 1) {
+                free(dec);
+                free(strip);
+                return 0;
+            }
+            region_end = j < len ? j + 1 : len;
+            if (j >= len || strip_from + 1 == j) {
+                strip_from = len; /* no > or <> is no tag */
+            }
+        }
+        if (i == strip_from) {
+            Copy(buf + i, dec + d, region_end - i, U8);
+            d += region_end - i;
+            i  = region_end;
+            strip_from = len;
+            continue;
+        }
+        if (buf[i] == '&' && i + 1 < len && isALPHA_A(buf[i + 1])) {
+            named = 1;
+        }
+        if (buf[i] == '&' && i + 2 < len && buf[i + 1] == '#') {
+            boolean hex = buf[i + 2] == 'x' || buf[i + 2] == 'X';
+            cp = 0;
+            for (j = i + (hex ? 3 : 2); j < len && j < i + 12; j++) {
+                if (isDIGIT_A(buf[j])) {
+                    cp = cp * (hex ? 16 : 10) + (buf[j] - '0');
+                }
+                else if (hex && isXDIGIT_A(buf[j])) {
+                    cp = cp * 16 + (toLOWER_A(buf[j]) - 'a' + 10);
+                }
+                else {
+                    break;
+                }
+            }
+            /* the UTF-8 of a char is never longer than its entity */
+            if (j < len && buf[j] == ';' && j > i + (hex ? 3 : 2)
+                && cp > 0 && cp <= 0x10FFFF
+                && !(cp >= 0xD800 && cp <= 0xDFFF)
+                && (strip_from == len || j < strip_from)
+            ) {
+                U8 *e = uvchr_to_utf8(dec + d, cp);
+                Copy(dec + d, strip + t, e - (dec + d), U8);
+                t += e - (dec + d);
+                d  = e - dec;
+                i  = j + 1;
+                continue;
+            }
+        }
+        dec[d++]   = buf[i];
+        strip[t++] = buf[i++];
+    }
+    
+    folded[0] = st_fold_copy(buf, len, &flens[0]);
+    folded[1] = st_fold_copy(dec, d, &flens[1]);
+    folded[2] = st_fold_copy(strip, t, &flens[2]);
+    free(dec);
+    free(strip);
+    
+    n = tm->size + tm->num_prefixes;
+    for (k = 0; k < n; k++) {
+        w = k < tm->size ? &tm->table[k] : &tm->prefixes[k - tm->size];
+        if (w->str == NULL || absent[w->term]) {
+            continue;
+        }
+        if (named && !w->ascii) {
+            continue;
+        }
+        for (f = 0; f < 3; f++) {
+            if (ninstr((char*)folded[f], (char*)folded[f] + flens[f],
+                       (char*)w->str, (char*)w->str + w->len) != NULL
+            ) {
+                break;
+            }
+        }
+        if (f == 3) {
+            absent[w->term] = 1;
+        }
+    }
+    for (f = 0; f < 3; f++) {
+        free(folded[f]);
+    }
+    return 1;
+}
+
+/* returns an AV with, for each term, 1 or 0 for whether the term's
+ * plain (or html) regex matches text, or undef where it could not say.
+ */
+static AV*
+st_term_matcher_match(st_term_matcher *tm, SV *text, boolean html)
+{
+    dTHX;
+    
+    AV *found;
+    const U8 *buf, *end, *p, *s;
+    STRLEN len, u, fbuf_len, seps[ST_MATCH_MAX_SEPS];
+    U8 mode, *fbuf;
+    U64 *active, *next, *tmp;
+    char *hit, *absent;
+    I32 i, num_seps;
+    boolean unsure;
+    
+    buf   = (U8*)SvPV(text, len);
+    end   = buf + len;
+    found = newAV();
+    if (!tm->num_terms) {
+        return found;
+    }
+    av_extend(found, tm->num_terms - 1);
+    
+    /* byte strings have byte semantics for \w and m//i */
+    if (!SvUTF8(text) && !st_char_is_ascii((unsigned char*)buf, len)) {
+        av_fill(found, tm->num_terms - 1);
+        return found;
+    }
+    mode   = SvUTF8(text) ? ST_SCAN_UTF8 : ST_SCAN_ASCII;
+    unsure = html && (memchr(buf, '<', len) || memchr(buf, '&', len));
+    
+    hit      = st_malloc(tm->num_terms);
+    active   = st_malloc(sizeof(U64) * tm->num_terms);
+    next     = st_malloc(sizeof(U64) * tm->num_terms);
+    fbuf_len = 64;
+    fbuf     = st_malloc(fbuf_len);
+    Zero(hit, tm->num_terms, char);
+    Zero(active, tm->num_terms, U64);
+    Zero(next, tm->num_terms, U64);
+    
+    p = buf;
+    while (p < end) {
+        if (!ST_IS_WORD_SEP(p) && !st_word_char_len(p, end, mode)) {
+            p += UTF8_IS_INVARIANT(*p) ? 1 : UTF8SKIP(p);
+            continue;
+        }
+        s        = p;
+        num_seps = 0;
+        while (p < end) {
+            if (ST_IS_WORD_SEP(p)) {
+                if (num_seps < ST_MATCH_MAX_SEPS) {
+                    seps[num_seps] = p - buf;
+                }
+                num_seps++;
+                p++;
+            }
+            else if ((u = st_word_char_len(p, end, mode))) {
+                p += u;
+            }
+            else {
+                break;
+            }
+        }
+        if (html && num_seps > ST_MATCH_MAX_SEPS) {
+            unsure   = 1;
+            num_seps = ST_MATCH_MAX_SEPS;
+        }
+        
+        st_term_matcher_run(tm, buf, len, s, p, seps, num_seps, html,
+                            &fbuf, &fbuf_len, active, next, hit, &unsure);
+        tmp    = active;
+        active = next;
+        next   = tmp;
+        Zero(next, tm->num_terms, U64);
+    }
+    
+    /* in html, a term not found (or with a char folding to several)
+     * may still be there unless st_term_matcher_absent() rules it out */
+    absent = NULL;
+    for (i = 0; html && i < tm->num_terms; i++) {
+        if (tm->num_words[i] && (tm->multi_fold[i] || (unsure && !hit[i]))) {
+            absent = st_malloc(tm->num_terms);
+            Zero(absent, tm->num_terms, char);
+            if (!st_term_matcher_absent(tm, buf, len, absent)) {
+                Zero(absent, tm->num_terms, char);
+            }
+            break;
+        }
+    }
+    
+    for (i = 0; i < tm->num_terms; i++) {
+        if (!tm->num_words[i]) {
+            continue;
+        }
+        if (hit[i] && !(html && tm->multi_fold[i])) {
+            av_store(found, i, newSViv(1));
+        }
+        else if (absent != NULL && absent[i]) {
+            av_store(found, i, newSViv(0));
+        }
+        else if (!html || (!unsure && !tm->multi_fold[i])) {
+            av_store(found, i, newSViv(0));
+        }
+    }
+    av_fill(found, tm->num_terms - 1);
+    
+    free(hit);
+    free(active);
+    free(next);
+    free(fbuf);
+    if (absent != NULL) {
+        free(absent);
+    }
+    return found;
+}
+
+/* the runs of buf, with the term words each holds where the plain
+ * regex would see them. Returns the number of runs.
+ */
+static I32
+st_term_matcher_runs(
+    st_term_matcher *tm,
+    const U8 *buf,
+    STRLEN len,
+    U8 mode,
+    st_match_run **runs_ptr,
+    st_match_hit **hits_ptr
+)
+{
+    dTHX;
+    
+    st_match_run *runs, *run;
+    st_match_hit *hits;
+    const U8 *end, *p;
+    U8 *fbuf;
+    STRLEN u, flen, need, fbuf_len;
+    U32 hash;
+    I32 num_runs, max_runs, num_hits, max_hits, i, mask;
+    
+    end      = buf + len;
+    num_runs = 0;
+    max_runs = 64;
+    num_hits = 0;
+    max_hits = 64;
+    runs     = st_malloc(sizeof(st_match_run) * max_runs);
+    hits     = st_malloc(sizeof(st_match_hit) * max_hits);
+    fbuf_len = 64;
+    fbuf     = st_malloc(fbuf_len);
+    mask     = tm->size - 1;
+    
+    p = buf;
+    while (p < end) {
+        if (!ST_IS_WORD_SEP(p) && !st_word_char_len(p, end, mode)) {
+            p += UTF8_IS_INVARIANT(*p) ? 1 : UTF8SKIP(p);
+            continue;
+        }
+        if (num_runs == max_runs) {
+            max_runs *= 2;
+            runs = st_realloc(runs, sizeof(st_match_run) * max_runs);
+        }
+        run = &runs[num_runs++];
+        run->s = p - buf;
+        while (p < end) {
+            if (ST_IS_WORD_SEP(p)) {
+                p++;
+            }
+            else if ((u = st_word_char_len(p, end, mode))) {
+                p += u;
+            }
+            else {
+                break;
+            }
+        }
+        run->e  = p - buf;
+        run->is = ST_IS_WORD_SEP(buf + run->s) ? run->s + 1 : run->s;
+        run->ie = run->e;
+        while (run->ie > run->is && ST_IS_WORD_SEP(buf + run->ie - 1)) {
+            run->ie--;
+        }
+        run->first_hit = num_hits;
+        run->num_hits  = 0;
+        if (run->ie == run->is) {
+            continue;
+        }
+        if (num_hits + tm->num + tm->num_prefixes > max_hits) {
+            max_hits = (num_hits + tm->num + tm->num_prefixes) * 2;
+            hits = st_realloc(hits, sizeof(st_match_hit) * max_hits);
+        }
+        
+        /* no fold shrinks a char to less than a third */
+        if (run->ie - run->is <= tm->max_len * 3) {
+            need = (UTF8_MAXBYTES_CASE * (run->ie - run->is)) + 1;
+            if (need > fbuf_len) {
+                fbuf     = st_realloc(fbuf, need);
+                fbuf_len = need;
+            }
+            flen = st_fold_utf8(buf + run->is, run->ie - run->is, fbuf);
+            hash = st_hash(fbuf, flen);
+            i = hash & mask;
+            while (flen <= tm->max_len && tm->table[i].str != NULL) {
+                if (tm->table[i].hash == hash
+                    && tm->table[i].len == flen
+                    && memEQ(tm->table[i].str, fbuf, flen)
+                ) {
+                    hits[num_hits].term   = tm->table[i].term;
+                    hits[num_hits].pos    = tm->table[i].pos;
+                    hits[num_hits].prefix = 0;
+                    num_hits++;
+                }
+                i = (i + 1) & mask;
+            }
+        }
+        
+        /* a wildcard takes the rest of the run */
+        for (i = 0; i < tm->num_prefixes; i++) {
+            if (st_fold_has_prefix(buf + run->is, buf + run->e,
+                    tm->prefixes[i].str, tm->prefixes[i].len, 0)
+            ) {
+                hits[num_hits].term   = tm->prefixes[i].term;
+                hits[num_hits].pos    = tm->prefixes[i].pos;
+                hits[num_hits].prefix = 1;
+                num_hits++;
+            }
+        }
+        run->num_hits = num_hits - run->first_hit;
+    }
+    
+    free(fbuf);
+    *runs_ptr = runs;
+    *hits_ptr = hits;
+    return num_runs;
+}
+
+static int
+st_hilite_tag_cmp(const void *a, const void *b)
+{
+    const st_hilite_tag *ta = (const st_hilite_tag*)a;
+    const st_hilite_tag *tb = (const st_hilite_tag*)b;
+    if (ta->offset != tb->offset) {
+        return ta->offset < tb->offset ? -1 : 1;
+    }
+    if (ta->close != tb->close) {
+        return ta->close ? -1 : 1;
+    }
+    /* later terms open inside and close inside earlier ones */
+    return ta->close ? tb->order - ta->order : ta->order - tb->order;
+}
+
+/*
+    Hilites text like HiLiter plain(): for each term in order, its
+    plain regex is matched with m//g, stepping back one char after
+    each match, over the text with the marks of the terms before it
+    already inserted. A mark is a pair of non-word chars just before
+    or after a match, so it only changes a later match where it comes
+    between a ' or - and the word or gap next to it. The marks are kept
+    in marked[] by byte offset and every term is matched against the
+    runs found once.
+    
+    Positions in the marked text are compared as 2 * offset for the
+    marks at an offset and 2 * offset + 1 for the char there; -1 is \A.
+    
+    Returns a new SV with open_tags and close_tags inserted, or NULL
+    if a term is left to its regex.
+*/
+static SV*
+st_term_matcher_hilite(
+    st_term_matcher *tm,
+    SV *text,
+    AV *order,
+    AV *open_tags,
+    AV *close_tags
+)
+{
+    dTHX;
+    
+    const U8 *buf;
+    STRLEN len, stop, prev;
+    st_match_run *runs, *first, *last, *next;
+    st_match_hit *hits;
+    st_hilite_tag *tags;
+    char *marked;
+    I32 *terms, num_runs, num_order, num_tags, max_tags, k, n, r, j, h;
+    IV from, key;
+    boolean prefix, found, ok;
+    SV *lit;
+    
+    buf = (U8*)SvPV(text, len);
+    
+    /* byte strings have byte semantics for \w and m//i */
+    if (!SvUTF8(text) && !st_char_is_ascii((unsigned char*)buf, len)) {
+        return NULL;
+    }
+    num_order = av_len(order) + 1;
+    if (av_len(open_tags) + 1 < num_order
+        || av_len(close_tags) + 1 < num_order
+    ) {
+        ST_CROAK("need an open and close tag for each term");
+    }
+    terms = st_malloc(sizeof(I32) * (num_order ? num_order : 1));
+    for (k = 0; k < num_order; k++) {
+        terms[k] = SvIV(st_av_fetch(order, k));
+        if (terms[k] < 0 || terms[k] >= tm->num_terms
+            || !tm->num_words[terms[k]]
+        ) {
+            free(terms);
+            return NULL;
+        }
+    }
+    
+    num_runs = st_term_matcher_runs(tm, buf, len,
+                    SvUTF8(text) ? ST_SCAN_UTF8 : ST_SCAN_ASCII, &runs, &hits);
+    marked   = st_malloc(len + 1);
+    Zero(marked, len + 1, char);
+    num_tags = 0;
+    max_tags = 64;
+    tags     = st_malloc(sizeof(st_hilite_tag) * max_tags);
+    ok       = 1;
+    prefix   = 0;
+    first    = NULL;
+    last     = NULL;
+    
+    for (k = 0; ok && k < num_order; k++) {
+        n    = tm->num_words[terms[k]];
+        from = -1;
+        for (r = 0; r + n <= num_runs; r++) {
+            
+            /* the words of the term, one per run, with the phrase gap
+             * between runs broken by a mark on either side of a ' or - */
+            for (j = 0; j < n; j++) {
+                last  = &runs[r + j];
+                found = 0;
+                for (h = last->first_hit; h < last->first_hit + last->num_hits; h++) {
+                    if (hits[h].term == terms[k] && hits[h].pos == j) {
+                        found  = 1;
+                        prefix = hits[h].prefix;
+                        break;
+                    }
+                }
+                if (!found) {
+                    break;
+                }
+                if (j == 0) {
+                    first = last;
+                    
+                    /* the latest a $1 of the match can start */
+                    if (marked[first->is]) {
+                        key = 2 * first->is;
+                    }
+                    else if (first->is > first->s) {
+                        key = first->s ? (IV)(2 * (first->s - 1) + 1) : -2;
+                    }
+                    else {
+                        key = first->is ? (IV)(2 * (first->is - 1) + 1) : -1;
+                    }
+                    if (key < from) {
+                        break;
+                    }
+                }
+                if (j < n - 1) {
+                    next = &runs[r + j + 1];
+                    if ((marked[last->ie] && last->ie < last->e)
+                        || (next->is > next->s && marked[next->is])
+                    ) {
+                        break;
+                    }
+                }
+            }
+            if (j < n) {
+                continue;
+            }
+            
+            /* the wildcard stops at a mark */
+            stop = prefix && !(marked[last->ie] && last->ie < last->e)
+                 ? last->e
+                 : last->ie;
+            
+            /* $3 is \Z or ['-]* followed by a non-word char or mark */
+            if (!marked[stop] && stop < last->e
+                && last->e == len && !marked[len]
+            ) {
+                continue;
+            }
+            if (n == 1 && prefix && stop - first->is == 1
+                && buf[first->is] == '0'
+            ) {
+                ok = 0;     /* plain() puts the term for a match of "0" */
+                break;
+            }
+            
+            /* the next match starts from the last char of this $3 */
+            if (stop < last->e && marked[stop]) {
+                from = 2 * stop + 1;
+            }
+            else if (last->e == len) {
+                from = marked[len] ? 2 * len : 2 * len + 2;
+            }
+            else if (r + n < num_runs) {
+                next = &runs[r + n];
+                from = next->is > next->s ? 2 * next->s + 1
+                     : marked[next->s]    ? 2 * next->s
+                     :                      2 * (next->s - 1) + 1;
+            }
+            else {
+                from = 2 * (len - 1) + 1;
+            }
+            
+            if (num_tags + 2 > max_tags) {
+                max_tags *= 2;
+                tags = st_realloc(tags, sizeof(st_hilite_tag) * max_tags);
+            }
+            tags[num_tags].offset   = first->is;
+            tags[num_tags].order    = k;
+            tags[num_tags++].close  = 0;
+            tags[num_tags].offset   = stop;
+            tags[num_tags].order    = k;
+            tags[num_tags++].close  = 1;
+            marked[first->is] = 1;
+            marked[stop]      = 1;
+        }
+    }
+    
+    lit = NULL;
+    if (ok) {
+        qsort(tags, num_tags, sizeof(st_hilite_tag), st_hilite_tag_cmp);
+        lit = newSV(len + 1);
+        sv_setpvn(lit, "", 0);
+        if (SvUTF8(text)) {
+            SvUTF8_on(lit);
+        }
+        prev = 0;
+        for (h = 0; h < num_tags; h++) {
+            sv_catpvn(lit, (char*)buf + prev, tags[h].offset - prev);
+            prev = tags[h].offset;
+            sv_catsv(lit, st_av_fetch(tags[h].close ? close_tags : open_tags,
+                                      tags[h].order));
+        }
+        sv_catpvn(lit, (char*)buf + prev, len - prev);
+    }
+    
+    free(terms);
+    free(runs);
+    free(hits);
+    free(marked);
+    free(tags);
+    return lit;
+}
+
+/* elements whose text is never hilited, and elements that
+ * start on a new line and so break the words around them */
+static const char *ST_HTML_SKIP_TAGS[] = {
+    "script", "style", "textarea", "title", NULL
+};
+static const char *ST_HTML_BREAK_TAGS[] = {
+    "address", "article", "aside", "blockquote", "body", "br", "caption",
+    "center", "dd", "div", "dl", "dt", "fieldset", "figcaption", "figure",
+    "footer", "form", "h1", "h2", "h3", "h4", "h5", "h6", "head", "header",
+    "hr", "html", "legend", "li", "main", "nav", "ol", "option", "p", "pre",
+    "section", "select", "table", "tbody", "td", "tfoot", "th", "thead",
+    "tr", "ul", NULL
+};
+
+static boolean
+st_html_tag_is(const U8 *name, STRLEN len, const char **names)
+{
+    I32 i;
+    STRLEN j;
+    
+    for (i = 0; names[i] != NULL; i++) {
+        if (strlen(names[i]) != len) {
+            continue;
+        }
+        for (j = 0; j < len && toLOWER_A(name[j]) == (U8)names[i][j]; j++) {
+            /* compare */
+        }
+        if (j == len) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* the char of the entity at s, or 0 if there is none. Sets *elen
+ * to the length of the entity. Named entities are looked up in
+ * entities, which maps names to code points, or in st_html_ents
+ * if entities is NULL. */
+static UV
+st_html_entity(const U8 *s, STRLEN len, HV *entities, STRLEN *elen)
+{
+    dTHX;
+    
+    STRLEN j, start;
+    UV cp;
+    SV **val;
+    boolean hex;
+    
+    if (len < 3 || s[0] != '&') {
+        return 0;
+    }
+    cp = 0;
+    if (s[1] == '#') {
+        hex   = s[2] == 'x' || s[2] == 'X';
+        start = hex ? 3 : 2;
+        for (j = start; j < len && j < start + 8; j++) {
+            if (isDIGIT_A(s[j])) {
+                cp = cp * (hex ? 16 : 10) + (s[j] - '0');
+            }
+            else if (hex && isXDIGIT_A(s[j])) {
+                cp = cp * 16 + (toLOWER_A(s[j]) - 'a' + 10);
+            }
+            else {
+                break;
+            }
+        }
+        if (j == start) {
+            return 0;
+        }
+    }
+    else {
+        for (j = 1; j < len && j < 33 && isALNUM_A(s[j]); j++) {
+            /* name */
+        }
+        if (j == 1 || j >= len || s[j] != ';') {
+            return 0;
+        }
+        if (entities == NULL) {
+            cp = st_html_ent_lookup(s + 1, j - 1);
+        }
+        else {
+            val = hv_fetch(entities, (char*)s + 1, j - 1, 0);
+            if (val == NULL || !SvOK(*val)) {
+                return 0;
+            }
+            cp = SvUV(*val);
+        }
+    }
+    if (j >= len || s[j] != ';'
+        || cp == 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)
+        || (STRLEN)UVCHR_SKIP(cp) > j + 1
+    ) {
+        return 0;
+    }
+    *elen = j + 1;
+    return cp;
+}
+
+/* the code point of the entity named by len bytes at name, or 0 */
+static UV
+st_html_ent_lookup(const U8 *name, STRLEN len)
+{
+    I32 lo, hi, mid;
+    int cmp;
+    
+    lo = 0;
+    hi = ST_NUM_HTML_ENTS - 1;
+    while (lo <= hi) {
+        const char *ent;
+        mid = (lo + hi) / 2;
+        ent = st_html_ents[mid].name;
+        cmp = strncmp(ent, (const char*)name, len);
+        if (cmp == 0 && ent[len] != '\0') {
+            cmp = 1;
+        }
+        if (cmp == 0) {
+            return st_html_ents[mid].cp;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+    return 0;
+}
+
+/*
+    The char of the entity at p of one of kinds, or 0, as
+    st_html_entity() with st_html_ents. A named entity that decodes
+    to '&' followed by a numeric one decodes as the numeric one, as it
+    did when unescape() decoded named entities and then numeric ones:
+    "&amp;#34;" is '"'.
+*/
+static UV
+st_unescape_entity( const U8 *p, const U8 *end, U8 kinds, STRLEN *elen )
+{
+    U8 buf[16];
+    STRLEN n, k;
+    UV cp, num;
+    U8 kind;
+    
+    if (end - p > 2 && p[1] == '#') {
+        kind = toLOWER_A(p[2]) == 'x' ? ST_ENT_HEX : ST_ENT_DECIMAL;
+    }
+    else {
+        kind = ST_ENT_NAMED;
+    }
+    if (!(kinds & kind)) {
+        return 0;
+    }
+    cp = st_html_entity(p, end - p, NULL, elen);
+    if (cp != '&' || kind != ST_ENT_NAMED || p + *elen >= end
+        || p[*elen] != '#'
+    ) {
+        return cp;
+    }
+    
+    /* a numeric entity is at most &#x + 8 digits + ; */
+    n = end - (p + *elen);
+    if (n > sizeof(buf) - 1) {
+        n = sizeof(buf) - 1;
+    }
+    buf[0] = '&';
+    Copy(p + *elen, buf + 1, n, U8);
+    kind = n > 1 && toLOWER_A(buf[2]) == 'x' ? ST_ENT_HEX : ST_ENT_DECIMAL;
+    if (kinds & kind) {
+        num = st_html_entity(buf, n + 1, NULL, &k);
+        if (num) {
+            *elen += k - 1;
+            return num;
+        }
+    }
+    return cp;
+}
+
+/*
+    A copy of str with the entities of the given kinds (ST_ENT_NAMED,
+    ST_ENT_DECIMAL and ST_ENT_HEX, OR'd) decoded, in one pass. A str that
+    is not UTF-8 stays bytes unless an entity decodes to a char above
+    0xff, when it is upgraded first and decoded again.
+*/
+static SV*
+st_unescape_html( SV *str, U8 kinds )
+{
+    dTHX;
+    
+    const U8 *p, *end, *amp;
+    U8 *o;
+    STRLEN len, elen;
+    boolean utf8;
+    SV *out;
+    UV cp;
+    
+    p    = (U8*)SvPV(str, len);
+    utf8 = SvUTF8(str) ? 1 : 0;
+    if (memchr(p, '&', len) == NULL) {
+        return newSVpvn_flags((char*)p, len, utf8 ? SVf_UTF8 : 0);
+    }
+    
+    /* nothing decodes to more bytes than it takes, see st_html_entity() */
+    out = newSV(len + 1);
+    SvPOK_on(out);
+    o   = (U8*)SvPVX(out);
+    end = p + len;
+    while (p < end && (amp = memchr(p, '&', end - p)) != NULL) {
+        Copy(p, o, amp - p, U8);
+        o += amp - p;
+        p  = amp;
+        
+        cp = st_unescape_entity(p, end, kinds, &elen);
+        if (!cp) {
+            *o++ = *p++;
+            continue;
+        }
+        if (cp > 0xff && !utf8) {
+            SV *up = sv_2mortal(newSVsv(str));
+            SvREFCNT_dec(out);
+            sv_utf8_upgrade(up);
+            return st_unescape_html(up, kinds);
+        }
+        if (utf8) {
+            o = uvchr_to_utf8(o, cp);
+        }
+        else {
+            *o++ = (U8)cp;
+        }
+        p += elen;
+    }
+    Copy(p, o, end - p, U8);
+    o += end - p;
+    *o = '\0';
+    SvCUR_set(out, o - (U8*)SvPVX(out));
+    if (utf8) {
+        SvUTF8_on(out);
+    }
+    return out;
+}
+
+/*
+    Decodes len bytes of html at buf: entities become their chars and
+    tags and comments are dropped. Tags that break the text become a
+    space no phrase may cross, as do the elements never hilited and
+    \002 .. \003 regions.
+*/
+static st_html_text*
+st_new_html_text(const U8 *buf, STRLEN len, boolean utf8, HV *entities)
+{
+    dTHX;
+    
+    st_html_text *ht;
+    const U8 *gt, *p;
+    STRLEN i, j, k, d, n, name, name_len, elen;
+    I32 max_tags;
+    U8 pending, kind;
+    UV cp;
+    
+    /* nothing decodes to more bytes than it takes in the html */
+    ht         = st_malloc(sizeof(st_html_text));
+    ht->buf    = st_malloc(len + 1);
+    ht->from   = st_malloc(sizeof(STRLEN) * (len + 1));
+    ht->to     = st_malloc(sizeof(STRLEN) * (len + 1));
+    ht->points = st_malloc(len + 1);
+    ht->len    = 0;
+    max_tags   = 16;
+    ht->tags   = st_malloc(sizeof(st_html_span) * max_tags);
+    ht->num_tags = 0;
+    Zero(ht->points, len + 1, U8);
+    
+    pending = 0;
+    i = 0;
+    while (i < len) {
+        kind = 0;
+        j    = i;
+        if (buf[i] == '\002') {
+            for (j = i + 1; j < len && buf[j] != '\003'; j++) {
+                /* skip */
+            }
+            j    = j < len ? j + 1 : len;
+            kind = ST_HTML_BREAK;
+        }
+        else if (buf[i] == '<' && i + 1 < len
+            && (isALPHA_A(buf[i + 1]) || buf[i + 1] == '/'
+                || buf[i + 1] == '!' || buf[i + 1] == '?')
+            && (gt = memchr(buf + i, '>', len - i)) != NULL
+        ) {
+            j    = gt - buf + 1;
+            kind = ST_HTML_TAG;
+            if (len - i >= 4 && memEQ(buf + i, "<!--", 4)) {
+                p = (U8*)ninstr((char*)buf + i + 4, (char*)buf + len,
+                                "-->", "-->" + 3);
+                if (p != NULL) {
+                    j = p - buf + 3;
+                }
+            }
+            else {
+                name = i + (buf[i + 1] == '/' ? 2 : 1);
+                for (k = name; k < j && isALNUM_A(buf[k]); k++) {
+                    /* tag name */
+                }
+                name_len = k - name;
+                if (buf[i + 1] != '/'
+                    && st_html_tag_is(buf + name, name_len, ST_HTML_SKIP_TAGS)
+                ) {
+                    /* up to and including the end tag */
+                    for (k = j; k + name_len + 2 < len; k++) {
+                        if (buf[k] == '<' && buf[k + 1] == '/'
+                            && st_html_tag_is(buf + k + 2, name_len, 
+                                              ST_HTML_SKIP_TAGS)
+                            && ibcmp((char*)buf + k + 2, (char*)buf + name,
+                                     name_len) == 0
+                        ) {
+                            gt = memchr(buf + k, '>', len - k);
+                            j  = gt != NULL ? (STRLEN)(gt - buf + 1) : len;
+                            break;
+                        }
+                    }
+                    kind = ST_HTML_BREAK;
+                }
+                else if (st_html_tag_is(buf + name, name_len,
+                                        ST_HTML_BREAK_TAGS)
+                ) {
+                    kind = ST_HTML_BREAK;
+                }
+            }
+        }
+        
+        if (kind) {
+            if (ht->num_tags == max_tags) {
+                max_tags *= 2;
+                ht->tags = st_realloc(ht->tags, sizeof(st_html_span) * max_tags);
+            }
+            ht->tags[ht->num_tags].start = i;
+            ht->tags[ht->num_tags].end   = j;
+            ht->tags[ht->num_tags].order = 0;
+            ht->num_tags++;
+            if (kind == ST_HTML_BREAK) {
+                d = ht->len++;
+                ht->buf[d]    = ' ';
+                ht->from[d]   = i;
+                ht->to[d]     = i;
+                ht->points[d] |= pending | ST_HTML_BREAK;
+                pending = 0;
+            }
+            else {
+                pending |= ST_HTML_TAG;
+            }
+            i = j;
+            continue;
+        }
+        
+        cp = buf[i] == '&' ? st_html_entity(buf + i, len - i, entities, &elen) : 0;
+        d  = ht->len;
+        if (cp) {
+            n = uvchr_to_utf8(ht->buf + d, cp) - (ht->buf + d);
+            j = i + elen;
+            ht->points[d] |= pending | ST_HTML_ENT;
+            pending = ST_HTML_AFTER_ENT;
+        }
+        else {
+            n = utf8 ? UTF8SKIP(buf + i) : 1;
+            if (n > len - i) {
+                n = len - i;
+            }
+            Copy(buf + i, ht->buf + d, n, U8);
+            j = i + n;
+            ht->points[d] |= pending;
+            pending = 0;
+        }
+        for (k = d; k < d + n; k++) {
+            ht->from[k] = i;
+            ht->to[k]   = j;
+        }
+        ht->len += n;
+        i = j;
+    }
+    ht->points[ht->len] |= pending;
+    ht->buf[ht->len] = '\0';
+    return ht;
+}
+
+static void
+st_free_html_text(st_html_text *ht)
+{
+    free(ht->buf);
+    free(ht->from);
+    free(ht->to);
+    free(ht->points);
+    free(ht->tags);
+    free(ht);
+}
+
+static void
+st_push_match_hit(st_match_hit **hits, I32 *num, I32 *max, I32 term, I32 pos, 
+                  boolean prefix, STRLEN start, STRLEN end, U8 roles)
+{
+    st_match_hit *hit;
+    
+    if (*num == *max) {
+        *max *= 2;
+        *hits = st_realloc(*hits, sizeof(st_match_hit) * *max);
+    }
+    hit = &(*hits)[(*num)++];
+    hit->term   = term;
+    hit->pos    = pos;
+    hit->prefix = prefix;
+    hit->start  = start;
+    hit->end    = end;
+    hit->roles  = roles;
+}
+
+/*
+    The runs of decoded html, with the term words each holds where the
+    html regex would see them: any word may start after a ' or -, a
+    tag or an entity, and end before a ' or -, a tag or an entity.
+    Only a word starting (ending) a run without its ' or - may follow
+    (precede) a phrase gap. Returns the number of runs.
+*/
+static I32
+st_term_matcher_html_runs(
+    st_term_matcher *tm,
+    st_html_text *ht,
+    st_match_run **runs_ptr,
+    st_match_hit **hits_ptr
+)
+{
+    dTHX;
+    
+    st_match_run *runs, *run;
+    st_match_hit *hits;
+    const U8 *buf, *end, *p, *pe;
+    U8 *fbuf, start_roles[ST_MATCH_MAX_SEPS+1], end_roles[ST_MATCH_MAX_SEPS+1];
+    STRLEN u, k, stop, flen, need, fbuf_len;
+    STRLEN starts[ST_MATCH_MAX_SEPS+1], ends[ST_MATCH_MAX_SEPS+1];
+    U32 hash;
+    I32 num_runs, max_runs, num_hits, max_hits, num_starts, num_ends;
+    I32 a, b, i, mask;
+    
+    buf      = ht->buf;
+    end      = buf + ht->len;
+    num_runs = 0;
+    max_runs = 64;
+    num_hits = 0;
+    max_hits = 64;
+    runs     = st_malloc(sizeof(st_match_run) * max_runs);
+    hits     = st_malloc(sizeof(st_match_hit) * max_hits);
+    fbuf_len = 64;
+    fbuf     = st_malloc(fbuf_len);
+    mask     = tm->size - 1;
+    
+    p = buf;
+    while (p < end) {
+        if (!ST_IS_WORD_SEP(p) && !st_word_char_len(p, end, ST_SCAN_UTF8)) {
+            p += UTF8SKIP(p);
+            continue;
+        }
+        if (num_runs == max_runs) {
+            max_runs *= 2;
+            runs = st_realloc(runs, sizeof(st_match_run) * max_runs);
+        }
+        run = &runs[num_runs++];
+        run->s = p - buf;
+        while (p < end) {
+            if (ST_IS_WORD_SEP(p)) {
+                p++;
+            }
+            else if ((u = st_word_char_len(p, end, ST_SCAN_UTF8))) {
+                p += u;
+            }
+            else {
+                break;
+            }
+        }
+        run->e  = p - buf;
+        run->is = ST_IS_WORD_SEP(buf + run->s) ? run->s + 1 : run->s;
+        run->ie = run->e;
+        while (run->ie > run->is && ST_IS_WORD_SEP(buf + run->ie - 1)) {
+            run->ie--;
+        }
+        run->first_hit = num_hits;
+        run->num_hits  = 0;
+        if (run->ie == run->is) {
+            continue;
+        }
+        
+        starts[0]      = run->is;
+        start_roles[0] = ST_MATCH_FIRST | ST_MATCH_INNER;
+        ends[0]        = run->ie;
+        end_roles[0]   = ST_MATCH_LAST | ST_MATCH_MID;
+        num_starts     = 1;
+        num_ends       = 1;
+        for (k = run->is + UTF8SKIP(buf + run->is); k < run->ie;
+             k += UTF8SKIP(buf + k)
+        ) {
+            if (num_starts <= ST_MATCH_MAX_SEPS
+                && ((ST_IS_WORD_SEP(buf + k - 1) && !ST_IS_WORD_SEP(buf + k))
+                    || (ht->points[k] & (ST_HTML_TAG | ST_HTML_AFTER_ENT)))
+            ) {
+                starts[num_starts]        = k;
+                start_roles[num_starts++] = ST_MATCH_FIRST;
+            }
+            if (num_ends <= ST_MATCH_MAX_SEPS
+                && ((ST_IS_WORD_SEP(buf + k) && !ST_IS_WORD_SEP(buf + k - 1))
+                    || (ht->points[k] & (ST_HTML_TAG | ST_HTML_ENT)))
+            ) {
+                ends[num_ends]        = k;
+                end_roles[num_ends++] = ST_MATCH_LAST;
+            }
+        }
+        
+        for (a = 0; a < num_starts; a++) {
+            for (b = 0; b < num_ends; b++) {
+                if (ends[b] <= starts[a]
+                    || ends[b] - starts[a] > tm->max_len * 3
+                ) {
+                    continue;
+                }
+                need = (UTF8_MAXBYTES_CASE * (ends[b] - starts[a])) + 1;
+                if (need > fbuf_len) {
+                    fbuf     = st_realloc(fbuf, need);
+                    fbuf_len = need;
+                }
+                flen = st_fold_utf8(buf + starts[a], ends[b] - starts[a], fbuf);
+                if (flen > tm->max_len) {
+                    continue;
+                }
+                hash = st_hash(fbuf, flen);
+                i = hash & mask;
+                while (tm->table[i].str != NULL) {
+                    if (tm->table[i].hash == hash
+                        && tm->table[i].len == flen
+                        && memEQ(tm->table[i].str, fbuf, flen)
+                    ) {
+                        st_push_match_hit(&hits, &num_hits, &max_hits,
+                            tm->table[i].term, tm->table[i].pos, 0,
+                            starts[a], ends[b], start_roles[a] | end_roles[b]);
+                    }
+                    i = (i + 1) & mask;
+                }
+            }
+        }
+        
+        /* a wildcard takes the rest of the run, up to a tag or entity */
+        for (i = 0; i < tm->num_prefixes; i++) {
+            for (a = 0; a < num_starts; a++) {
+                pe = st_fold_prefix_end(buf + starts[a], buf + run->e,
+                        tm->prefixes[i].str, tm->prefixes[i].len, 0);
+                if (pe == NULL) {
+                    continue;
+                }
+                for (stop = pe - buf; stop < run->e; stop += UTF8SKIP(buf + stop)) {
+                    if (ht->points[stop] & (ST_HTML_TAG | ST_HTML_ENT)) {
+                        break;
+                    }
+                }
+                st_push_match_hit(&hits, &num_hits, &max_hits,
+                    tm->prefixes[i].term, tm->prefixes[i].pos, 1,
+                    starts[a], stop, start_roles[a] | ST_MATCH_LAST
+                        | (stop == run->e ? ST_MATCH_MID : 0));
+            }
+        }
+        run->num_hits = num_hits - run->first_hit;
+    }
+    
+    free(fbuf);
+    *runs_ptr = runs;
+    *hits_ptr = hits;
+    return num_runs;
+}
+
+static int
+st_html_span_cmp(const void *a, const void *b)
+{
+    const st_html_span *sa = (const st_html_span*)a;
+    const st_html_span *sb = (const st_html_span*)b;
+    if (sa->start != sb->start) {
+        return sa->start < sb->start ? -1 : 1;
+    }
+    if (sa->end != sb->end) {
+        return sa->end > sb->end ? -1 : 1;
+    }
+    return sa->order - sb->order;
+}
+
+/*
+    Hilites the terms in html, in order. The html is decoded once and
+    each term matched against the decoded text, from left to right
+    without overlapping itself. A match crossing the bounds of a term
+    hilited before it is skipped, so hilites nest. Where a hilite holds
+    tags, it is closed before them and opened again after.
+    
+    Byte strings come back upgraded if they have 8-bit chars.
+    Returns a new SV, or NULL if a term is left to its regex.
+*/
+static SV*
+st_term_matcher_hilite_html(
+    st_term_matcher *tm,
+    SV *text,
+    AV *order,
+    AV *open_tags,
+    AV *close_tags,
+    HV *entities
+)
+{
+    dTHX;
+    
+    const U8 *buf;
+    STRLEN len, pos, next, x, last_end;
+    st_html_text *ht;
+    st_match_run *runs;
+    st_match_hit *hits, *hit, *word, *prev;
+    st_html_span *occ, *spans;
+    char *marked;
+    I32 *terms, *stack, num_runs, num_order, num_occ, max_occ;
+    I32 num_spans, max_spans, k, n, r, j, h, w, o, t, depth;
+    SV *lit;
+    
+    buf = (U8*)SvPV(text, len);
+    if (!SvUTF8(text) && !st_char_is_ascii((unsigned char*)buf, len)) {
+        /* 8-bit chars are Latin-1, as they are to the html regexes */
+        text = sv_2mortal(newSVsv(text));
+        sv_utf8_upgrade(text);
+        buf  = (U8*)SvPV(text, len);
+    }
+    num_order = av_len(order) + 1;
+    if (av_len(open_tags) + 1 < num_order
+        || av_len(close_tags) + 1 < num_order
+    ) {
+        ST_CROAK("need an open and close tag for each term");
+    }
+    terms = st_malloc(sizeof(I32) * (num_order ? num_order : 1));
+    for (k = 0; k < num_order; k++) {
+        terms[k] = SvIV(st_av_fetch(order, k));
+        if (terms[k] < 0 || terms[k] >= tm->num_terms
+            || !tm->num_words[terms[k]]
+        ) {
+            free(terms);
+            return NULL;
+        }
+    }
+    
+    ht        = st_new_html_text(buf, len, SvUTF8(text), entities);
+    num_runs  = st_term_matcher_html_runs(tm, ht, &runs, &hits);
+    marked    = st_malloc(ht->len + 1);
+    Zero(marked, ht->len + 1, char);
+    max_occ   = 16;
+    occ       = st_malloc(sizeof(st_html_span) * max_occ);
+    num_spans = 0;
+    max_spans = 16;
+    spans     = st_malloc(sizeof(st_html_span) * max_spans);
+    
+    for (k = 0; k < num_order; k++) {
+        n       = tm->num_words[terms[k]];
+        num_occ = 0;
+        for (r = 0; r + n <= num_runs; r++) {
+            for (h = runs[r].first_hit; h < runs[r].first_hit + runs[r].num_hits; h++) {
+                hit = &hits[h];
+                if (hit->term != terms[k] || hit->pos != 0
+                    || !(hit->roles & ST_MATCH_FIRST)
+                    || !(hit->roles & (n == 1 ? ST_MATCH_LAST : ST_MATCH_MID))
+                ) {
+                    continue;
+                }
+                word = hit;
+                for (j = 1; word != NULL && j < n; j++) {
+                    prev = word;
+                    word = NULL;
+                    for (w = runs[r + j].first_hit;
+                         w < runs[r + j].first_hit + runs[r + j].num_hits;
+                         w++
+                    ) {
+                        if (hits[w].term == terms[k] && hits[w].pos == j
+                            && (hits[w].roles & ST_MATCH_INNER)
+                            && (hits[w].roles & (j == n - 1 ? ST_MATCH_LAST : ST_MATCH_MID))
+                        ) {
+                            word = &hits[w];
+                            break;
+                        }
+                    }
+                    /* a phrase does not cross a block tag */
+                    for (x = prev->end; word != NULL && x < word->start; x++) {
+                        if (ht->points[x] & ST_HTML_BREAK) {
+                            word = NULL;
+                        }
+                    }
+                }
+                if (word == NULL) {
+                    continue;
+                }
+                if (num_occ == max_occ) {
+                    max_occ *= 2;
+                    occ = st_realloc(occ, sizeof(st_html_span) * max_occ);
+                }
+                occ[num_occ].start = hit->start;
+                occ[num_occ].end   = word->end;
+                occ[num_occ].order = k;
+                num_occ++;
+            }
+        }
+        qsort(occ, num_occ, sizeof(st_html_span), st_html_span_cmp);
+        
+        last_end = 0;
+        for (o = 0; o < num_occ; o++) {
+            if (occ[o].start < last_end) {
+                continue;
+            }
+            for (x = occ[o].start + 1; x < occ[o].end && !marked[x]; x++) {
+                /* crosses an earlier hilite? */
+            }
+            if (x < occ[o].end) {
+                continue;
+            }
+            last_end = occ[o].end;
+            marked[occ[o].start] = 1;
+            marked[occ[o].end]   = 1;
+            if (num_spans == max_spans) {
+                max_spans *= 2;
+                spans = st_realloc(spans, sizeof(st_html_span) * max_spans);
+            }
+            spans[num_spans].start = ht->from[occ[o].start];
+            spans[num_spans].end   = ht->to[occ[o].end - 1];
+            spans[num_spans].order = k;
+            num_spans++;
+        }
+    }
+    qsort(spans, num_spans, sizeof(st_html_span), st_html_span_cmp);
+    
+    /* copy the html with the hilite tags, closing open hilites
+     * around any tags in them */
+    lit = newSV(len + 1);
+    sv_setpvn(lit, "", 0);
+    if (SvUTF8(text)) {
+        SvUTF8_on(lit);
+    }
+    stack = st_malloc(sizeof(I32) * (num_spans ? num_spans : 1));
+    depth = 0;
+    pos   = 0;
+    o     = 0;
+    t     = 0;
+    for (;;) {
+        while (depth && spans[stack[depth - 1]].end == pos) {
+            depth--;
+            sv_catsv(lit, st_av_fetch(close_tags, spans[stack[depth]].order));
+        }
+        while (o < num_spans && spans[o].start == pos) {
+            sv_catsv(lit, st_av_fetch(open_tags, spans[o].order));
+            stack[depth++] = o++;
+        }
+        while (t < ht->num_tags && ht->tags[t].start < pos) {
+            t++;
+        }
+        if (depth && t < ht->num_tags && ht->tags[t].start == pos) {
+            for (j = depth - 1; j >= 0; j--) {
+                sv_catsv(lit, st_av_fetch(close_tags, spans[stack[j]].order));
+            }
+            while (t < ht->num_tags && ht->tags[t].start == pos) {
+                sv_catpvn(lit, (char*)buf + pos, ht->tags[t].end - pos);
+                pos = ht->tags[t++].end;
+            }
+            for (j = 0; j < depth; j++) {
+                sv_catsv(lit, st_av_fetch(open_tags, spans[stack[j]].order));
+            }
+            continue;
+        }
+        if (pos >= len) {
+            break;
+        }
+        next = len;
+        if (depth && spans[stack[depth - 1]].end < next) {
+            next = spans[stack[depth - 1]].end;
+        }
+        if (o < num_spans && spans[o].start < next) {
+            next = spans[o].start;
+        }
+        if (depth && t < ht->num_tags && ht->tags[t].start < next) {
+            next = ht->tags[t].start;
+        }
+        sv_catpvn(lit, (char*)buf + pos, next - pos);
+        pos = next;
+    }
+    
+    free(terms);
+    free(runs);
+    free(hits);
+    free(marked);
+    free(occ);
+    free(spans);
+    free(stack);
+    st_free_html_text(ht);
+    return lit;
+}
+
+static void
+st_free_term_matcher(st_term_matcher *tm)
+{
+    dTHX;
+    I32 i;
+    
+    if (tm->ref_cnt != 0) {
+        ST_CROAK("Won't free term_matcher %p with ref_cnt != 0 [%" IVdf "]", 
+            tm, tm->ref_cnt);
+    }
+    for (i = 0; i < tm->size; i++) {
+        if (tm->table[i].str != NULL) {
+            free(tm->table[i].str);
+        }
+    }
+    for (i = 0; i < tm->num_prefixes; i++) {
+        free(tm->prefixes[i].str);
+    }
+    free(tm->table);
+    if (tm->prefixes != NULL) {
+        free(tm->prefixes);
+    }
+    free(tm->num_words);
+    free(tm->multi_fold);
+    free(tm);
 }
@@ -8,15 +8,46 @@
  * Search::Tools C helpers
  */
 
-#define ST_CROAK(args, ...) st_croak(__FILE__, __LINE__, FUNCTION__, args)
+#define ST_CROAK(...) st_croak(__FILE__, __LINE__, FUNCTION__, __VA_ARGS__)
+
+#include <setjmp.h>
+#ifdef ST_HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #define ST_DEBUG            SvIV(get_sv("Search::Tools::XS_DEBUG", GV_ADD))
 #define ST_CLASS_TOKEN      "Search::Tools::Token"
 #define ST_CLASS_TOKENLIST  "Search::Tools::TokenList"
+#define ST_CLASS_TERMSET    "Search::Tools::TermSet"
+#define ST_CLASS_TERMMATCHER "Search::Tools::TermMatcher"
+#define ST_CLASS_TOKENSTREAM "Search::Tools::TokenStream"
+
+/* st_classify_buf() flags */
+#define ST_BUF_ASCII        1
+#define ST_BUF_LATIN1       2
+#define ST_BUF_UTF8         4
+
+/* AVX2 kernels are compiled with a target attribute and used only if
+ * the CPU reports AVX2 at runtime */
+#if defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__)) && defined(__x86_64__)
+#define ST_HAVE_AVX2        1
+#else
+#define ST_HAVE_AVX2        0
+#endif
+/* Search::Tools::Tokenizer default re, scanned in C by st_scan_word() */
+#define ST_DEFAULT_TOKEN_RE "\\w+(?:[\\'\\-\\.]\\w+)*"
+/* Search::Tools::QueryParser default term_re, the same without the dot */
+#define ST_QUERY_TERM_RE    "\\w+(?:[\\'\\-]\\w+)*"
+#define ST_SCAN_NONE        0   /* use pregexec() */
+#define ST_SCAN_ASCII       1   /* byte string, \w is [A-Za-z0-9_] */
+#define ST_SCAN_LATIN1      2   /* byte string under /u */
+#define ST_SCAN_UTF8        3   /* UTF-8 string, Unicode \w */
+#define ST_SCAN_NO_DOT      0x10    /* or'd in for ST_QUERY_TERM_RE */
+#define ST_SCAN_CLASS(m)    ((m) & 0x0f)
 #define ST_BAD_UTF8 "str must be UTF-8 encoded and flagged by Perl. \
 See the Search::Tools::to_utf8() function."
 
-static char *en_abbrevs[] = {
+static const char *en_abbrevs[] = {
 "adm",
 "al",
 "ala",
@@ -27,7 +58,6 @@ static char *en_abbrevs[] = {
 "ark",
 "assn",
 "attys",
-"attys",
 "aug",
 "ave",
 "bld",
@@ -41,7 +71,6 @@ static char *en_abbrevs[] = {
 "cmdr",
 "co",
 "col",
-"col",
 "colo",
 "conn",
 "corp",
@@ -87,7 +116,6 @@ static char *en_abbrevs[] = {
 "ken",
 "ky",
 "la",
-"la",
 "lt",
 "ltd",
 "maj",
@@ -161,59 +189,621 @@ static char *en_abbrevs[] = {
 NULL    // must be last
 };
 
+static const char *de_abbrevs[] = {
+"abs",
+"abt",
+"allg",
+"anm",
+"apr",
+"aufl",
+"aug",
+"bd",
+"betr",
+"bsp",
+"bspw",
+"bzgl",
+"bzw",
+"ca",
+"chr",
+"d.h",
+"dez",
+"dgl",
+"dipl",
+"dr",
+"ebd",
+"evtl",
+"fa",
+"feb",
+"frl",
+"geb",
+"gegr",
+"ggf",
+"hbf",
+"hr",
+"hrn",
+"hrsg",
+"i.a",
+"inkl",
+"jan",
+"jh",
+"jhd",
+"kap",
+"kfm",
+"lfd",
+"mio",
+"mrd",
+"nov",
+"nr",
+"o.\xc3\xa4",
+"okt",
+"pkt",
+"prof",
+"rd",
+"s.o",
+"s.u",
+"sep",
+"sept",
+"sog",
+"st",
+"std",
+"str",
+"tel",
+"u.a",
+"u.\xc3\xa4",
+"usw",
+"vgl",
+"z.b",
+"z.t",
+"z.zt",
+"zzgl",
+NULL    // must be last
+};
+
+static const char *fr_abbrevs[] = {
+"adj",
+"apr",
+"av",
+"avr",
+"bd",
+"boul",
+"cf",
+"chap",
+"cie",
+"coll",
+"d\xc3\xa9" "c",
+"dr",
+"\xc3\xa9" "d",
+"env",
+"etc",
+"ex",
+"f\xc3\xa9vr",
+"fig",
+"hab",
+"janv",
+"jr",
+"juil",
+"m",
+"me",
+"mgr",
+"mlle",
+"mlles",
+"mm",
+"mme",
+"mmes",
+"nov",
+"oct",
+"p",
+"p.ex",
+"pp",
+"prof",
+"qqch",
+"qqn",
+"s.v.p",
+"sept",
+"st",
+"ste",
+"st\xc3\xa9",
+"t\xc3\xa9l",
+"vol",
+"vs",
+NULL    // must be last
+};
+
+static const char *es_abbrevs[] = {
+"a.c",
+"a.m",
+"abr",
+"adm\xc3\xb3n",
+"ago",
+"apdo",
+"atte",
+"av",
+"avda",
+"cap",
+"cf",
+"c\xc3\xad" "a",
+"d.c",
+"dic",
+"d\xc3\xb1" "a",
+"dr",
+"dra",
+"dto",
+"ej",
+"ene",
+"etc",
+"fdo",
+"feb",
+"gral",
+"hnos",
+"ing",
+"jr",
+"lic",
+"nov",
+"n\xc3\xbam",
+"oct",
+"p.ej",
+"p.m",
+"p\xc3\xa1g",
+"pp",
+"prof",
+"pta",
+"ptas",
+"sept",
+"sr",
+"sra",
+"sras",
+"sres",
+"srta",
+"sta",
+"sto",
+"tel",
+"tfno",
+"ud",
+"uds",
+"vd",
+"vds",
+"vol",
+"vs",
+NULL    // must be last
+};
+
+/* abbreviation sets compiled at boot, see st_init_abbrevs() */
+static const struct { const char *lang; const char **words; } st_builtin_abbrevs[] = {
+    { "en", en_abbrevs },
+    { "de", de_abbrevs },
+    { "fr", fr_abbrevs },
+    { "es", es_abbrevs },
+    { NULL, NULL }
+};
+#define ST_MAX_ABBREV_BYTES 32  /* longest abbreviation, case folded */
+
+/* the named entities of Search::Tools::XML %HTML_ents, sorted by name
+ * for st_html_ent_lookup(). t/58-unescape.t checks they agree. */
+static const struct { const char *name; U32 cp; } st_html_ents[] = {
+    { "AElig", 198 }, { "Aacute", 193 }, { "Acirc", 194 },
+    { "Agrave", 192 }, { "Alpha", 913 }, { "Aring", 197 },
+    { "Atilde", 195 }, { "Auml", 196 }, { "Beta", 914 }, { "Ccedil", 199 },
+    { "Chi", 935 }, { "Dagger", 8225 }, { "Delta", 916 }, { "ETH", 208 },
+    { "Eacute", 201 }, { "Ecirc", 202 }, { "Egrave", 200 },
+    { "Epsilon", 917 }, { "Eta", 919 }, { "Euml", 203 }, { "Gamma", 915 },
+    { "Iacute", 205 }, { "Icirc", 206 }, { "Igrave", 204 }, { "Iota", 921 },
+    { "Iuml", 207 }, { "Kappa", 922 }, { "Lambda", 923 }, { "Mu", 924 },
+    { "Ntilde", 209 }, { "Nu", 925 }, { "OElig", 338 }, { "Oacute", 211 },
+    { "Ocirc", 212 }, { "Ograve", 210 }, { "Omega", 937 },
+    { "Omicron", 927 }, { "Oslash", 216 }, { "Otilde", 213 },
+    { "Ouml", 214 }, { "Phi", 934 }, { "Pi", 928 }, { "Prime", 8243 },
+    { "Psi", 936 }, { "Rho", 929 }, { "Scaron", 352 }, { "Sigma", 931 },
+    { "THORN", 222 }, { "Tau", 932 }, { "Theta", 920 }, { "Uacute", 218 },
+    { "Ucirc", 219 }, { "Ugrave", 217 }, { "Upsilon", 933 },
+    { "Uuml", 220 }, { "Xi", 926 }, { "Yacute", 221 }, { "Yuml", 376 },
+    { "Zeta", 918 }, { "aacute", 225 }, { "acirc", 226 }, { "acute", 180 },
+    { "aelig", 230 }, { "agrave", 224 }, { "alefsym", 8501 },
+    { "alpha", 945 }, { "amp", 38 }, { "and", 8743 }, { "ang", 8736 },
+    { "apos", 39 }, { "aring", 229 }, { "asymp", 8776 }, { "atilde", 227 },
+    { "auml", 228 }, { "bdquo", 8222 }, { "beta", 946 }, { "brvbar", 166 },
+    { "bull", 8226 }, { "cap", 8745 }, { "ccedil", 231 }, { "cedil", 184 },
+    { "cent", 162 }, { "chi", 967 }, { "circ", 710 }, { "clubs", 9827 },
+    { "cong", 8773 }, { "copy", 169 }, { "crarr", 8629 }, { "cup", 8746 },
+    { "curren", 164 }, { "dArr", 8659 }, { "dagger", 8224 },
+    { "darr", 8595 }, { "deg", 176 }, { "delta", 948 }, { "diams", 9830 },
+    { "divide", 247 }, { "eacute", 233 }, { "ecirc", 234 },
+    { "egrave", 232 }, { "empty", 8709 }, { "emsp", 8195 },
+    { "ensp", 8194 }, { "epsilon", 949 }, { "equiv", 8801 }, { "eta", 951 },
+    { "eth", 240 }, { "euml", 235 }, { "euro", 8364 }, { "exist", 8707 },
+    { "fnof", 402 }, { "forall", 8704 }, { "frac12", 189 },
+    { "frac14", 188 }, { "frac34", 190 }, { "frasl", 8260 },
+    { "gamma", 947 }, { "ge", 8805 }, { "gt", 62 }, { "hArr", 8660 },
+    { "harr", 8596 }, { "hearts", 9829 }, { "hellip", 8230 },
+    { "iacute", 237 }, { "icirc", 238 }, { "iexcl", 161 },
+    { "igrave", 236 }, { "image", 8465 }, { "infin", 8734 },
+    { "int", 8747 }, { "iota", 953 }, { "iquest", 191 }, { "isin", 8712 },
+    { "iuml", 239 }, { "kappa", 954 }, { "lArr", 8656 }, { "lambda", 955 },
+    { "lang", 9001 }, { "laquo", 171 }, { "larr", 8592 }, { "lceil", 8968 },
+    { "ldquo", 8220 }, { "le", 8804 }, { "lfloor", 8970 },
+    { "lowast", 8727 }, { "loz", 9674 }, { "lrm", 8206 },
+    { "lsaquo", 8249 }, { "lsquo", 8216 }, { "lt", 60 }, { "macr", 175 },
+    { "mdash", 8212 }, { "micro", 181 }, { "middot", 183 },
+    { "minus", 8722 }, { "mu", 956 }, { "nabla", 8711 }, { "nbsp", 160 },
+    { "ndash", 8211 }, { "ne", 8800 }, { "ni", 8715 }, { "not", 172 },
+    { "notin", 8713 }, { "nsub", 8836 }, { "ntilde", 241 }, { "nu", 957 },
+    { "oacute", 243 }, { "ocirc", 244 }, { "oelig", 339 },
+    { "ograve", 242 }, { "oline", 8254 }, { "omega", 969 },
+    { "omicron", 959 }, { "oplus", 8853 }, { "or", 8744 }, { "ordf", 170 },
+    { "ordm", 186 }, { "oslash", 248 }, { "otilde", 245 },
+    { "otimes", 8855 }, { "ouml", 246 }, { "para", 182 }, { "part", 8706 },
+    { "permil", 8240 }, { "perp", 8869 }, { "phi", 966 }, { "pi", 960 },
+    { "piv", 982 }, { "plusmn", 177 }, { "pound", 163 }, { "prime", 8242 },
+    { "prod", 8719 }, { "prop", 8733 }, { "psi", 968 }, { "quot", 34 },
+    { "rArr", 8658 }, { "radic", 8730 }, { "rang", 9002 }, { "raquo", 187 },
+    { "rarr", 8594 }, { "rceil", 8969 }, { "rdquo", 8221 },
+    { "real", 8476 }, { "reg", 174 }, { "rfloor", 8971 }, { "rho", 961 },
+    { "rlm", 8207 }, { "rsaquo", 8250 }, { "rsquo", 8217 },
+    { "sbquo", 8218 }, { "scaron", 353 }, { "sdot", 8901 }, { "sect", 167 },
+    { "shy", 173 }, { "sigma", 963 }, { "sigmaf", 962 }, { "sim", 8764 },
+    { "spades", 9824 }, { "sub", 8834 }, { "sube", 8838 }, { "sum", 8721 },
+    { "sup", 8835 }, { "sup1", 185 }, { "sup2", 178 }, { "sup3", 179 },
+    { "supe", 8839 }, { "szlig", 223 }, { "tau", 964 }, { "there4", 8756 },
+    { "theta", 952 }, { "thetasym", 977 }, { "thinsp", 8201 },
+    { "thorn", 254 }, { "tilde", 732 }, { "times", 215 }, { "trade", 8482 },
+    { "uArr", 8657 }, { "uacute", 250 }, { "uarr", 8593 }, { "ucirc", 251 },
+    { "ugrave", 249 }, { "uml", 168 }, { "upsih", 978 }, { "upsilon", 965 },
+    { "uuml", 252 }, { "weierp", 8472 }, { "xi", 958 }, { "yacute", 253 },
+    { "yen", 165 }, { "yuml", 255 }, { "zeta", 950 }, { "zwj", 8205 },
+    { "zwnj", 8204 },
+};
+#define ST_NUM_HTML_ENTS (I32)(sizeof(st_html_ents) / sizeof(st_html_ents[0]))
+#define ST_MAX_LANG_LEN     15
+
 typedef char    boolean;
 typedef struct  st_token st_token;
 typedef struct  st_token_list st_token_list;
+/* a Search::Tools::Token object: a handle on one slot of its list.
+ * Handles live in blocks owned by the list, allocated only for
+ * positions Perl asks for; handle N is at handles[N >> SHIFT][N & MASK].
+ */
 struct st_token {
-    I32             pos;        /* position in buffer */
-    I32             len;        /* token length (bytes) */
-    I32             u8len;      /* token length (utf8 chars) */
-    SV             *str;        /* SV* for the string */
-    I32             is_hot;     /* interesting token flag */
-    boolean         is_sentence_start;  /* looks like the start of a sentence */
-    boolean         is_sentence_end;    /* looks like the end of a sentence */
-    boolean         is_abbreviation;    /* looks like abbreviation */
-    boolean         is_match;   /* matched regex */
-    IV              ref_cnt;    /* reference counter */
+    st_token_list  *list;       /* list that holds this token */
+    I32             pos;        /* position in list */
 };
+
+#define ST_TOKEN_BLOCK_SHIFT    8
+#define ST_TOKEN_BLOCK_SIZE     (1 << ST_TOKEN_BLOCK_SHIFT)
+#define ST_TOKEN_BLOCK_MASK     (ST_TOKEN_BLOCK_SIZE - 1)
+
+/* st_token_list bits[] flag sets, one bit per token.
+ * The macros evaluate their arguments more than once.
+ */
+#define ST_TOKEN_MATCH          0   /* matched regex */
+#define ST_TOKEN_SENTENCE_START 1   /* looks like the start of a sentence */
+#define ST_TOKEN_SENTENCE_END   2   /* looks like the end of a sentence */
+#define ST_TOKEN_ABBREVIATION   3   /* looks like abbreviation */
+#define ST_TOKEN_NUM_FLAGS      4
+#define ST_TOKEN_FLAG(tl, i, f) \
+    ((int)(((tl)->bits[f][(i) >> 6] >> ((i) & 63)) & 1))
+#define ST_TOKEN_SET_FLAG(tl, i, f) \
+    ((tl)->bits[f][(i) >> 6] |= ((U64)1 << ((i) & 63)))
+#define ST_TOKEN_CLEAR_FLAG(tl, i, f) \
+    ((tl)->bits[f][(i) >> 6] &= ~((U64)1 << ((i) & 63)))
+
+/* tokens are stored as parallel arrays (one entry per token) rather
+ * than one struct per token, so scans over a single attribute
+ * walk contiguous memory. Flags are bitsets, so counting matches
+ * is a popcount and finding hot tokens skips 64 at a time.
+ * The arrays grow by doubling; nothing points into them.
+ */
 struct st_token_list {
     I32             pos;        /* current iterator position (array index) */
     I32             num;        /* number of parsed tokens */
-    AV             *tokens;     /* array of st_token objects */
-    AV             *heat;       /* array of positions of is_hot tokens */
-    AV             *sentence_starts;  /* array of sentence start positions */
+    AV             *tokens;     /* array of st_token objects, created lazily */
+
+    SV             *buf;        /* the tokenized string, shared by all tokens */
+    I32            *offset;     /* start of token in buf (bytes) */
+    I32            *len;        /* token length (bytes) */
+    I32            *u8len;      /* token length (utf8 chars) */
+    I32            *hot;        /* is_hot value */
+    U64            *bits[ST_TOKEN_NUM_FLAGS];   /* ST_TOKEN_* bitsets */
+    I32            *heat;       /* positions of tokens hot when tokenized */
+    I32            *sentence_starts;  /* sentence start for each heat position */
+    I32             num_hot;    /* length of heat and sentence_starts */
+    I32             max_hot;    /* allocated length of heat and sentence_starts */
+    I32             max;        /* allocated length of the arrays */
+    st_token      **handles;    /* blocks of Token handles, NULL until used */
+    I32             num_blocks; /* size of the handles array */
     IV              ref_cnt;    /* reference counter */
 };
 
-static st_token*    
+/* a set of case-folded query words, for checking tokens without
+ * the regex engine. Plain words live in an open-addressed hash table,
+ * words containing the wildcard are kept as glob patterns.
+ */
+typedef struct  st_term st_term;
+typedef struct  st_term_set st_term_set;
+struct st_term {
+    U8             *str;        /* folded UTF-8 bytes, NUL terminated */
+    STRLEN          len;        /* length of str (bytes) */
+    U32             hash;       /* cached hash of str */
+};
+struct st_term_set {
+    st_term        *table;      /* hash table of plain words */
+    I32             size;       /* slots in table (power of 2) */
+    I32             num;        /* number of plain words */
+    st_term        *globs;      /* words containing the wildcard */
+    I32             num_globs;  /* number of globs */
+    U8              wildcard;   /* wildcard byte, e.g. '*' */
+    IV              ref_cnt;    /* reference counter */
+};
+
+/* the words of the query terms for st_term_matcher_match(). A term is
+ * a phrase of up to 64 words; a word may end with the wildcard.
+ */
+typedef struct  st_match_word st_match_word;
+typedef struct  st_term_matcher st_term_matcher;
+struct st_match_word {
+    U8             *str;        /* folded UTF-8 bytes, NUL terminated */
+    STRLEN          len;        /* length of str (bytes) */
+    U32             hash;       /* cached hash of str */
+    I32             term;       /* index of the term */
+    I32             pos;        /* position of the word in the term */
+    boolean         ascii;      /* was the word ASCII before folding? */
+};
+struct st_term_matcher {
+    st_match_word  *table;      /* hash table of words, may repeat */
+    I32             size;       /* slots in table (power of 2) */
+    I32             num;        /* number of words in table */
+    STRLEN          max_len;    /* longest word in table (bytes) */
+    st_match_word  *prefixes;   /* words ending with the wildcard */
+    I32             num_prefixes;
+    I32            *num_words;  /* per term, 0 if it needs its regex */
+    char           *multi_fold; /* per term, has a char folding to several */
+    I32             num_terms;
+    IV              ref_cnt;    /* reference counter */
+};
+
+/* a maximal run of [\w'-] in a text, and the term words it holds,
+ * for st_term_matcher_hilite()
+ */
+typedef struct  st_match_run st_match_run;
+typedef struct  st_match_hit st_match_hit;
+struct st_match_run {
+    STRLEN          s;          /* run start (byte offset) */
+    STRLEN          is;         /* word start, after a leading ' or - */
+    STRLEN          ie;         /* word end, before trailing ' and - */
+    STRLEN          e;          /* run end */
+    I32             first_hit;  /* index of its first st_match_hit */
+    I32             num_hits;
+};
+struct st_match_hit {
+    I32             term;       /* index of the term */
+    I32             pos;        /* position of the word in the term */
+    boolean         prefix;     /* matched a word ending with the wildcard */
+    STRLEN          start;      /* where the word starts (html only) */
+    STRLEN          end;        /* where the word ends (html only) */
+    U8              roles;      /* the ST_MATCH_* it may play (html only) */
+};
+/* a hilite tag to insert into the text */
+typedef struct  st_hilite_tag st_hilite_tag;
+struct st_hilite_tag {
+    STRLEN          offset;     /* byte offset in the text */
+    I32             order;      /* index of the term in the hilite order */
+    boolean         close;
+};
+/* html decoded for st_term_matcher_hilite_html(): the text with
+ * entities decoded and tags dropped, or made a space where they break
+ * the text. Each byte knows the html it came from.
+ */
+typedef struct  st_html_text st_html_text;
+typedef struct  st_html_span st_html_span;
+struct st_html_span {
+    STRLEN          start;      /* byte offset in the html */
+    STRLEN          end;
+    I32             order;      /* index of the term in the hilite order */
+};
+struct st_html_text {
+    U8             *buf;        /* decoded UTF-8 */
+    STRLEN          len;
+    STRLEN         *from;       /* per byte of buf, html offset of its char */
+    STRLEN         *to;         /* per byte of buf, html end of its char */
+    U8             *points;     /* per offset of buf, ST_HTML_* flags */
+    st_html_span   *tags;       /* tags and skipped regions of the html */
+    I32             num_tags;
+};
+
+/* where a candidate word in the text may stand in a term */
+#define ST_MATCH_FIRST      1   /* first word */
+#define ST_MATCH_INNER      2   /* after a phrase gap */
+#define ST_MATCH_LAST       4   /* last word */
+#define ST_MATCH_MID        8   /* before a phrase gap */
+#define ST_MATCH_MAX_SEPS   16  /* ' and - per run we try to split at */
+
+/* st_html_text points */
+#define ST_HTML_TAG         1   /* a tag comes just before the char */
+#define ST_HTML_ENT         2   /* the char is an entity */
+#define ST_HTML_AFTER_ENT   4   /* an entity comes just before the char */
+#define ST_HTML_BREAK       8   /* the char stands for a block tag */
+
+/* st_unescape_html() kinds */
+#define ST_ENT_NAMED        1   /* &amp; */
+#define ST_ENT_DECIMAL      2   /* &#38; */
+#define ST_ENT_HEX          4   /* &#x26; */
+
+/* a language's abbreviations, case folded and sorted for bsearch.
+ * Sets are shared by every tokenizer and live until the process exits.
+ */
+typedef struct  st_abbrevs st_abbrevs;
+struct st_abbrevs {
+    char            lang[ST_MAX_LANG_LEN+1];
+    char          **words;      /* sorted, NUL terminated */
+    IV              num;        /* number of words */
+    STRLEN          min_len;    /* shortest word (bytes) */
+    STRLEN          max_len;    /* longest word (bytes) */
+    boolean         has_utf8;   /* any word not ASCII? */
+    st_abbrevs     *next;       /* registry link */
+};
+
+/* a candidate HeatMap span, see st_heat_spans() */
+typedef struct  st_span st_span;
+struct st_span {
+    I32            *pos;        /* token positions in the span */
+    I32             num;        /* number of positions */
+    IV              heat;       /* sum of is_hot */
+    I32             unique;     /* unique (lowercased) hot strings */
+    I32             proximate;  /* hot tokens near another hot token */
+    I32             start;      /* as_sentences: the sentence start, */
+    I32             hot;        /* the hot token that found it */
+    I32             end;        /* and the sentence end */
+    I32             cluster;    /* otherwise: first tl->heat index in */
+    I32             cluster_len;    /* the cluster, and how many */
+};
+
+/* Unicode \w, fold and lowercase data above ASCII, copied once from
+ * the interpreter's own tables so that code running outside Perl
+ * (see st_snip_batch()) gets the same answers as the perl macros.
+ */
+typedef struct  st_uni_map st_uni_map;
+struct st_uni_map {
+    U32             cp;         /* code point */
+    U8              len;        /* bytes in utf8 */
+    U8              utf8[UTF8_MAXBYTES_CASE+1];   /* its mapping */
+};
+typedef struct  st_uni st_uni;
+struct st_uni {
+    UV             *word;       /* inversion list of \w above Latin-1 */
+    I32             num_word;
+    st_uni_map     *fold;       /* code points whose fold differs */
+    I32             num_fold;
+    st_uni_map     *lower;      /* code points whose lowercase differs */
+    I32             num_lower;
+};
+
+
+/* tokenize() state. st_tokenize() keeps one on the stack; 
+ * st_tokenize_batch() reuses one for every document; a
+ * Search::Tools::TokenStream keeps one between chunks, along with
+ * the bytes not yet tokenized.
+ */
+#define ST_STREAM_MAX_CARRY     (64 * 1024)
+typedef struct  st_tokenizer st_tokenizer;
+struct st_tokenizer {
+    SV             *token_re;   /* regex matching tokens */
+    REGEXP         *rx;         /* token_re, extracted once */
+    SV             *heat_seeker;    /* CODE, qr// or TermSet, may be NULL */
+    I32             match_num;  /* which capture of token_re is the token */
+    boolean         heat_seeker_is_CV;
+    st_term_set    *term_set;   /* heat_seeker, if it is a TermSet */
+    IV              debug;      /* ST_DEBUG when created */
+    IV              num;        /* tokens returned for this document so far */
+    IV              prev_sentence_start;
+    boolean         inside_sentence;
+    boolean         prev_was_abbrev;
+    st_abbrevs     *abbrevs;    /* abbreviations for the Tokenizer lang */
+    SV             *carry;      /* bytes held over for the next chunk */
+    IV              ref_cnt;    /* reference counter */
+};
+
+/* literals every match of a regex must start with, compared ASCII
+ * case insensitively, so st_heat_seeker_offsets() can skip to where
+ * a match might begin instead of running the regex over every byte.
+ */
+#define ST_PREFILTER_MAX_MEMCHR 8
+#define ST_PREFILTER_MAX_MISSES 32
+typedef struct  st_prefilter st_prefilter;
+struct st_prefilter {
+    U8            **lits;       /* lowercased */
+    STRLEN         *lens;
+    I32             num;
+    boolean         first[256]; /* first bytes of lits, either case */
+    U8              bytes[ST_PREFILTER_MAX_MEMCHR];  /* the same, for memchr */
+    const U8       *next[ST_PREFILTER_MAX_MEMCHR];   /* memchr() results */
+    I32             num_bytes;  /* 0 if too many to memchr */
+    STRLEN          max_len;    /* longest match (bytes), 0 if unbounded */
+};
+
+/* one document for st_snip_batch() */
+typedef struct  st_snip_job st_snip_job;
+struct st_snip_job {
+    st_token_list  *tl;         /* made, and freed, by the calling thread */
+    U8              scan_mode;  /* st_scan_mode() for tl->buf */
+    STRLEN         *windows;    /* byte ranges of tl->buf to tokenize, or NULL */
+    I32             num_windows;
+    st_span        *spans;      /* ranked, NULL if no heat */
+    I32             num_spans;
+};
+
+/* the jobs shared by st_snip_batch() workers */
+typedef struct  st_snip_pool st_snip_pool;
+struct st_snip_pool {
+    st_tokenizer   *st;         /* copied by each worker */
+    st_snip_job    *jobs;
+    I32             num_jobs;
+    I32             next;       /* next job to take */
+    size_t          failed_size;    /* allocation a worker could not make, or 0 */
+    IV              window;
+    boolean         as_sentences;
+#ifdef ST_HAVE_PTHREAD
+    pthread_mutex_t lock;       /* guards next and failed_size */
+#endif
+};
+
+/* what st_rank_spans() has allocated so far */
+typedef struct  st_rank_buffers st_rank_buffers;
+struct st_rank_buffers {
+    U8             *seen;
+    I32            *positions;
+    st_span        *spans;
+    I32             num_spans;  /* with pos allocated */
+    I32            *cluster_start;
+    I32            *cluster_len;
+    I32            *order;
+};
+
+/* per-thread state of a st_snip_batch_work() call */
+typedef struct  st_snip_worker st_snip_worker;
+struct st_snip_worker {
+    jmp_buf         env;        /* where st_out_of_memory() jumps to */
+    st_snip_pool   *pool;
+    st_rank_buffers rank;       /* freed if st_rank_spans() jumps */
+};
+
+static I32      
 st_new_token(
-    I32 pos, 
+    st_token_list *tl,
     I32 len,
     I32 u8len,
     const char *ptr,
-    I32 is_hot,
-    boolean is_match
+    I32 is_hot
 );
+static SV*      st_token_str(st_token *tok);
 
-static st_token_list* st_new_token_list(
-    AV *tokens,
-    AV *heat,
-    AV *sentence_starts,
-    unsigned int num
-);
+static st_token_list* st_new_token_list();
+static void     st_token_list_grow(st_token_list *tl);
+static void     st_token_list_release(st_token_list *tl);
+static const char* st_token_list_ptr(st_token_list *tl, I32 idx);
+static SV*      st_token_list_str(st_token_list *tl, I32 idx);
+static SV*      st_token_list_bless_token(st_token_list *tl, I32 idx);
+static st_token* st_token_list_token_at(st_token_list *tl, I32 idx);
+static SV*      st_token_list_fetch(st_token_list *tl, I32 idx);
+static AV*      st_token_list_as_array(st_token_list *tl);
+static IV       st_token_list_num_matches(st_token_list *tl);
+static void     st_token_list_add_heat(st_token_list *tl, I32 pos, I32 sentence_start);
+static AV*      st_i32_to_av(const I32 *ints, I32 num);
+static IV       st_bits_count(const U64 *bits, I32 end);
+static I32      st_bits_next(const U64 *bits, I32 from, I32 end);
 static void     st_dump_token_list(st_token_list *tl);
-static void     st_dump_token(st_token *tok);
+static void     st_dump_token(st_token_list *tl, I32 idx);
 
 static SV*      st_hv_store( HV* h, const char* key, SV* val );
 static SV*      st_hv_store_char( HV* h, const char* key, char *val );
-static SV*      st_hv_store_int( HV* h, const char* key, int i);
 /* UNUSED
+static SV*      st_hv_store_int( HV* h, const char* key, int i);
 static SV*      st_hvref_store_int( SV* h, const char* key, int i);
 static SV*      st_hvref_store( SV* h, const char* key, SV* val );
 static SV*      st_hvref_store_char( SV* h, const char* key, char *val );
 */
 static SV*      st_av_fetch( AV* a, I32 index );
+static IV       st_av_fetch_iv( AV *a, I32 index );
+/* UNUSED
 static void*    st_av_fetch_ptr( AV* a, I32 index );
+*/
 static SV*      st_hv_fetch( HV* h, const char* key );
 static SV*      st_hvref_fetch( SV* h, const char* key );
 /* UNUSED
@@ -225,10 +815,103 @@ static SV*      st_tokenize(
     SV* str, 
     SV* token_re, 
     SV* heat_seeker, 
-    I32 match_num 
+    I32 match_num,
+    st_abbrevs *abbrevs
+);
+static AV*      st_tokenize_batch( 
+    AV* docs, 
+    SV* token_re, 
+    SV* heat_seeker, 
+    I32 match_num,
+    st_abbrevs *abbrevs
+);
+static SV*      st_tokenize_windows( 
+    SV* str, 
+    AV* offsets,
+    IV size,
+    SV* token_re, 
+    SV* heat_seeker, 
+    I32 match_num,
+    st_abbrevs *abbrevs
+);
+static STRLEN*  st_merge_windows( const U8 *buf, STRLEN len, AV *offsets, IV size, I32 *num );
+static void     st_tokenize_window_bytes( st_tokenizer *st, st_token_list *tl, const STRLEN *windows, I32 num_windows, U8 scan_mode );
+static void     st_tokenize_check_utf8( SV* str );
+static void     st_reset_tokenizer( st_tokenizer *st );
+static void     st_init_tokenizer( st_tokenizer *st, SV *token_re, SV *heat_seeker, I32 match_num, st_abbrevs *abbrevs );
+static void     st_tokenize_gap( st_tokenizer *st, st_token_list *tl, const char *ptr, STRLEN len );
+static void     st_tokenize_match( st_tokenizer *st, st_token_list *tl, const char *ptr, STRLEN len );
+static void     st_tokenize_tail( st_tokenizer *st, st_token_list *tl, const char *ptr, STRLEN len );
+static STRLEN   st_tokenize_buf( st_tokenizer *st, st_token_list *tl, boolean final );
+static STRLEN   st_tokenize_bytes( st_tokenizer *st, st_token_list *tl, const char *buf, STRLEN str_len, U8 scan_mode, boolean final );
+static st_tokenizer* st_new_tokenizer( SV *token_re, SV *heat_seeker, I32 match_num, st_abbrevs *abbrevs );
+static void     st_free_tokenizer( st_tokenizer *st );
+static SV*      st_tokenizer_push( st_tokenizer *st, SV *chunk, boolean final );
+static I32      st_heat_seeker( st_token_list *tl, I32 idx, SV *re );
+static AV*      st_heat_spans( st_token_list *tl, IV window, boolean as_sentences );
+static void     st_score_span( st_token_list *tl, st_span *span );
+static SV*      st_span_to_hv( st_token_list *tl, st_span *span, boolean as_sentences );
+static int      st_span_cmp( const void *a, const void *b );
+static st_span* st_rank_spans( st_token_list *tl, IV window, boolean as_sentences, I32 *num_spans );
+static SV*      st_span_str( st_token_list *tl, st_span *span, boolean as_sentences );
+static void     st_free_spans( st_span *spans, I32 num_spans );
+static void     st_free_rank_buffers( st_rank_buffers *b );
+static AV*      st_snip_batch( 
+    AV* docs, 
+    AV* offsets, 
+    IV size, 
+    SV* token_re, 
+    SV* term_set, 
+    st_abbrevs *abbrevs, 
+    IV window, 
+    boolean as_sentences, 
+    I32 max_spans, 
+    I32 num_threads 
 );
-static void     st_heat_seeker( st_token *token, SV *re );
-static AV*      st_heat_seeker_offsets( SV *str, SV *re );
+static void*    st_snip_batch_work( void *pool );
+static void     st_free_snip_jobs( st_snip_job *jobs, I32 num_jobs );
+static void     st_init_uni();
+static boolean  st_uni_is_word( UV cp );
+static const st_uni_map* st_uni_find( const st_uni_map *map, I32 num, UV cp );
+static STRLEN   st_uni_case( const st_uni_map *map, I32 num, const U8 *s, STRLEN u, U8 *d );
+static U8       st_scan_mode( SV *str, SV *token_re, I32 match_num );
+static boolean  st_scan_word( const U8 *buf, const U8 *end, U8 mode, const U8 **start, const U8 **stop );
+static STRLEN   st_word_char_len( const U8 *s, const U8 *end, U8 mode );
+static st_term_set* st_new_term_set( AV *terms, U8 wildcard );
+static void     st_free_term_set( st_term_set *ts );
+static void     st_term_set_add( st_term_set *ts, const U8 *ptr, STRLEN len );
+static boolean  st_term_set_contains( st_term_set *ts, const U8 *ptr, STRLEN len );
+static st_term_matcher* st_new_term_matcher( AV *terms, U8 wildcard );
+static void     st_free_term_matcher( st_term_matcher *tm );
+static void     st_term_matcher_add( st_term_matcher *tm, const U8 *ptr, STRLEN len, I32 term, I32 pos, boolean is_prefix );
+static AV*      st_term_matcher_match( st_term_matcher *tm, SV *text, boolean html );
+static void     st_term_matcher_run( st_term_matcher *tm, const U8 *buf, STRLEN len, const U8 *s, const U8 *e, const STRLEN *seps, I32 num_seps, boolean html, U8 **fbuf, STRLEN *fbuf_len, U64 *active, U64 *next, char *hit, boolean *unsure );
+static void     st_term_matcher_hit( st_term_matcher *tm, const st_match_word *w, U8 roles, const U64 *active, U64 *next, char *hit );
+static boolean  st_fold_has_prefix( const U8 *s, const U8 *e, const U8 *prefix, STRLEN plen, boolean simple );
+static U8*      st_fold_copy( const U8 *s, STRLEN len, STRLEN *flen );
+static boolean  st_term_matcher_absent( st_term_matcher *tm, const U8 *buf, STRLEN len, char *absent );
+static I32      st_term_matcher_runs( st_term_matcher *tm, const U8 *buf, STRLEN len, U8 mode, st_match_run **runs_ptr, st_match_hit **hits_ptr );
+static SV*      st_term_matcher_hilite( st_term_matcher *tm, SV *text, AV *order, AV *open_tags, AV *close_tags );
+static int      st_hilite_tag_cmp( const void *a, const void *b );
+static const U8* st_fold_prefix_end( const U8 *s, const U8 *e, const U8 *prefix, STRLEN plen, boolean simple );
+static st_html_text* st_new_html_text( const U8 *buf, STRLEN len, boolean utf8, HV *entities );
+static void     st_free_html_text( st_html_text *ht );
+static boolean  st_html_tag_is( const U8 *name, STRLEN len, const char **names );
+static UV       st_html_entity( const U8 *s, STRLEN len, HV *entities, STRLEN *elen );
+static UV       st_html_ent_lookup( const U8 *name, STRLEN len );
+static UV       st_unescape_entity( const U8 *p, const U8 *end, U8 kinds, STRLEN *elen );
+static SV*      st_unescape_html( SV *str, U8 kinds );
+static void     st_push_match_hit( st_match_hit **hits, I32 *num, I32 *max, I32 term, I32 pos, boolean prefix, STRLEN start, STRLEN end, U8 roles );
+static I32      st_term_matcher_html_runs( st_term_matcher *tm, st_html_text *ht, st_match_run **runs_ptr, st_match_hit **hits_ptr );
+static SV*      st_term_matcher_hilite_html( st_term_matcher *tm, SV *text, AV *order, AV *open_tags, AV *close_tags, HV *entities );
+static int      st_html_span_cmp( const void *a, const void *b );
+static U32      st_hash( const U8 *ptr, STRLEN len );
+static boolean  st_glob_match( const U8 *pat, STRLEN plen, const U8 *str, STRLEN slen, U8 wildcard );
+static STRLEN   st_fold_utf8( const U8 *ptr, STRLEN len, U8 *buf );
+static AV*      st_heat_seeker_offsets( SV *str, SV *re, IV max_hits, IV max_bytes, AV *literals, IV max_len );
+static st_prefilter* st_new_prefilter( AV *literals, IV max_len );
+static void     st_free_prefilter( st_prefilter *pf );
+static const U8* st_prefilter_next( st_prefilter *pf, const U8 *s, const U8 *end );
 static REGEXP*  st_get_regex_from_sv( SV* regex_sv );
 /* UNUSED
 static SV*      st_new_hash_object(const char *class);
@@ -236,7 +919,11 @@ static SV*      st_new_hash_object(const char *class);
 static SV*      st_bless_ptr( const char* class, void * c_ptr );
 static void*    st_extract_ptr( SV* object );
 static void*    st_malloc(size_t size);
-static void     st_free_token(st_token *tok);
+static void*    st_realloc(void *ptr, size_t size);
+static void     st_out_of_memory( const char *what, size_t size );
+static void     st_set_snip_worker( st_snip_worker *worker );
+static st_snip_worker* st_get_snip_worker();
+static void     st_free_token_list(st_token_list *tl);
 static void     st_croak(
     const char *file,
     int line,
@@ -248,9 +935,25 @@ static void     st_dump_sv( SV* hash_ref );
 static void     st_describe_object( SV* object );
 static boolean  st_is_ascii( SV* str );
 static boolean  st_char_is_ascii( unsigned char* str, STRLEN len );
+static int      st_simd_level();
+static STRLEN   st_find_non_ascii( const U8 *s, STRLEN len );
+static STRLEN   st_find_c1( const U8 *s, STRLEN len );
+static int      st_classify_buf( const U8 *s, STRLEN len );
+static STRLEN   st_utf8_seq_len( const U8 *p, const U8 *end );
+static STRLEN   st_utf8_num_chars( const U8 *s, STRLEN len );
+static STRLEN   st_find_bad_utf8_offset( const U8 *s, STRLEN len );
 static SV*      st_find_bad_utf8( SV* str );
 static SV*      st_escape_xml(char *s);
-static IV       st_is_abbreviation(const unsigned char *ptr, IV len);
+static SV*      st_plain_text( SV *str, boolean strip_markup, boolean collapse_ws, STRLEN *in_chars );
+static IV       st_is_abbreviation( st_abbrevs *ab, const unsigned char *ptr, IV len );
+static void     st_init_abbrevs();
+static st_abbrevs* st_find_abbrevs( const char *lang, STRLEN len );
+static st_abbrevs* st_lang_abbrevs( SV *lang );
+static st_abbrevs* st_new_abbrevs( const char *lang, STRLEN len, st_abbrevs *base, IV size );
+static STRLEN   st_abbrev_fold( const U8 *ptr, STRLEN len, U8 *buf );
+static void     st_abbrevs_add( st_abbrevs *ab, const U8 *ptr, STRLEN len );
+static void     st_abbrevs_register( st_abbrevs *ab );
+static int      st_abbrev_cmp( const void *a, const void *b );
 static IV       st_looks_like_sentence_start(const unsigned char *ptr, IV len);
 static IV       st_looks_like_sentence_end(const unsigned char *ptr, IV len);
 static IV       st_utf8_codepoint(const unsigned char *utf8, IV len);
@@ -1,7 +1,7 @@
 #!/usr/bin/env perl
 
 use strict;
-use Test::More tests => 34;
+use Test::More tests => 49;
 
 BEGIN { use_ok('Search::Tools::UTF8') }
 
@@ -114,6 +114,40 @@ is( $cp1251_codepoints_utf8_fixed,
 
 #$Search::Tools::UTF8::Debug = 0;
 
+#####################################################################
+#
+# classify_buffer and the long-string (vectorized) paths
+#
+
+is_deeply( [ classify_buffer("plain ascii") ], [ 1, 1, 1 ],
+    "classify_buffer ascii" );
+is_deeply( [ classify_buffer($latin1) ], [ 0, 1, 0 ],
+    "classify_buffer latin1" );
+is_deeply( [ classify_buffer($moreamb) ], [ 0, 0, 1 ],
+    "classify_buffer utf8" );
+is_deeply( [ classify_buffer($nonsense) ], [ 0, 0, 0 ],
+    "classify_buffer nonsense" );
+
+my $pad = "x" x 100;
+is( find_bad_ascii( $pad . "\xe9" ),        100, "find_bad_ascii long" );
+is( find_bad_latin1( $pad . "\xe9\x{85}" ), 101, "find_bad_latin1 long" );
+ok( !is_latin1( $pad . "\x{9f}" . $pad ), "!is_latin1 long" );
+ok( is_ascii( $pad x 10 ), "is_ascii long" );
+is_deeply( [ classify_buffer( $pad . "\xc3\x81" . $pad . "\xc0\xaf" ) ],
+    [ 0, 0, 0 ], "classify_buffer overlong after valid utf8" );
+
+# find_bad_utf8_offset
+is( find_bad_utf8_offset($moreamb),  -1, "find_bad_utf8_offset valid" );
+is( find_bad_utf8_offset($nonsense), 0,  "find_bad_utf8_offset nonsense" );
+is( find_bad_utf8_offset( $pad . "\xe6\x9d\xb1\xe6\x9d" ),
+    103, "find_bad_utf8_offset truncated sequence" );
+is( find_bad_utf8_offset( $pad . "\xe0\x80\x80" ), 100,
+    "find_bad_utf8_offset overlong" );
+is( find_bad_utf8_offset("\xed\xa0\x80 \xef\xbf\xbf"),
+    -1, "surrogates and noncharacters pass, as with is_utf8_string()" );
+is( find_bad_utf8( $pad . "\xc3 tail" ), "\xc3 tail",
+    "find_bad_utf8 returns the bytes from the bad offset" );
+
 if ( $ENV{PERL_TEST} ) {
     diag("cp1251_codepoints_utf8 $cp1251_codepoints_utf8");
     debug_bytes($cp1251_codepoints_utf8);
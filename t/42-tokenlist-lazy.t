@@ -0,0 +1,80 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Test::More tests => 26;
+use Scalar::Util qw( refaddr );
+
+use_ok('Search::Tools::Tokenizer');
+
+my $str = "the quick brown fox. the lazy dog!";
+
+ok( my $tokenizer = Search::Tools::Tokenizer->new, "new tokenizer" );
+ok( my $tokens = $tokenizer->tokenize( $str, qr/^(fox|dog)$/ ),
+    "tokenize" );
+
+# Token objects are created on demand
+my $tok = $tokens->get_token(6);
+is( "$tok", "fox", "get_token(6)" );
+is( refaddr($tok), refaddr( $tokens->get_token(6) ),
+    "get_token returns the same object twice" );
+is( $tokens->get_token(-1)->str, "!", "get_token(-1) is last token" );
+ok( !defined $tokens->get_token( $tokens->num ), "get_token past end" );
+is( $tokens->num_matches, 7, "num_matches without creating Tokens" );
+is( scalar @{ $tokens->matches }, 7, "matches" );
+is_deeply( $tokens->get_heat, [ 6, 12 ], "heat" );
+
+# iterating from the start backwards wraps like $array[-1]
+is( $tokens->prev->str, "!", "prev at pos 0" );
+$tokens->reset;
+
+is( $tokens->str, $str, "str round trip via as_array" );
+
+# set_match() writes through to the list
+is( $tokens->get_token(6)->set_match(0), 1, "set_match returns old value" );
+is( $tokens->num_matches, 6, "num_matches sees set_match" );
+$tokens->get_token(6)->set_match(1);
+
+# tokens pushed on via as_array() are counted too
+my $other = $tokenizer->tokenize( "cat.", qr/^cat$/ );
+push @{ $tokens->as_array }, $other->get_token(0), $other->get_token(1);
+is( $tokens->len,         $tokens->num + 2, "len after push" );
+is( $tokens->num_matches, 8,                "num_matches after push" );
+is( $tokens->matches->[-1]->str, "cat", "matches after push" );
+
+# tokens outlive the list
+my $hot = $tokens->get_token(12);
+undef $tokens;
+is( $hot->str,    "dog", "token str after list destroyed" );
+is( $hot->is_hot, 1,     "token is_hot after list destroyed" );
+
+# bitsets span more than one 64-bit word
+my $long = join( ' ', map { $_ % 3 ? "w$_" : "hot$_" } 1 .. 500 ) . '.';
+my $many = $tokenizer->tokenize( $long, qr/^hot/ );
+my @all  = @{ $many->as_array };
+is( $many->num_matches, scalar( grep { $_->is_match } @all ),
+    "num_matches over many words" );
+is_deeply(
+    [ map { $_->pos } @{ $many->matches } ],
+    [ map { $_->pos } grep { $_->is_match } @all ],
+    "matches over many words"
+);
+is_deeply(
+    $many->get_heat,
+    [ map { $_->pos } grep { $_->is_hot } @all ],
+    "get_heat over many words"
+);
+
+# heat and sentence starts as packed native integers
+is_deeply(
+    [ unpack( 'l*', $many->get_heat_packed ) ],
+    $many->get_heat, "get_heat_packed"
+);
+is_deeply(
+    [ unpack( 'l*', $many->get_sentence_starts_packed ) ],
+    $many->get_sentence_starts,
+    "get_sentence_starts_packed"
+);
+is( scalar @{ $many->get_sentence_starts },
+    scalar @{ $many->get_heat }, "one sentence start per hot token" );
+is( $tokenizer->tokenize("no heat here")->get_heat_packed,
+    '', "get_heat_packed with no heat" );
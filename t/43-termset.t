@@ -0,0 +1,43 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 17;
+
+# http://code.google.com/p/test-more/issues/detail?id=46
+binmode Test::More->builder->output,         ":utf8";
+binmode Test::More->builder->failure_output, ":utf8";
+
+use_ok('Search::Tools::TermSet');
+use_ok('Search::Tools::Tokenizer');
+
+ok( my $terms = Search::Tools::TermSet->new(
+        [ 'Quick', 'brown fox', 'jump*', '*ing', 'straße', 'café' ]
+    ),
+    "new TermSet"
+);
+is( $terms->num_terms, 7, "phrases split into words" );
+
+ok( $terms->contains('quick'),   "plain term" );
+ok( $terms->contains('QUICK'),   "case insensitive" );
+ok( $terms->contains('fox'),     "phrase word" );
+ok( $terms->contains('jumped'),  "prefix wildcard" );
+ok( $terms->contains('jump'),    "wildcard matches empty" );
+ok( $terms->contains('running'), "suffix wildcard" );
+ok( $terms->contains('STRASSE'), "full case folding" );
+ok( $terms->contains('CAFÉ'),    "utf8 case folding" );
+ok( !$terms->contains('jum'),    "no partial match" );
+ok( !$terms->contains('quicker'), "no prefix match without wildcard" );
+
+my $tokenizer = Search::Tools::Tokenizer->new;
+my $str       = 'The quick brown fox is jumping';
+is_deeply( $tokenizer->tokenize( $str, $terms )->get_heat,
+    [ 2, 4, 6, 10 ], "TermSet as heat_seeker" );
+is_deeply( $tokenizer->tokenize_pp( $str, $terms )->get_heat,
+    [ 2, 4, 6, 10 ], "TermSet as heat_seeker in tokenize_pp" );
+is_deeply(
+    $tokenizer->tokenize( $str, qr/^(quick|brown|fox|jump\w*|\w*ing)$/i )
+        ->get_heat,
+    [ 2, 4, 6, 10 ],
+    "same heat as regex"
+);
@@ -0,0 +1,81 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More;
+
+# http://code.google.com/p/test-more/issues/detail?id=46
+binmode Test::More->builder->output,         ":utf8";
+binmode Test::More->builder->failure_output, ":utf8";
+
+use Search::Tools::Tokenizer;
+use Search::Tools::UTF8;
+
+# the default re is scanned in C; the same pattern with a comment
+# in it goes through the regex engine.
+my $fast = Search::Tools::Tokenizer->new;
+my $slow = Search::Tools::Tokenizer->new(
+    re => qr/\w+(?:[\'\-\.]\w+)*(?#regex engine)/ );
+
+my @strings = (
+    "",
+    "...",
+    "a",
+    "The quick brown fox. Mr. Smith's e-mail was x.y-z'w!",
+    "trailing sep- 'quoted' ab' -lead .dot..dot a--b a.-b",
+    "under_score 12.5 3.14.15 don't",
+    "Straße café naïve 東京 ελληνικά ᑭᐱᐤ",
+    "mixed: résumé-writing l'été. ¿Qué? ¡Sí!",
+    "\x{2019}curly\x{2019} caf\x{0065}\x{0301} nbsp\x{00a0}here",
+);
+
+for my $docname (qw( ascii.txt greek_and_ojibwe.txt )) {
+    open my $fh, '<', "t/docs/$docname" or die "can't read $docname: $!";
+    local $/;
+    push @strings, to_utf8(<$fh>);
+}
+
+plan tests => scalar(@strings) + 1;
+
+sub describe {
+    my $tokens = shift;
+    my @t;
+    while ( my $tok = $tokens->next ) {
+        push @t,
+            join( ',',
+            $tok->str, $tok->is_match, $tok->is_hot,
+            $tok->is_sentence_start, $tok->is_sentence_end );
+    }
+    return \@t;
+}
+
+for my $str (@strings) {
+    my $hot = qr/^(the|café|l'été|12\.5)$/i;
+    is_deeply(
+        describe( $fast->tokenize( $str, $hot ) ),
+        describe( $slow->tokenize( $str, $hot ) ),
+        "same tokens: " . substr( $str, 0, 20 )
+    );
+}
+
+# abbreviation lookup is ASCII case-insensitive
+my %abbrevs;
+my $abbr_tokens = $fast->tokenize("Dr. MRS. Calif. Ph.D. wy. Ｄr. dr.x Drs. The");
+while ( my $tok = $abbr_tokens->next ) {
+    next unless $tok->is_match;
+    $abbrevs{ $tok->str } = $tok->is_abbreviation;
+}
+is_deeply(
+    \%abbrevs,
+    {   'Dr'    => 1,
+        'MRS'   => 1,
+        'Calif' => 1,
+        'Ph.D'  => 1,
+        'wy'    => 1,
+        'Ｄr'    => 0,
+        'dr.x'  => 0,
+        'Drs'   => 0,
+        'The'   => 0,
+    },
+    "is_abbreviation"
+);
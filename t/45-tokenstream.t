@@ -0,0 +1,83 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Test::More tests => 18;
+use Encode;
+
+use_ok('Search::Tools::Tokenizer');
+use_ok('Search::Tools::UTF8');
+
+my $tokenizer = Search::Tools::Tokenizer->new;
+my $str
+    = to_utf8( "Mr. Smith went to Washington. He said e.g. caf\xc3\xa9 "
+        . "is hot! o'neil--x.y. The end" );
+my $hot = qr/^(caf\w+|the)$/i;
+
+sub describe {
+    my $tokens = shift;
+    my @t;
+    while ( my $tok = $tokens->next ) {
+        push @t,
+            join( ',',
+            $tok->str,               $tok->is_match,
+            $tok->is_hot,            $tok->is_sentence_start,
+            $tok->is_sentence_end,   $tok->is_abbreviation );
+    }
+    return @t;
+}
+
+my @whole = describe( $tokenizer->tokenize( $str, $hot ) );
+my $bytes = Encode::encode_utf8($str);
+
+for my $size ( 1, 3, 7, 64 ) {
+    my $stream = $tokenizer->stream($hot);
+    my @streamed;
+    for ( my $i = 0; $i < length $bytes; $i += $size ) {
+        push @streamed, describe( $stream->push( substr( $bytes, $i, $size ) ) );
+    }
+    push @streamed, describe( $stream->finish );
+    is_deeply( \@streamed, \@whole, "$size byte chunks match tokenize()" );
+}
+
+# held back bytes
+my $stream = $tokenizer->stream;
+is( $stream->push("foo ba")->len, 1, "push returns completed tokens" );
+is( $stream->num_pending_bytes, 3, "unfinished token held back" );
+is( $stream->push("r caf\xc3")->len, 2, "split UTF-8 character" );
+is( $stream->push("\xa9!")->len, 0, "nothing completed" );
+is( $stream->num_tokens, 3, "num_tokens" );
+my $rest = $stream->finish;
+is_deeply( [ map { $rest->get_token($_)->str } 0 .. 2 ],
+    [ ' ', to_utf8("caf\xc3\xa9"), '!' ], "finish returns the rest" );
+is( $stream->num_tokens, 0, "finish resets the stream" );
+
+# a match followed by more punctuation than the stream holds back.
+# The gap is cut at the cap, but no bytes or words are lost.
+my $punct = "the end" . ( "!" x 70_000 ) . " more";
+my ( @strs, $max_pending );
+$stream      = $tokenizer->stream;
+$max_pending = 0;
+for ( my $i = 0; $i < length $punct; $i += 1000 ) {
+    my $tokens = $stream->push( substr( $punct, $i, 1000 ) );
+    while ( my $tok = $tokens->next ) {
+        push @strs, $tok->str;
+    }
+    $max_pending = $stream->num_pending_bytes
+        if $stream->num_pending_bytes > $max_pending;
+}
+my $rest_tokens = $stream->finish;
+while ( my $tok = $rest_tokens->next ) {
+    push @strs, $tok->str;
+}
+is( join( '', @strs ), $punct, "long gap after a match" );
+is_deeply( [ grep {m/\w/} @strs ], [qw( the end more )], "same words" );
+cmp_ok( $max_pending, '<=', 64 * 1024, "held back bytes are capped" );
+
+eval { $tokenizer->stream->push("bad \xff utf8 ") };
+like( $@, qr/UTF-8/, "invalid UTF-8 croaks" );
+
+# callback interface
+open my $fh, '<', \$bytes or die $!;
+my @from_fh;
+$tokenizer->tokenize_fh( $fh, sub { push @from_fh, $_[0]->str }, $hot );
+is( scalar @from_fh, scalar @whole, "tokenize_fh" );
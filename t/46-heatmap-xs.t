@@ -0,0 +1,49 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Test::More tests => 10;
+
+use_ok('Search::Tools');
+use_ok('Search::Tools::HeatMap');
+use_ok('Search::Tools::Tokenizer');
+use_ok('Search::Tools::UTF8');
+
+my @words = split( /\s+/, Search::Tools->slurp('t/docs/test.txt') );
+srand(42);
+my $text = to_utf8(
+    join( ' ',
+        map { ( $_ % 7 ) ? $words[ rand @words ] : ( $_ % 3 ? 'The' : 'and.' ) }
+            1 .. 2000 )
+);
+my $query = Search::Tools->parser->parse('the OR "united states" OR and');
+my $tokenizer = Search::Tools::Tokenizer->new;
+
+sub spans_of {
+    return [
+        map {
+            join( '|',
+                $_->{str},  join( ',', @{ $_->{pos} } ),
+                $_->{heat}, $_->{unique}, $_->{proximate} )
+        } @{ $_[0] }
+    ];
+}
+
+for my $as_sentences ( 0, 1 ) {
+    my $tokens = $tokenizer->tokenize( $text, qr/^(the|united|states|and)$/i );
+    ok( $tokens->can('heat_spans'), "XS TokenList has heat_spans" );
+    my $heatmap = Search::Tools::HeatMap->new(
+        tokens                    => $tokens,
+        window_size               => 20,
+        as_sentences              => $as_sentences,
+        _query                    => $query,
+        _qre                      => qr/the|united\ states|and/i,
+        _treat_phrases_as_singles => 1,
+    );
+    my $xs = spans_of( $heatmap->spans );
+    ok( scalar @$xs, "as_sentences=$as_sentences has spans" );
+
+    my $method = $as_sentences ? '_as_sentences' : '_no_sentences';
+    $heatmap->$method( $tokens, 20 );
+    is_deeply( $xs, spans_of( $heatmap->spans ),
+        "heat_spans matches $method" );
+}
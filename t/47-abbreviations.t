@@ -0,0 +1,75 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 16;
+
+# http://code.google.com/p/test-more/issues/detail?id=46
+binmode Test::More->builder->output,         ":utf8";
+binmode Test::More->builder->failure_output, ":utf8";
+
+use Search::Tools::Tokenizer;
+use Search::Tools::UTF8;
+
+sub abbrevs {
+    my ( $tokens, @abbrevs ) = (shift);
+    while ( my $tok = $tokens->next ) {
+        push @abbrevs, $tok->str if $tok->is_abbreviation;
+    }
+    return join( ' ', @abbrevs );
+}
+
+sub sentence_starts {
+    my ( $tokens, @starts ) = (shift);
+    while ( my $tok = $tokens->next ) {
+        push @starts, $tok->str if $tok->is_sentence_start;
+    }
+    return join( ' ', @starts );
+}
+
+my $german = to_utf8("Das ist z.B. ein Test von Dr. Müller bzw. Prof. Lang. Und dann");
+my $en     = Search::Tools::Tokenizer->new;
+my $de     = Search::Tools::Tokenizer->new( lang => 'de' );
+
+is( $en->lang, 'en', "default lang" );
+is( abbrevs( $en->tokenize($german) ), 'Dr Prof', "en abbreviations" );
+is( abbrevs( $de->tokenize($german) ), 'z.B Dr bzw Prof', "de abbreviations" );
+is( sentence_starts( $en->tokenize($german) ),
+    'Das ein Prof Und', "en splits after z.B. and bzw." );
+is( sentence_starts( $de->tokenize($german) ),
+    'Das Und', "de does not split after abbreviations" );
+is( abbrevs( Search::Tools::Tokenizer->new( lang => 'de_DE' )->tokenize($german) ),
+    'z.B Dr bzw Prof', "locale de_DE uses de" );
+is( abbrevs( Search::Tools::Tokenizer->new( lang => 'xx' )->tokenize($german) ),
+    'Dr Prof', "unknown lang falls back to en" );
+
+my $fr = Search::Tools::Tokenizer->new( lang => 'fr' );
+is( abbrevs( $fr->tokenize( to_utf8("M. Dupont et Mme Durand, tél. 123") ) ),
+    'M Mme tél', "fr abbreviations, single letter and UTF-8" );
+
+my $es = Search::Tools::Tokenizer->new( lang => 'es' );
+is( abbrevs( $es->tokenize( to_utf8("Sra. López, NÚM. 5, pág. 3") ) ),
+    'Sra NÚM pág', "es abbreviations fold case" );
+
+is( Search::Tools::Tokenizer->add_abbreviations( it => [qw( Sig. sigg dott Sig )] ),
+    3, "add_abbreviations returns set size" );
+my $it = Search::Tools::Tokenizer->new( lang => 'it' );
+is( abbrevs( $it->tokenize("Il Sig. Rossi e il Dott. Bianchi") ),
+    'Sig Dott', "added lang" );
+ok( Search::Tools::Tokenizer->add_abbreviations( it => ['ing'] ) > 3,
+    "add to existing lang" );
+is( abbrevs( $it->tokenize("Ing. Verdi e il Sig. Rossi") ),
+    'Ing Sig', "existing lang extended" );
+
+my $stream = $de->stream;
+is( join( ' ',
+        grep {length} abbrevs( $stream->push($german) ),
+        abbrevs( $stream->finish ) ),
+    'z.B Dr bzw Prof',
+    "stream uses lang"
+);
+
+eval { Search::Tools::Tokenizer->add_abbreviations( it => 'sig' ) };
+like( $@, qr/ARRAY ref/, "words must be an array" );
+eval { Search::Tools::Tokenizer->add_abbreviations( it => [ 'x' x 40 ] ) };
+like( $@, qr/longer than/, "too long" );
@@ -0,0 +1,61 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 10;
+
+use Search::Tools::Tokenizer;
+use Search::Tools::TermSet;
+use Search::Tools::UTF8;
+
+my $tokenizer = Search::Tools::Tokenizer->new;
+my @docs      = (
+    "The quick brown fox. The lazy dog!",
+    "",
+    to_utf8("Ein Test von Dr. Müller. Und der Hund."),
+    "dog dog dog",
+);
+
+sub flags {
+    my $tokens = shift;
+    return [
+        map {
+            join( '', $_->str, $_->is_hot, $_->is_match,
+                $_->is_sentence_start, $_->is_sentence_end )
+        } @{ $tokens->as_array }
+    ];
+}
+
+my $heat_seeker = qr/^(fox|dog|hund)$/i;
+ok( my $lists = $tokenizer->tokenize_batch( \@docs, $heat_seeker ),
+    "tokenize_batch" );
+is( scalar @$lists, scalar @docs, "one TokenList per doc" );
+is_deeply(
+    [ map { flags($_) } @$lists ],
+    [ map { flags( $tokenizer->tokenize( $_, $heat_seeker ) ) } @docs ],
+    "same tokens as tokenize()"
+);
+is_deeply(
+    [ map { $_->get_sentence_starts } @$lists ],
+    [ map { $tokenizer->tokenize( $_, $heat_seeker )->get_sentence_starts }
+            @docs ],
+    "sentence starts reset per doc"
+);
+is( $lists->[1]->num, 0, "empty doc" );
+
+my $termset = Search::Tools::TermSet->new( [qw( dog fox )] );
+is_deeply(
+    [ map { $_->get_heat } @{ $tokenizer->tokenize_batch( \@docs, $termset ) } ],
+    [ [ 6, 12 ], [], [], [ 0, 2, 4 ] ],
+    "TermSet heat_seeker"
+);
+is( scalar @{ $tokenizer->tokenize_batch( [] ) }, 0, "no docs" );
+is( $tokenizer->tokenize_batch( ["a b"] )->[0]->num, 3, "no heat_seeker" );
+
+eval { $tokenizer->tokenize_batch("dog") };
+like( $@, qr/ARRAY reference/, "docs must be an array ref" );
+
+my $latin1 = "caf\x{e9}";
+utf8::downgrade($latin1);
+eval { $tokenizer->tokenize_batch( [ "ok", $latin1 ] ) };
+like( $@, qr/UTF-8/, "croak on bad UTF-8" );
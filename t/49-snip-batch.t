@@ -0,0 +1,71 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 10;
+
+use Search::Tools::Snipper;
+use Search::Tools::UTF8;
+
+my $text = do {
+    local $/;
+    open my $fh, '<', 't/docs/test.txt' or die "can't read test.txt: $!";
+    <$fh>;
+};
+my @texts = (
+    $text,
+    "the quick brown fox jumps over the lazy dog",
+    "nothing to see here",
+    "",
+    to_utf8("Der schnelle braune Fuchs. Der faule Hund. quick Müller dog."),
+    ( map { substr( $text, $_ * 97, 600 ) . " quick brown dog " } 1 .. 20 ),
+);
+
+for my $type (qw( token offset )) {
+    for my $threads ( 1, 4 ) {
+        my $snipper = Search::Tools::Snipper->new(
+            query   => 'quick dog',
+            type    => $type,
+            occur   => 2,
+            context => 8,
+            threads => $threads,
+        );
+        is_deeply(
+            $snipper->snip_batch( \@texts ),
+            [ map { $snipper->snip($_) } @texts ],
+            "$type snip_batch == snip, threads=$threads"
+        );
+    }
+}
+
+for my $args (
+    [ as_sentences => 1 ],
+    [ query => '"quick brown" dog', treat_phrases_as_singles => 0 ],
+    [ type => 're' ],
+    )
+{
+    my $snipper = Search::Tools::Snipper->new(
+        query   => 'quick dog',
+        type    => 'token',
+        threads => 2,
+        @$args
+    );
+    is_deeply(
+        $snipper->snip_batch( \@texts ),
+        [ map { $snipper->snip($_) } @texts ],
+        "snip_batch == snip with @$args"
+    );
+}
+
+my $snipper
+    = Search::Tools::Snipper->new( query => 'müller hund', threads => 2 );
+is_deeply(
+    $snipper->snip_batch( \@texts ),
+    [ map { $snipper->snip($_) } @texts ],
+    "snip_batch == snip with UTF-8 query"
+);
+
+$snipper = Search::Tools::Snipper->new( query => 'dog' );
+is_deeply( $snipper->snip_batch( [] ), [], "no texts" );
+eval { $snipper->snip_batch('dog') };
+like( $@, qr/array ref/, "texts must be an array ref" );
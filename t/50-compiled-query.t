@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Test::More tests => 12;
+
+use Search::Tools::QueryParser;
+
+my $qp    = Search::Tools::QueryParser->new;
+my $query = $qp->parse(q(quick brown* "lazy old dog"));
+
+ok( my $compiled = $query->compile, "compile" );
+is( $query->compile, $compiled, "compile is cached" );
+isnt( $query->compile(0), $compiled,
+    "separate cache for treat_phrases_as_singles" );
+is( $compiled->regex, $query->terms_as_regex, "regex == terms_as_regex" );
+is( $query->compile(0)->regex,
+    $query->terms_as_regex(0), "regex(0) == terms_as_regex(0)" );
+
+isa_ok( $compiled->heat_seeker, 'Search::Tools::TermSet', "heat_seeker" );
+like( 'Browning', $compiled->heat_regex, "heat_regex wildcard" );
+unlike( 'brow', $compiled->heat_regex, "heat_regex anchored" );
+
+is( $compiled->phrase_gaps,             0, "no gaps when phrases are singles" );
+is( $query->compile(0)->phrase_gaps,    2, "phrase gaps" );
+like( 'the lazy, old... dog', $query->compile(0)->phrase_regex,
+    "phrase_regex" );
+
+my $stemmed = Search::Tools::QueryParser->new(
+    stemmer => sub { my $w = $_[1]; $w =~ s/ing$//; $w } )->parse('brown');
+is( ref $stemmed->compile->heat_seeker, 'CODE', "stemmer heat_seeker" );
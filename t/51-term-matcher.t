@@ -0,0 +1,64 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 13;
+
+use Search::Tools::QueryParser;
+use Search::Tools::TermMatcher;
+use Search::Tools::UTF8;
+
+my $matcher
+    = Search::Tools::TermMatcher->new( [ 'quick', 'brown fox', 'jump*' ] );
+is( $matcher->num_terms, 3, "num_terms" );
+
+is_deeply( $matcher->match("The quick brown fox jumped."),
+    [ 1, 1, 1 ], "all terms" );
+is_deeply( $matcher->match("Quicker brown\n fox"),
+    [ 0, 1, 0 ], "word boundaries, phrase across whitespace" );
+is_deeply( $matcher->match("brown-fox quick-jump"),
+    [ 0, 0, 0 ], "hyphens join words" );
+is_deeply( $matcher->match("'quick' brown... fox"),
+    [ 0, 1, 0 ], "quoted words, punctuation inside phrases" );
+is_deeply( $matcher->match( to_utf8("QUİCK Brown FOX"), 0 ),
+    [ 0, 1, 0 ], "case folded" );
+
+is_deeply( $matcher->match( "the quick <b>brown</b> fox jumps", 1 ),
+    [ 1, undef, 1 ], "html hits" );
+is_deeply( $matcher->match( "a dog &amp; <b>cat</b>", 1 ),
+    [ 0, 0, 0 ], "html misses" );
+
+my $odd = Search::Tools::TermMatcher->new( [ 'a+b', 'ok' ] );
+is_deeply( $odd->match("a+b ok"), [ undef, 1 ], "undecided term" );
+
+# same counts as the per-term regexes
+my $qp = Search::Tools::QueryParser->new;
+my $query = $qp->parse(qq/quick "brown fox" jump* lazy/);
+ok( $query->compile->term_matcher, "default QueryParser has a TermMatcher" );
+my @texts = (
+    "The quick brown fox jumped over the lazy dog",
+    "quicker brown fox-jumps",
+    "<p>the <i>qu</i>ick brown\n<b>fox</b> &#106;umps <script>if (a<b) {}</script></p>",
+    "lazy, lazy",
+    "",
+);
+my ( @got, @want );
+for my $text (@texts) {
+    push @got, $query->matches_text($text), $query->matches_html($text);
+    for my $style (qw( plain html )) {
+        my $n = 0;
+        for my $term ( @{ $query->terms } ) {
+            my $re = $query->regex_for($term)->$style;
+            $n += $text =~ m/$re/;
+        }
+        push @want, $n;
+    }
+}
+is_deeply( \@got, \@want, "matches_text and matches_html" );
+
+ok( !Search::Tools::QueryParser->new( word_characters => '\w' )
+        ->parse('foo')->compile->term_matcher,
+    "no TermMatcher for other word_characters"
+);
+is( Search::Tools::QueryParser->new->parse('foo')->matches_text("FOO!"),
+    1, "matches_text" );
@@ -0,0 +1,74 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 9;
+
+use Search::Tools::QueryParser;
+use Search::Tools::HiLiter;
+use Search::Tools::UTF8;
+
+my $query
+    = Search::Tools::QueryParser->new->parse(qq/"brown fox" fox quick* dog/);
+my $hiliter = Search::Tools::HiLiter->new( query => $query, class => 'x' );
+
+sub regex_plain {
+    my ( $hiliter, $text ) = @_;
+    local $hiliter->query->compile->{term_matcher};
+    return $hiliter->plain($text);
+}
+
+is( $hiliter->plain("The quick brown fox, quickly."),
+    q{The <span class='x'>quick</span> }
+        . q{<span class='x'>brown <span class='x'>fox</span></span>, }
+        . q{<span class='x'>quickly</span>.},
+    "phrases first, nested"
+);
+is( $hiliter->plain("dog dog 'dog' dog's -dog"),
+    q{<span class='x'>dog</span> <span class='x'>dog</span> 'dog' dog's }
+        . q{-<span class='x'>dog</span>},
+    "repeats and word boundaries"
+);
+
+my @texts = (
+    "The quick brown fox jumped over the lazy dog",
+    "brown  fox-brown fox. Fox fox fox",
+    to_utf8("QUICKSTEP brown\n\nfox ümlaut dog"),
+    "dog- 'brown' fox -- quick's",
+    "dog\n",
+);
+is_deeply(
+    [ map { $hiliter->plain($_) } @texts ],
+    [ map { regex_plain( $hiliter, $_ ) } @texts ],
+    "same as the regex for each term"
+);
+
+# a mark between a ' and the word changes what later terms match
+my $overlap = Search::Tools::QueryParser->new->parse(qq/"a b" "b c" a b c/);
+my $h2 = Search::Tools::HiLiter->new( query => $overlap, class => 'x' );
+my @overlaps = ( "a b c", "a 'b c", "a b- c a 'b", "c a b' 'c", "b 'b 'c" );
+is_deeply(
+    [ map { $h2->plain($_) } @overlaps ],
+    [ map { regex_plain( $h2, $_ ) } @overlaps ],
+    "overlapping terms"
+);
+
+ok( $overlap->compile->term_matcher->hilite( "b", [ 1 ], ["<"], [">"] ),
+    "hilite" );
+is( $overlap->compile->term_matcher->hilite( "a b", [ 2, 0 ], [qw( [ { )],
+        [qw( ] } )] ),
+    "[{a] b}", "hilite in order" );
+ok( !defined Search::Tools::TermMatcher->new( ['a+b'] )
+        ->hilite( "a+b", [0], ["<"], [">"] ),
+    "undef for a term left to its regex"
+);
+
+my $odd = Search::Tools::QueryParser->new->parse('0*');
+my $h3 = Search::Tools::HiLiter->new( query => $odd, class => 'x' );
+ok( !defined $odd->compile->term_matcher->hilite( "1 0", [0], ["<"], [">"] ),
+    "undef for a wildcard matching 0"
+);
+is( $h3->plain("1 0 00"),
+    regex_plain( $h3, "1 0 00" ),
+    "which plain() leaves to the regex"
+);
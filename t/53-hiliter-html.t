@@ -0,0 +1,108 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 14;
+
+use Search::Tools::QueryParser;
+use Search::Tools::HiLiter;
+use Search::Tools::UTF8;
+
+my $query
+    = Search::Tools::QueryParser->new->parse(qq/"brown fox" fox quick* dog/);
+my $hiliter = Search::Tools::HiLiter->new( query => $query, class => 'x' );
+
+sub regex_html {
+    my ( $hiliter, $text ) = @_;
+    local $hiliter->query->compile->{term_matcher};
+    return $hiliter->html($text);
+}
+
+is( $hiliter->html("<p>The quick brown fox, quickly.</p>"),
+    q{<p>The <span class='x'>quick</span> }
+        . q{<span class='x'>brown <span class='x'>fox</span></span>, }
+        . q{<span class='x'>quickly</span>.</p>},
+    "phrases first, nested"
+);
+is( $hiliter->html("<p>the d<b>o</b>g</p>"),
+    q{<p>the <span class='x'>d</span><b><span class='x'>o</span></b>}
+        . q{<span class='x'>g</span></p>},
+    "closed and reopened around tags"
+);
+is( $hiliter->html("<p>brown <i>fox</i></p>"),
+    q{<p><span class='x'>brown </span><i><span class='x'>}
+        . q{<span class='x'>fox</span></span></i></p>},
+    "phrase across a tag"
+);
+is( $hiliter->html("<p>do&#103; &amp;dog D&#79;G</p>"),
+    q{<p><span class='x'>do&#103;</span> &amp;<span class='x'>dog</span> }
+        . q{<span class='x'>D&#79;G</span></p>},
+    "entities"
+);
+is( $hiliter->html(
+        "<title>dog</title><script>dog()</script><!-- dog -->"
+            . "<p>\002dog\003 dog</p>"
+    ),
+    "<title>dog</title><script>dog()</script><!-- dog -->"
+        . "<p>\002dog\003 <span class='x'>dog</span></p>",
+    "not in title, script, comments or nohiliter"
+);
+is( $hiliter->html("<p>brown</p><p>fox</p>brown<br>fox"),
+    q{<p>brown</p><p><span class='x'>fox</span></p>}
+        . q{brown<br><span class='x'>fox</span>},
+    "no phrase across block tags"
+);
+
+# the regex path, the debug path and 8-bit byte strings keep the same rules
+my $skipped = "<title>dog</title><script>dog()</script><!-- dog -->"
+    . "<p>brown</p><p>fox caf\xe9</p>";
+my $want = "<title>dog</title><script>dog()</script><!-- dog -->"
+    . "<p>brown</p><p><span class='x'>fox</span> caf\xe9</p>";
+is( $hiliter->html($skipped), $want, "8-bit byte string" );
+is( regex_html( $hiliter, $skipped ), $want, "regex path" );
+{
+    local $SIG{__WARN__} = sub { };
+    my $debug_hiliter = Search::Tools::HiLiter->new(
+        query => $query,
+        class => 'x',
+        debug => 1,
+    );
+    is( $debug_hiliter->html($skipped), $want, "debug" );
+}
+
+# a wildcard hilites the whole word, even where the regex path
+# used to hilite only the stem inside it
+is( Search::Tools::HiLiter->new(
+        query => Search::Tools::QueryParser->new->parse('fox*'),
+        class => 'x',
+        )->html("Caf&eacute; fox-trot fox"),
+    q{Caf&eacute; <span class='x'>fox-trot</span> <span class='x'>fox</span>},
+    "wildcard extent"
+);
+
+my @texts = (
+    "<p>The quick brown fox jumped over the lazy dog</p>",
+    "<div>brown  fox-brown fox. <b>Fox</b> fox fox</div>",
+    to_utf8("<p>QUICKSTEP brown\n\nfox ümlaut dog</p>"),
+    "<p>dog- 'brown' fox -- quick's</p>",
+    "<a href='dog.html'>dog</a>",
+);
+is_deeply(
+    [ map { $hiliter->html($_) } @texts ],
+    [ map { regex_html( $hiliter, $_ ) } @texts ],
+    "same as the regex for plain markup"
+);
+
+my $matcher = $query->compile->term_matcher;
+is( $matcher->hilite_html(
+        "<b>dog</b>", [ 3 ], ["["], ["]"], \%Search::Tools::XML::HTML_ents
+    ),
+    "<b>[dog]</b>",
+    "hilite_html"
+);
+is( $matcher->hilite_html( "x &foo; dog", [3], ["["], ["]"], { foo => 100 } ),
+    "x &foo; [dog]", "named entities from the table" );
+ok( !defined Search::Tools::TermMatcher->new( ['a+b'] )
+        ->hilite_html( "a+b", [0], ["<"], [">"], {} ),
+    "undef for a term left to its regex"
+);
@@ -0,0 +1,53 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 10;
+
+use Search::Tools::Tokenizer;
+use Search::Tools::Snipper;
+use Search::Tools::UTF8;
+
+my $tokenizer = Search::Tools::Tokenizer->new;
+my $doc = ( "aaa " x 100 ) . "foo " . ( "bbb " x 100 ) . "foo bar foo "
+    . ( "ccc " x 100 );
+my $offsets = $tokenizer->get_offsets( $doc, qr/foo/ );
+is( scalar @$offsets, 3, "3 offsets" );
+
+sub joined {
+    my $tokens = shift;
+    return join( '', map { $_->str } @{ $tokens->as_array } );
+}
+
+ok( my $tokens
+        = $tokenizer->tokenize_windows( $doc, $offsets, 20, qr/^foo$/ ),
+    "tokenize_windows"
+);
+is( joined($tokens),
+    substr( $doc, 390, 20 ) . substr( $doc, 794, 28 ),
+    "only the windows, the last two merged"
+);
+is( scalar @{ $tokens->get_heat }, 3, "3 hot tokens" );
+ok( $tokens->get_token(0)->is_sentence_start,
+    "window starts a sentence" );
+
+is( joined( $tokenizer->tokenize_windows( $doc, $offsets, length $doc ) ),
+    $doc, "window as big as the doc takes all of it" );
+is( joined( $tokenizer->tokenize_windows( $doc, [], 20 ) ),
+    '', "no offsets, no tokens" );
+
+my $utf8 = to_utf8( "ääää foo üüüü" );
+my $u_offsets = $tokenizer->get_offsets( $utf8, qr/foo/ );
+is( joined( $tokenizer->tokenize_windows( $utf8, $u_offsets, 11 ) ),
+    "ää foo ü", "never splits a char" );
+
+# the offset snipper has nothing to snip in a text longer than
+# its window with no match, while a shorter one gets its head
+my $snipper = Search::Tools::Snipper->new( query => 'fox' );
+my $long    = $doc x 3;
+is( $snipper->snip($long), " ... ", "offset snip, no match" );
+is_deeply(
+    $snipper->snip_batch( [ $long, $doc ] ),
+    [ " ... ", $snipper->snip($doc) ],
+    "offset snip_batch, no match"
+);
@@ -0,0 +1,32 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 6;
+
+use Search::Tools::Tokenizer;
+use Search::Tools::Snipper;
+use Search::Tools::UTF8;
+
+my $tokenizer = Search::Tools::Tokenizer->new;
+my $doc       = "foo bar " x 100;
+
+is( scalar @{ $tokenizer->get_offsets( $doc, qr/foo/ ) }, 100, "no budget" );
+is_deeply( $tokenizer->get_offsets( $doc, qr/foo/, 3 ),
+    [ 0, 8, 16 ], "max_hits" );
+is_deeply( $tokenizer->get_offsets( $doc, qr/foo/, 0, 20 ),
+    [ 0, 8, 16 ], "max_bytes" );
+is_deeply( $tokenizer->get_offsets( $doc, qr/foo/, 2, 20 ),
+    [ 0, 8 ], "both" );
+
+my $utf8 = to_utf8("ü foo ü foo");
+is_deeply( $tokenizer->get_offsets( $utf8, qr/foo/, 0, 6 ),
+    [3], "max_bytes in a UTF-8 string" );
+
+my $long = "dog " . ( "cat " x 2000 ) . "dog";
+my $snipper = Search::Tools::Snipper->new(
+    query       => 'dog',
+    type        => 'offset',
+    max_offsets => 1,
+);
+is( $snipper->snip($long) =~ tr/d//, 1, "max_offsets" );
@@ -0,0 +1,45 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 10;
+
+use Search::Tools::QueryParser;
+use Search::Tools::Tokenizer;
+use Search::Tools::UTF8;
+
+my $qparser   = Search::Tools::QueryParser->new;
+my $tokenizer = Search::Tools::Tokenizer->new;
+
+sub prefiltered {
+    my ( $text, $query ) = @_;
+    my $compiled = $qparser->parse($query)->compile;
+    return $tokenizer->get_offsets( $text, $compiled->regex, 0, 0,
+        $compiled->literals, $compiled->max_match_bytes );
+}
+
+sub same_offsets {
+    my ( $text, $query, $msg ) = @_;
+    my $compiled = $qparser->parse($query)->compile;
+    is_deeply(
+        prefiltered( $text, $query ),
+        $tokenizer->get_offsets( $text, $compiled->regex ), $msg
+    );
+}
+
+my $compiled = $qparser->parse(q/united "bird call" unit*/)->compile;
+is_deeply( $compiled->literals, [qw( bird call unit )], "literals" );
+is( $compiled->max_match_bytes, 0, "wildcard match is unbounded" );
+ok( !$qparser->parse('*ing')->compile->literals,
+    "no literals for a leading wildcard" );
+
+my $doc = ( "the quick brown fox " x 500 ) . "Bird";
+is_deeply( prefiltered( $doc, 'bird' ), [10000], "match after no hits" );
+is_deeply( prefiltered( $doc, 'dog' ), [], "no matches" );
+same_offsets( "bird birdbird BIRD bi", 'bird', "same as without literals" );
+
+# chars outside ASCII that match ASCII ignoring case
+same_offsets( to_utf8("\x{212A}elvin kelvin"), 'kelvin', "Kelvin sign" );
+same_offsets( to_utf8("gro\x{df} grosse"),     'grosse', "sharp s" );
+same_offsets( to_utf8("\x{FB01}sh fish"),      'fish',   "ligature" );
+same_offsets( to_utf8("\x{130}\x{307}n in"),   "i\x{307}n", "combining dot" );
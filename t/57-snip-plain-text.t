@@ -0,0 +1,41 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 9;
+
+use Search::Tools::Snipper;
+use Search::Tools::XML;
+
+sub plain {
+    my ( $text, $strip, $collapse ) = @_;
+    my ($plain) = Search::Tools::XML::_plain_text( $text, $strip, $collapse );
+    return $plain;
+}
+
+is( plain( "<p>caf&eacute;\n\t &nbsp;<b>au</b>  lait</p>", 1, 1 ),
+    "café au lait", "strip and collapse" );
+is( plain( "<p>a&lt;b  &amp;quot; &amp;#60;</p>", 1, 0 ),
+    "a<b  &quot; <", "entities decoded as no_html does" );
+is( plain( "a <> b < c", 1, 0 ), "a <> b < c", "not tags" );
+is( plain( "<i>a  b</i>", 0, 1 ), "<i>a b</i>", "collapse only" );
+
+my $latin1 = "caf\xe9\xa0 ol\xe9";
+my ( $plain, $length ) = Search::Tools::XML::_plain_text( $latin1, 1, 1 );
+is( $plain,  "café olé", "Latin-1 decoded" );
+is( $length, 9,          "length before collapsing" );
+ok( utf8::is_utf8($plain), "flagged UTF-8" );
+
+my $html = "<html><body><p>The   <b>quick</b> brown\n\nfox &amp; the lazy "
+    . ( "dog " x 100 )
+    . "</p></body></html>";
+my %args = (
+    query        => 'fox',
+    strip_markup => 1,
+    max_chars    => 40,
+);
+is( Search::Tools::Snipper->new(%args)->snip($html),
+    Search::Tools::Snipper->new( %args, use_pp => 1 )->snip($html),
+    "same snip as use_pp" );
+like( Search::Tools::Snipper->new(%args)->snip($html),
+    qr/The quick brown fox & the lazy/, "snip" );
@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use utf8;
+use Test::More tests => 11;
+
+use Search::Tools::XML;
+
+my $XML = 'Search::Tools::XML';
+
+my @wrong = grep {
+    $XML->unescape_named("&$_;") ne chr( $Search::Tools::XML::HTML_ents{$_} )
+} sort keys %Search::Tools::XML::HTML_ents;
+is( "@wrong", "", "every %HTML_ents entity decoded" );
+
+is( $XML->unescape("&lt;&#60;&#x3c;&#X3C;"), "<<<<", "named, decimal, hex" );
+is( $XML->unescape_named("&lt;&#60;&#x3c;"), "<&#60;&#x3c;", "named only" );
+is( $XML->unescape_decimal("&lt;&#60;&#x3c;"),
+    "&lt;<&#x3c;", "decimal only" );
+is( $XML->unescape("&amp;#60; &amp;lt;"), "< &lt;", "escaped entities" );
+is( $XML->unescape_named("&amp;lt; &amp;#60;"),
+    "&lt; &#60;", "named decoded once" );
+is( $XML->unescape("&bogus; & &#; &#0; &#xd800; &#1234567; &lt"),
+    "&bogus; & &#; &#0; &#xd800; &#1234567; &lt", "not entities" );
+
+my $bytes = $XML->unescape("caf&eacute;");
+ok( !utf8::is_utf8($bytes), "bytes stay bytes" );
+is( $bytes, "caf\xe9", "Latin-1 char" );
+is( $XML->unescape("caf\xe9 &euro;"), "café €", "upgraded for a wide char" );
+ok( !defined $XML->unescape(undef), "undef" );
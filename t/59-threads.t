@@ -0,0 +1,88 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Config;
+use Test::More;
+
+BEGIN {
+    plan skip_all => 'perl is not built with ithreads'
+        unless $Config{useithreads};
+}
+use threads;
+
+use Search::Tools::Tokenizer;
+use Search::Tools::TermSet;
+use Search::Tools::TermMatcher;
+use Search::Tools::Snipper;
+use Search::Tools::HiLiter;
+use Search::Tools::QueryParser;
+
+plan tests => 9;
+
+# each object holding a C struct must survive a thread being created,
+# used and joined, and the thread must not free it again.
+
+my $tokenizer = Search::Tools::Tokenizer->new;
+my $tokens    = $tokenizer->tokenize("one two three");
+my $token     = $tokens->next;
+threads->create( sub { eval { $tokens->next }; 1 } )->join;
+is( $tokens->get_token(2)->str, "two", "TokenList usable after a thread" );
+is( $token->str, "one", "Token usable after a thread" );
+
+my $term_set = Search::Tools::TermSet->new( [qw( foo bar* )] );
+threads->create( sub {1} )->join;
+ok( $term_set->contains("barn"), "TermSet usable after a thread" );
+
+my $stream = $tokenizer->stream;
+my $num    = $stream->push("one two")->len;
+threads->create( sub {1} )->join;
+$num += $stream->push(" three")->len;
+$num += $stream->finish->len;
+is( $num, 5, "TokenStream usable after a thread" );
+
+my $matcher = Search::Tools::TermMatcher->new( [qw( foo bar* )] );
+threads->create( sub {1} )->join;
+is_deeply( $matcher->match("the barn"), [ 0, 1 ],
+    "TermMatcher usable after a thread" );
+
+# the Query behind a Snipper or HiLiter caches a TermMatcher
+my $snipper = Search::Tools::Snipper->new( query => 'fox' );
+$snipper->snip("the quick brown fox");
+threads->create( sub {1} )->join;
+like( $snipper->snip("the quick brown fox"),
+    qr/fox/, "Snipper usable after a thread" );
+
+# and a Query or HiLiter made before a thread works inside it
+my $query   = Search::Tools::QueryParser->new->parse('fox dog');
+my $hiliter = Search::Tools::HiLiter->new( query => $query, class => 'x' );
+$hiliter->light("the quick brown fox");
+my ( $lit, $count ) = @{
+    threads->create(
+        sub {
+            [   $hiliter->light("the quick brown fox"),
+                $query->matches_text("the fox and the dog")
+            ];
+        }
+    )->join
+};
+is( $lit, q{the quick brown <span class='x'>fox</span>},
+    "HiLiter light() in a thread" );
+is( $count, 2, "Query matches_text() in a thread" );
+
+my $text = "the quick brown fox " . ( "jumped over the lazy dog " x 50 );
+my %snippers = map {
+    $_ => Search::Tools::Snipper->new( query => 'fox', type => $_ )
+} qw( token offset );
+my $snip_all = sub {
+    return {
+        map {
+            $_ => [
+                $snippers{$_}->snip($text),
+                @{ $snippers{$_}->snip_batch( [$text] ) }
+            ]
+        } keys %snippers
+    };
+};
+my $want = $snip_all->();
+is_deeply( threads->create($snip_all)->join,
+    $want, "Snipper snip() and snip_batch() in a thread" );